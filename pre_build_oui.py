@@ -0,0 +1,64 @@
+import importlib.util
+import os
+import urllib.request
+
+# Builds sd_files/oui.bin, the offline MAC vendor table of src/core/oui_db.h, from
+# the IEEE MA-L registry with tools/oui_gen/oui_gen.py. The registry is read from
+# tools/oui_gen/oui.csv; when that is missing it is downloaded there once, so later
+# builds and offline ones reuse it. Copy sd_files/oui.bin to the root of the SD
+# card, or upload it to LittleFS, for vendor names.
+
+OUI_GEN_DIR = os.path.join("tools", "oui_gen")
+SOURCE = os.path.join(OUI_GEN_DIR, "oui.csv")
+OUTPUT = os.path.join("sd_files", "oui.bin")
+REGISTRY_URL = "https://standards-oui.ieee.org/oui/oui.csv"
+
+
+def load_oui_gen():
+    spec = importlib.util.spec_from_file_location("oui_gen", os.path.join(OUI_GEN_DIR, "oui_gen.py"))
+    module = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(module)
+    return module
+
+
+def fetch_registry():
+    print(f"[OUI] {SOURCE} not found, downloading {REGISTRY_URL}")
+    request = urllib.request.Request(REGISTRY_URL, headers={"User-Agent": "Mozilla/5.0"})
+    with urllib.request.urlopen(request, timeout=60) as response:
+        data = response.read()
+    with open(SOURCE + ".tmp", "wb") as f:
+        f.write(data)
+    os.replace(SOURCE + ".tmp", SOURCE)
+
+
+def generate():
+    if not os.path.exists(SOURCE):
+        try:
+            fetch_registry()
+        except OSError as e:
+            # Not fatal: the firmware reports "NO OUI DATABASE" until a table is installed
+            print(f"[OUI] Cannot download the registry ({e}), {OUTPUT} not built")
+            return
+
+    # Parsing the registry takes a moment, skip it while the table is current
+    script = os.path.join(OUI_GEN_DIR, "oui_gen.py")
+    if os.path.exists(OUTPUT) and os.path.getmtime(OUTPUT) >= max(os.path.getmtime(SOURCE), os.path.getmtime(script)):
+        return
+
+    oui_gen = load_oui_gen()
+    ouis = oui_gen.read_registry(SOURCE)
+    if not ouis:
+        raise ValueError(f"{SOURCE}: no MA-L assignments")
+    blob = oui_gen.build(ouis)
+
+    with open(OUTPUT, "wb") as f:
+        f.write(blob)
+    print(f"[OUI] {OUTPUT}: {len(ouis)} OUIs, {len(blob)} bytes")
+
+
+# Hook for PlatformIO, also runs by hand
+try:
+    Import("env")  # type: ignore
+except NameError:
+    pass
+generate()
@@ -0,0 +1,131 @@
+import os
+
+# Compiles the built-in SSID signatures into the Aho-Corasick tables of
+# src/modules/wifi/guardian/ssid_matcher.h, so they sit in flash and need no
+# building at boot. Same layout as SsidMatcher::build(), which handles user
+# signatures at run time.
+
+GUARDIAN_DIR = os.path.join("src", "modules", "wifi", "guardian")
+SOURCE = os.path.join(GUARDIAN_DIR, "ssid_signatures.txt")
+OUTPUT = os.path.join(GUARDIAN_DIR, "ssid_signatures.h")
+KINDS = {"rogue": "SSID_SIGNATURE_ROGUE", "skimmer": "SSID_SIGNATURE_SKIMMER"}
+
+
+def fold(byte):
+    return byte + 32 if 65 <= byte <= 90 else byte
+
+
+def read_signatures():
+    signatures = []
+    with open(SOURCE, encoding="utf-8") as f:
+        for number, line in enumerate(f, 1):
+            line = line.rstrip("\r\n")
+            if not line.strip() or line.startswith("#"):
+                continue
+            kind, _, pattern = line.partition(" ")
+            if kind not in KINDS or not pattern or len(pattern.encode()) > 32:
+                raise ValueError(f"{SOURCE}:{number}: expected 'kind pattern' with a pattern of 1-32 bytes")
+            signatures.append((kind, pattern))
+    return signatures
+
+
+def build(signatures):
+    label, child, sibling, signature = [0], [0], [0], [0]
+    for index, (_, pattern) in enumerate(signatures):
+        node = 0
+        for byte in (fold(b) for b in pattern.encode()):
+            nxt = child[node]
+            while nxt and label[nxt] != byte:
+                nxt = sibling[nxt]
+            if not nxt:
+                nxt = len(label)
+                label.append(byte)
+                child.append(0)
+                sibling.append(child[node])
+                signature.append(0)
+                child[node] = nxt
+            node = nxt
+        if not signature[node]:
+            signature[node] = index + 1
+
+    def edge(node, byte):
+        nxt = child[node]
+        while nxt and label[nxt] != byte:
+            nxt = sibling[nxt]
+        return nxt
+
+    # Breadth first, so every fail target is final before its users
+    fail, output = [0] * len(label), [0] * len(label)
+    queue = []
+    nxt = child[0]
+    while nxt:
+        queue.append(nxt)
+        nxt = sibling[nxt]
+    for node in queue:
+        nxt = child[node]
+        while nxt:
+            f = fail[node]
+            while f and not edge(f, label[nxt]):
+                f = fail[f]
+            fail[nxt] = edge(f, label[nxt])
+            output[nxt] = fail[nxt] if signature[fail[nxt]] else output[fail[nxt]]
+            queue.append(nxt)
+            nxt = sibling[nxt]
+
+    root = [edge(0, byte) for byte in range(256)]
+    return root, label, child, sibling, fail, output, signature
+
+
+def c_array(ctype, name, values):
+    lines = []
+    for i in range(0, len(values), 16):
+        lines.append("    " + ", ".join(str(v) for v in values[i : i + 16]) + ",")
+    return f"static const {ctype} {name}[{len(values)}] = {{\n" + "\n".join(lines) + "\n};\n"
+
+
+def c_string(text):
+    safe = lambda b: b < 128 and (chr(b).isalnum() or chr(b) in " -_.")
+    return '"' + "".join(chr(b) if safe(b) else "\\%03o" % b for b in text.encode()) + '"'
+
+
+def generate():
+    signatures = read_signatures()
+    if len(signatures) >= 0xFFFF:
+        raise ValueError(f"{SOURCE}: too many signatures")
+    root, label, child, sibling, fail, output, signature = build(signatures)
+    if len(label) > 0xFFFF:
+        raise ValueError(f"{SOURCE}: automaton too large")
+
+    out = "// Generated by pre_build_ssid_signatures.py from ssid_signatures.txt, do not edit\n"
+    out += "#ifndef __GUARDIAN_SSID_SIGNATURES_H__\n#define __GUARDIAN_SSID_SIGNATURES_H__\n\n"
+    out += '#include "ssid_matcher.h"\n\n'
+    out += f"static const SsidSignature ssidBuiltinSignatures[{len(signatures)}] = {{\n"
+    out += "".join(f"    {{{c_string(p)}, {KINDS[k]}}},\n" for k, p in signatures)
+    out += "};\n\n"
+    out += c_array("uint16_t", "ssidBuiltinRoot", root) + "\n"
+    out += c_array("uint8_t", "ssidBuiltinLabel", label) + "\n"
+    out += c_array("uint16_t", "ssidBuiltinChild", child) + "\n"
+    out += c_array("uint16_t", "ssidBuiltinSibling", sibling) + "\n"
+    out += c_array("uint16_t", "ssidBuiltinFail", fail) + "\n"
+    out += c_array("uint16_t", "ssidBuiltinOutput", output) + "\n"
+    out += c_array("uint16_t", "ssidBuiltinSignature", signature) + "\n"
+    out += "static const SsidAutomaton ssidBuiltinAutomaton = {\n"
+    out += "    ssidBuiltinRoot, ssidBuiltinLabel, ssidBuiltinChild, ssidBuiltinSibling,\n"
+    out += "    ssidBuiltinFail, ssidBuiltinOutput, ssidBuiltinSignature, ssidBuiltinSignatures,\n"
+    out += f"    {len(label)}, {len(signatures)},\n}};\n\n#endif\n"
+
+    # Rewritten only when it changes, an unchanged header does not trigger a rebuild
+    if os.path.exists(OUTPUT):
+        with open(OUTPUT, encoding="utf-8") as f:
+            if f.read() == out:
+                return
+    with open(OUTPUT, "w", encoding="utf-8", newline="\n") as f:
+        f.write(out)
+
+
+# Hook for PlatformIO, also runs by hand
+try:
+    Import("env")  # type: ignore
+except NameError:
+    pass
+generate()
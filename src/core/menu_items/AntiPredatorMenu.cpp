@@ -5,264 +5,54 @@
 #include "WiFi.h"
 #include "esp_wifi.h"
 #include "modules/wifi/wifi_defense.h"
+#include "modules/wifi/guardian/guardian_clock.h"
+#include "modules/wifi/guardian/profile_store.h"
+#include "modules/wifi/guardian/ssid_matcher.h"
 #include <globals.h>
 #include <vector>
 #include <set>
 
-// Real threat detection structures from your spec
-enum AttackType {
-  ATTACK_BEACON_SPAM,
-  ATTACK_EVIL_TWIN, 
-  ATTACK_KARMA,
-  ATTACK_DEAUTH_FLOOD,
-  ATTACK_PROBE_FLOOD,
-  ATTACK_CAPTIVE_PORTAL,
-  ATTACK_UNKNOWN
-};
-
-struct TrackedDevice {
-  uint8_t mac[6];
-  unsigned long firstSeen;
-  unsigned long lastSeen;
-  uint32_t beaconCount;
-  uint32_t probeCount; 
-  uint32_t deauthCount;
-  uint32_t recentBeacons;     // beacons in last SHORT_WINDOW_MS
-  uint32_t recentProbes;      // probes in last SHORT_WINDOW_MS
-  uint32_t recentDeauths;     // deauths in last SHORT_WINDOW_MS
-  unsigned long windowStart; // start of current measurement window
-  std::set<String> advertisedSSIDs;
-  AttackType suspectedAttack;
-  float riskScore;
-  bool isMarkedMalicious;
-};
+// Detection runs in the shared threatEngine (modules/wifi/guardian/threat_engine.h),
+// these hooks only report what it finds. monitoring/totalThreats are shared with wifi_defense.
 
-// Detection thresholds - tuned for real-world responsiveness
-#define MAX_TRACKED_DEVICES 50
-#define BEACON_SPAM_THRESHOLD 2   // beacons/second (normal APs ~1/100ms, spam is much faster)
-#define DEAUTH_ATTACK_THRESHOLD 1 // deauths/second  
-#define PROBE_FLOOD_THRESHOLD 5   // probes/second
-#define ATTACK_DETECTION_THRESHOLD 2 // risk score to confirm attack
-#define SHORT_WINDOW_MS 3000      // 3 second sliding window for faster detection
-#define MIN_ANALYSIS_TIME 500     // minimum 0.5 seconds before analysis
-
-// Global state
-std::vector<TrackedDevice> trackedDevices;
-bool monitoring = false;
-unsigned long lastAnalysis = 0;
-int totalThreats = 0;
-
-// Function to get attack type name
-String getAttackTypeName(AttackType type) {
-    switch(type) {
-        case ATTACK_BEACON_SPAM: return "BEACON SPAM";
-        case ATTACK_EVIL_TWIN: return "EVIL TWIN";
-        case ATTACK_KARMA: return "KARMA ATTACK";
-        case ATTACK_DEAUTH_FLOOD: return "DEAUTH FLOOD";
-        case ATTACK_PROBE_FLOOD: return "PROBE FLOOD";
-        case ATTACK_CAPTIVE_PORTAL: return "CAPTIVE PORTAL";
-        default: return "UNKNOWN";
+static String formatSharkMac(const uint8_t* mac) {
+    String str = "";
+    for(int i = 0; i < 6; i++) {
+        if(i > 0) str += ":";
+        if(mac[i] < 16) str += "0";
+        str += String(mac[i], HEX);
     }
+    return str;
 }
 
-// Packet processing callback for real WiFi monitoring
-void IRAM_ATTR packetCallback(void* buf, wifi_promiscuous_pkt_type_t type) {
-    if(!monitoring || type != WIFI_PKT_MGMT) return;
-    
-    wifi_promiscuous_pkt_t *pkt = (wifi_promiscuous_pkt_t*)buf;
-    
-    // Basic 802.11 frame header
-    typedef struct {
-        uint8_t frame_ctrl[2];
-        uint8_t duration[2];
-        uint8_t addr1[6]; // receiver
-        uint8_t addr2[6]; // transmitter/source
-        uint8_t addr3[6]; // BSSID
-        uint8_t seq_ctrl[2];
-    } wifi_header_t;
-    
-    if(pkt->rx_ctrl.sig_len < sizeof(wifi_header_t)) return;
-    
-    wifi_header_t *hdr = (wifi_header_t*)pkt->payload;
-    uint8_t* srcMac = hdr->addr2;
-    
-    // Find or create tracked device
-    TrackedDevice* device = nullptr;
-    for(auto& d : trackedDevices) {
-        if(memcmp(d.mac, srcMac, 6) == 0) {
-            device = &d;
-            break;
-        }
-    }
-    
-    if(!device && trackedDevices.size() < MAX_TRACKED_DEVICES) {
-        TrackedDevice newDevice;
-        memcpy(newDevice.mac, srcMac, 6);
-        newDevice.firstSeen = millis();
-        newDevice.lastSeen = millis();
-        newDevice.beaconCount = 0;
-        newDevice.probeCount = 0;
-        newDevice.deauthCount = 0;
-        newDevice.recentBeacons = 0;
-        newDevice.recentProbes = 0;
-        newDevice.recentDeauths = 0;
-        newDevice.windowStart = millis();
-        newDevice.suspectedAttack = ATTACK_UNKNOWN;
-        newDevice.riskScore = 0.0;
-        newDevice.isMarkedMalicious = false;
-        
-        trackedDevices.push_back(newDevice);
-        device = &trackedDevices.back();
-    }
-    
-    if(device) {
-        device->lastSeen = millis();
-        
-        // Reset sliding window if needed
-        if(device->lastSeen - device->windowStart > SHORT_WINDOW_MS) {
-            device->recentBeacons = 0;
-            device->recentProbes = 0;
-            device->recentDeauths = 0;
-            device->windowStart = device->lastSeen;
-        }
-        
-        // Analyze frame type and subtype
-        uint8_t frameType = hdr->frame_ctrl[0] & 0x0C;
-        uint8_t frameSubType = (hdr->frame_ctrl[0] & 0xF0) >> 4;
-        
-        if(frameType == 0x00) { // Management frame
-            if(frameSubType == 0x08) { // Beacon frame
-                device->beaconCount++;
-                device->recentBeacons++;
-                
-                // Extract SSID from beacon (simplified)
-                if(pkt->rx_ctrl.sig_len > 36) { // Minimum beacon size
-                    uint8_t* ssid_ptr = pkt->payload + 36; // Skip fixed fields
-                    if(ssid_ptr[0] == 0x00 && ssid_ptr[1] < 32) { // SSID element
-                        String ssid = "";
-                        for(int i = 0; i < ssid_ptr[1] && i < 32; i++) {
-                            ssid += (char)ssid_ptr[2 + i];
-                        }
-                        if(ssid.length() > 0) {
-                            device->advertisedSSIDs.insert(ssid);
-                        }
-                    }
-                }
-            } else if(frameSubType == 0x04) { // Probe request
-                device->probeCount++;
-                device->recentProbes++;
-            } else if(frameSubType == 0x0C) { // Deauth frame
-                device->deauthCount++;
-                device->recentDeauths++;
-            }
-        }
-    }
+static void reportShark(const ThreatDevice& device) {
+    totalThreats++;
+    Serial.println("🚨 SHARK DETECTED: " + getThreatTypeName(device.suspectedThreat) + 
+                  " from " + formatSharkMac(device.mac) + " (Risk: " + String(device.riskScore, 1) + ")");
 }
 
-// Enhanced threat analysis with better spam detection
-void analyzeThreats() {
-    unsigned long currentTime = millis();
-    
-    for(auto& device : trackedDevices) {
-        if(currentTime - device.lastSeen > 8000) continue; // Skip old devices
-        
-        // Reset sliding window if expired
-        if(currentTime - device.windowStart > SHORT_WINDOW_MS) {
-            device.recentBeacons = 0;
-            device.recentProbes = 0;
-            device.recentDeauths = 0;
-            device.windowStart = currentTime;
-        }
-        
-        // Calculate rates using sliding window
-        float windowSeconds = (currentTime - device.windowStart) / 1000.0;
-        if(windowSeconds < (MIN_ANALYSIS_TIME / 1000.0)) continue; // Need minimum time
-        
-        float recentBeaconRate = device.recentBeacons / windowSeconds;
-        float recentProbeRate = device.recentProbes / windowSeconds;
-        float recentDeauthRate = device.recentDeauths / windowSeconds;
-        
-        // Calculate total rates for baseline comparison
-        float totalTime = (currentTime - device.firstSeen) / 1000.0;
-        float totalBeaconRate = (totalTime > 1.0) ? device.beaconCount / totalTime : 0;
-        
-        // Reset risk assessment
-        float previousScore = device.riskScore;
-        device.riskScore = 0.0;
-        device.suspectedAttack = ATTACK_UNKNOWN;
-        
-        // Detection 1: High beacon rate (immediate spam detection)
-        if(recentBeaconRate > BEACON_SPAM_THRESHOLD) {
-            device.riskScore += 4.0;
-            device.suspectedAttack = ATTACK_BEACON_SPAM;
-        }
-        
-        // Detection 2: Rapid beacon increase (attack starting)
-        if(recentBeaconRate > totalBeaconRate * 2 && recentBeaconRate > 1.5) {
-            device.riskScore += 3.0;
-            if(device.suspectedAttack == ATTACK_UNKNOWN) {
-                device.suspectedAttack = ATTACK_BEACON_SPAM;
-            }
-        }
-        
-        // Detection 3: Deauth flood attack
-        if(recentDeauthRate > DEAUTH_ATTACK_THRESHOLD) {
-            device.riskScore += 5.0;
-            device.suspectedAttack = ATTACK_DEAUTH_FLOOD;
-        }
-        
-        // Detection 4: Probe request flood  
-        if(recentProbeRate > PROBE_FLOOD_THRESHOLD) {
-            device.riskScore += 4.0;
-            device.suspectedAttack = ATTACK_PROBE_FLOOD;
-        }
-        
-        // Detection 5: Multiple SSID advertisement (evil twin/karma)
-        if(device.advertisedSSIDs.size() > 2) {
-            device.riskScore += 3.0;
-            if(device.suspectedAttack == ATTACK_UNKNOWN) {
-                device.suspectedAttack = ATTACK_EVIL_TWIN;
-            }
-        }
-        
-        // Detection 6: Very high activity (any rapid wireless activity)
-        if(recentBeaconRate > 10 || recentProbeRate > 8 || device.recentBeacons > 20) {
-            device.riskScore += 2.0;
-        }
-        
-        // Detection 7: Burst pattern detection (many packets in short time)
-        if(device.recentBeacons + device.recentProbes + device.recentDeauths > 15) {
-            device.riskScore += 2.0;
-        }
-        
-        // Add debug output for analysis
-        if(device.riskScore > 0.5 || device.recentBeacons > 5) {
-            String mac = "";
-            for(int i = 0; i < 6; i++) {
-                if(i > 0) mac += ":";
-                if(device.mac[i] < 16) mac += "0";
-                mac += String(device.mac[i], HEX);
-            }
-            Serial.printf("ANALYSIS: %s - Recent B:%.1f P:%.1f D:%.1f (window:%.1fs) SSIDs:%d Risk:%.1f\n",
-                         mac.c_str(), recentBeaconRate, recentProbeRate, recentDeauthRate, 
-                         windowSeconds, device.advertisedSSIDs.size(), device.riskScore);
-        }
-        
-        // Mark as malicious if risk score exceeds threshold
-        if(device.riskScore >= ATTACK_DETECTION_THRESHOLD && !device.isMarkedMalicious) {
-            device.isMarkedMalicious = true;
-            totalThreats++;
-            
-            String mac = "";
-            for(int i = 0; i < 6; i++) {
-                if(i > 0) mac += ":";
-                if(device.mac[i] < 16) mac += "0";
-                mac += String(device.mac[i], HEX);
-            }
-            Serial.println("🚨 SHARK DETECTED: " + getAttackTypeName(device.suspectedAttack) + 
-                          " from " + mac + " (Risk: " + String(device.riskScore, 1) + ")");
-        }
-    }
+static void reportSharkDeauthFlood(const DeauthFlood& flood) {
+    totalThreats++;
+    Serial.println("🚨 SHARK DETECTED: DEAUTH FLOOD on " + formatSharkMac(flood.target) +
+                  " spoofing " + formatSharkMac(flood.spoofed) + " (" + String(flood.rate, 1) + "/s)");
+}
+
+static const ThreatEngineConfig sharkEngineConfig = {
+    SHARK_STALE_MS, // replaced by the detection profile's, see sharkConfig()
+    THREAT_EXPIRE_MS,
+    reportShark,
+    nullptr, // no trace: a serial line per AP and pass would stall the analysis task
+    nullptr,
+    reportSharkDeauthFlood,
+    nullptr,
+    nullptr
+};
+
+static ThreatEngineConfig sharkConfig() {
+    detectionProfilesBegin();
+    ThreatEngineConfig config = sharkEngineConfig;
+    config.staleMs = detectionProfile().sharkStaleMs;
+    return config;
 }
 
 void AntiPredatorMenu::optionsMenu() {
@@ -271,39 +61,30 @@ void AntiPredatorMenu::optionsMenu() {
             drawMainBorderWithTitle("Shark-Bait Defense Active");
             padprintln("🦈 PROTECTING AGAINST SHARKS 🦈");
             padprintln("");
-            padprintln("Active defenses:");
-            padprintln("✅ Beacon spam detector (>3/s)");
+            detectionProfilesBegin();
+            padprintln("Active defenses (" + String(detectionProfile().name) + " profile):");
+            padprintln("✅ Beacon spam detector (>" + String(detectionThreshold("beacon spam")) + "/s)");
             padprintln("✅ Evil twin hunter (multi-SSID)");
             padprintln("✅ Karma attack sentinel");
-            padprintln("✅ Deauth storm monitor (>2/s)");
-            padprintln("✅ Probe flood detector (>8/s)");
+            padprintln("✅ Deauth storm monitor (>" + String(detectionThreshold("deauth flood")) + "/s)");
+            padprintln("✅ Probe flood detector (>" + String(detectionThreshold("probe flood")) + "/s)");
             padprintln("");
             
             // Start enhanced threat detection
-            trackedDevices.clear();
-            totalThreats = 0;
-            
-            WiFi.mode(WIFI_MODE_STA);
-            esp_wifi_set_promiscuous(true);
-            esp_wifi_set_promiscuous_rx_cb(&packetCallback);
-            monitoring = true;
-            lastAnalysis = millis();
+            if(!startThreatCapture(sharkConfig())) return;
             
             padprintln("MONITORING - Press any key to stop");
             padprintln("Debug output on serial console");
             
+            // Drawn from the views of the analysis task, threatEngine changes under us
+            GuardianView view = {};
             unsigned long lastUpdate = millis();
             while(monitoring) {
                 if(check(AnyKeyPress)) {
                     monitoring = false;
                     break;
                 }
-                
-                // Analyze threats more frequently for faster detection
-                if(millis() - lastAnalysis > 500) { // Every 0.5 seconds
-                    analyzeThreats();
-                    lastAnalysis = millis();
-                }
+                receiveGuardianView(view);
                 
                 // Update display every 2 seconds
                 if(millis() - lastUpdate > 2000) {
@@ -320,21 +101,17 @@ void AntiPredatorMenu::optionsMenu() {
                     }
                     
                     tft.setTextColor(bruceConfig.priColor);
-                    tft.println("Devices tracked: " + String(trackedDevices.size()));
+                    tft.println("Devices tracked: " + String(view.tracked));
                     tft.println("Threats found: " + String(totalThreats));
                     
                     // Show recent activity
-                    int activeDevices = 0;
-                    for(const auto& device : trackedDevices) {
-                        if(millis() - device.lastSeen < 5000) activeDevices++;
-                    }
-                    tft.println("Active devices: " + String(activeDevices));
+                    tft.println("Active devices: " + String(view.recent));
                     
                     // Show active threat types
-                    for(const auto& device : trackedDevices) {
-                        if(device.isMarkedMalicious) {
+                    for(int t = 0; t <= THREAT_UNKNOWN; t++) {
+                        if(view.attacks[t]) {
                             tft.setTextColor(TFT_RED);
-                            tft.println("ATTACK: " + getAttackTypeName(device.suspectedAttack));
+                            tft.println("ATTACK: " + getThreatTypeName((ThreatType)t));
                             break;
                         }
                     }
@@ -345,7 +122,7 @@ void AntiPredatorMenu::optionsMenu() {
                 delay(50);
             }
             
-            esp_wifi_set_promiscuous(false);
+            stopThreatCapture();
             displayInfo("Defense stopped\nThreats detected: " + String(totalThreats), true);
         }},
         
@@ -356,18 +133,11 @@ void AntiPredatorMenu::optionsMenu() {
             padprintln("Press any key to stop");
             padprintln("");
             
-            // Clear previous tracking data
-            trackedDevices.clear();
-            totalThreats = 0;
-            
-            WiFi.mode(WIFI_MODE_STA);
-            
-            // Start threat monitoring system
-            esp_wifi_set_promiscuous(true);
-            esp_wifi_set_promiscuous_rx_cb(&packetCallback);
-            monitoring = true;
-            lastAnalysis = millis();
+            // Clear previous tracking data and start threat monitoring system
+            if(!startThreatCapture(sharkConfig())) return;
             
+            // Drawn from the views of the analysis task, threatEngine changes under us
+            GuardianView view = {};
             unsigned long lastDisplay = 0;
             
             while(monitoring) {
@@ -375,12 +145,7 @@ void AntiPredatorMenu::optionsMenu() {
                     monitoring = false;
                     break;
                 }
-                
-                // Run threat analysis frequently for real-time detection
-                if(millis() - lastAnalysis > 500) {
-                    analyzeThreats();
-                    lastAnalysis = millis();
-                }
+                receiveGuardianView(view);
                 
                 // Update display every 2 seconds
                 if(millis() - lastDisplay > 2000) {
@@ -393,19 +158,17 @@ void AntiPredatorMenu::optionsMenu() {
                     tft.println("MAC ADDRESS        RISK  ATTACK TYPE");
                     tft.println("--------------------------------");
                     
-                    // Display tracked devices with threat assessment
+                    // Display the riskiest devices seen in the last 10s, 6 fit the screen
                     int yPos = 70;
                     int displayCount = 0;
-                    unsigned long currentTime = millis();
                     
-                    for(const auto& device : trackedDevices) {
-                        if(displayCount >= 6) break; // Limit to 6 entries for screen space
-                        if(currentTime - device.lastSeen > 10000) continue; // Skip devices not seen in 10s
+                    for(uint8_t i = 0; i < view.count; i++) {
+                        const GuardianViewDevice& device = view.devices[i];
                         
                         tft.setCursor(5, yPos);
                         
                         // Color code based on threat level
-                        if(device.isMarkedMalicious || device.riskScore >= ATTACK_DETECTION_THRESHOLD) {
+                        if(device.malicious || device.riskScore >= detectionProfile().attackScore) {
                             tft.setTextColor(TFT_RED);  // High threats in red
                         } else if(device.riskScore > 1.0) {
                             tft.setTextColor(TFT_ORANGE);  // Medium risk in orange
@@ -416,12 +179,7 @@ void AntiPredatorMenu::optionsMenu() {
                         }
                         
                         // Format MAC address
-                        String macStr = "";
-                        for(int j = 0; j < 6; j++) {
-                            if(j > 0) macStr += ":";
-                            if(device.mac[j] < 16) macStr += "0";
-                            macStr += String(device.mac[j], HEX);
-                        }
+                        String macStr = formatSharkMac(device.mac);
                         
                         // Shorten MAC for display
                         String shortMac = macStr.substring(0, 8) + ".." + macStr.substring(15);
@@ -432,7 +190,7 @@ void AntiPredatorMenu::optionsMenu() {
                         line += String(device.riskScore, 1);
                         while(line.length() < 19) line += " ";
                         
-                        String attackType = getAttackTypeName(device.suspectedAttack);
+                        String attackType = getThreatTypeName((ThreatType)device.threat);
                         if(attackType.length() > 12) {
                             attackType = attackType.substring(0, 9) + "...";
                         }
@@ -444,9 +202,9 @@ void AntiPredatorMenu::optionsMenu() {
                         if(device.riskScore > 1.0) {
                             tft.setCursor(5, yPos + 10);
                             tft.setTextColor(TFT_CYAN);
-                            String details = "B:" + String(device.recentBeacons) + 
-                                           " P:" + String(device.recentProbes) + 
-                                           " SSIDs:" + String(device.advertisedSSIDs.size());
+                            String details = "B:" + String(device.beaconRate, 1) + 
+                                           "/s P:" + String(device.probeRate, 1) + "/s" + 
+                                           " SSIDs:" + String(device.ssidCount);
                             tft.println(details);
                             yPos += 10;
                         }
@@ -466,13 +224,13 @@ void AntiPredatorMenu::optionsMenu() {
                     // Show summary at bottom
                     tft.setCursor(5, tftHeight - 35);
                     tft.setTextColor(bruceConfig.priColor);
-                    tft.println("Tracked: " + String(trackedDevices.size()) + 
+                    tft.println("Tracked: " + String(view.tracked) + 
                               " | Threats: " + String(totalThreats));
                     
                     // Show detection thresholds
                     tft.setCursor(5, tftHeight - 25);
                     tft.setTextColor(TFT_CYAN);
-                    tft.println("Beacon threshold: >" + String(BEACON_SPAM_THRESHOLD) + "/s");
+                    tft.println("Beacon threshold: >" + String(detectionThreshold("beacon spam")) + "/s");
                     
                     // Show color legend
                     tft.setCursor(5, tftHeight - 15);
@@ -489,28 +247,17 @@ void AntiPredatorMenu::optionsMenu() {
                 delay(100);
             }
             
-            esp_wifi_set_promiscuous(false);
+            stopThreatCapture();
             
-            // Final summary
+            // Final summary, from the last view shown
             String summary = "Threat scan complete!\n";
-            summary += "Devices tracked: " + String(trackedDevices.size()) + "\n";
+            summary += "Devices tracked: " + String(view.tracked) + "\n";
             summary += "Threats detected: " + String(totalThreats) + "\n";
             
             // Show breakdown of threat types
-            int beaconSpam = 0, evilTwin = 0, deauthFlood = 0;
-            for(const auto& device : trackedDevices) {
-                if(device.isMarkedMalicious) {
-                    switch(device.suspectedAttack) {
-                        case ATTACK_BEACON_SPAM: beaconSpam++; break;
-                        case ATTACK_EVIL_TWIN: evilTwin++; break;
-                        case ATTACK_DEAUTH_FLOOD: deauthFlood++; break;
-                        case ATTACK_KARMA: break;
-                        case ATTACK_PROBE_FLOOD: break;
-                        case ATTACK_CAPTIVE_PORTAL: break;
-                        case ATTACK_UNKNOWN: break;
-                    }
-                }
-            }
+            int beaconSpam = view.attacks[THREAT_BEACON_SPAM];
+            int evilTwin = view.attacks[THREAT_EVIL_TWIN];
+            int deauthFlood = view.attacks[THREAT_DEAUTH_FLOOD];
             
             if(beaconSpam > 0) summary += "Beacon spam: " + String(beaconSpam) + "\n";
             if(evilTwin > 0) summary += "Evil twins: " + String(evilTwin) + "\n";
@@ -519,6 +266,22 @@ void AntiPredatorMenu::optionsMenu() {
             displayInfo(summary, true);
         }},
         
+        {"PCAP Replay", [=]() {
+            FS *fs;
+            String path;
+            uint16_t speed;
+            if(!selectThreatReplay(fs, path, speed)) return;
+            
+            // Same engine and hooks as the live monitor, fed from a /BrucePCAP capture
+            if(replayThreatCapture(*fs, path, speed, sharkConfig())) {
+                String summary = "Replay complete!\n";
+                summary += "Devices tracked: " + String(threatEngine.size()) + "\n";
+                summary += "Threats detected: " + String(totalThreats);
+                displayInfo(summary, true);
+            }
+            guardianClockRelease();
+        }},
+        
         {"Counter Attack", [=]() {
             // Create submenu for countermeasures
             std::vector<Option> counterOptions = {
@@ -593,33 +356,19 @@ void AntiPredatorMenu::optionsMenu() {
                     WiFi.mode(WIFI_MODE_STA);
                     int networks = WiFi.scanNetworks();
                     std::vector<String> suspiciousAPs;
-                    std::vector<String> allSSIDs;
+                    std::set<String> seen;
                     
-                    // Collect all SSIDs and look for duplicates
+                    // Lookalikes of the saved networks ("H0me-WiFi" for "HomeWiFi"),
+                    // one bit-parallel comparison per trusted SSID (guardian/ssid_lookalike.h)
+                    const SsidTrustList& trusted = trustedNetworks();
                     for(int i = 0; i < networks; i++) {
                         String ssid = WiFi.SSID(i);
-                        if(ssid.length() > 0) {
-                            allSSIDs.push_back(ssid);
-                        }
-                    }
-                    
-                    // Find potential evil twins (duplicate SSIDs)
-                    for(int i = 0; i < allSSIDs.size(); i++) {
-                        for(int j = i + 1; j < allSSIDs.size(); j++) {
-                            if(allSSIDs[i] == allSSIDs[j]) {
-                                bool alreadyAdded = false;
-                                for(const auto& sus : suspiciousAPs) {
-                                    if(sus == allSSIDs[i]) {
-                                        alreadyAdded = true;
-                                        break;
-                                    }
-                                }
-                                if(!alreadyAdded) {
-                                    suspiciousAPs.push_back(allSSIDs[i]);
-                                }
-                            }
+                        if(ssid.length() == 0 || !seen.insert(ssid).second) continue;
+                        if(trusted.lookalike(ssid.c_str(), ssid.length()) != SSID_LOOKALIKE_NONE) {
+                            suspiciousAPs.push_back(ssid);
                         }
                     }
+                    if(trusted.size() == 0) padprintln("No saved networks to compare with");
                     
                     tft.fillRect(0, 60, tftWidth, 80, bruceConfig.bgColor);
                     tft.setCursor(10, 60);
@@ -1059,28 +808,27 @@ void AntiPredatorMenu::optionsMenu() {
             padprintln("Networks found: " + String(networks));
             padprintln("");
             
-            String skimmerKeywords[] = {
-                "ATM", "VISA", "MASTERCARD", "PAYPAL",
-                "BANK", "CREDIT", "PAYMENT", "POS",
-                "TERMINAL", "STRIPE", "SQUARE"
-            };
+            // Payment and ATM names, case insensitive (guardian/ssid_matcher.h)
+            detectionProfilesBegin();
+            if(!ssidSignaturesApply()) padprintln("Not enough memory for the user signatures");
+            const SsidMatcher &signatures = ssidSignatures();
             
             for(int i = 0; i < networks; i++) {
                 String ssid = WiFi.SSID(i);
                 String bssid = WiFi.BSSIDstr(i);
                 
                 // Check for skimmer signatures
-                for(int k = 0; k < 11; k++) {
-                    if(ssid.indexOf(skimmerKeywords[k]) >= 0) {
-                        skimmersFound++;
-                        padprintln("🚨 SKIMMER DETECTED:");
-                        padprintln("SSID: " + ssid);
-                        padprintln("MAC: " + bssid);
-                        padprintln("Type: Payment fraud AP");
-                        padprintln("");
-                        Serial.println("CARD SKIMMER DETECTED: " + ssid + " (" + bssid + ")");
-                        break;
-                    }
+                uint16_t signature = signatures.find(ssid.c_str(), ssid.length(),
+                                                     ssidSignatureKindMask(SSID_SIGNATURE_SKIMMER));
+                if(signature != SSID_SIGNATURE_NONE) {
+                    skimmersFound++;
+                    padprintln("🚨 SKIMMER DETECTED:");
+                    padprintln("SSID: " + ssid);
+                    padprintln("MAC: " + bssid);
+                    padprintln("Type: Payment fraud AP");
+                    padprintln("Signature: " + String(signatures.signature(signature).pattern));
+                    padprintln("");
+                    Serial.println("CARD SKIMMER DETECTED: " + ssid + " (" + bssid + ")");
                 }
             }
             
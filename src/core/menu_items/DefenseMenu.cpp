@@ -3,6 +3,7 @@
 #include "core/utils.h"
 #include "core/mykeyboard.h"
 #include "modules/wifi/wifi_defense.h"
+#include "modules/wifi/guardian/profile_store.h"
 #include <globals.h>
 
 // Pure Defense Menu - NO OFFENSIVE CAPABILITIES
@@ -16,6 +17,8 @@ void DefenseMenu::optionsMenu() {
         {"Anti-Evil Portal",    [=]() { runAntiEvilPortal(); }},
         {"Anti-Karma Defense",  [=]() { runAntiKarmaDefense(); }},
         {"Anti-Deauth Shield",  [=]() { runAntiDeauthProtection(); }},
+        {"Learn Networks",      [=]() { runBaselineTraining(); }},
+        {"PCAP Replay",         [=]() { startThreatReplay(); }},
         {"Threat History",      [=]() { showThreatHistory(); }},
         {"Defense Settings",    [=]() { configureDefenseSettings(); }},
         {"Security Report",     [=]() { generateSecurityReport(); }},
@@ -29,13 +32,14 @@ void DefenseMenu::optionsMenu() {
 void DefenseMenu::runThreatMonitor() {
     displayHeader("Advanced Threat Monitor");
     
+    detectionProfilesBegin();
     displayInfo("🛡️ Bruce Guardian Threat Detection");
-    displayInfo("Real-time analysis of:");
-    displayInfo("✅ Beacon spam attacks (>2/s)");
+    displayInfo("Real-time analysis (" + String(detectionProfile().name) + " profile):");
+    displayInfo("✅ Beacon spam attacks (>" + String(detectionThreshold("beacon spam")) + "/s)");
     displayInfo("✅ Evil twin networks");
     displayInfo("✅ Karma attacks");  
-    displayInfo("✅ Deauth flood attacks (>1/s)");
-    displayInfo("✅ Probe floods (>5/s)");
+    displayInfo("✅ Deauth flood attacks (>" + String(detectionThreshold("deauth flood")) + "/s)");
+    displayInfo("✅ Probe floods (>" + String(detectionThreshold("probe flood")) + "/s)");
     displayInfo("✅ Suspicious network activity");
     displayInfo("");
     displayInfo("Press ESC to stop monitoring");
@@ -50,6 +54,20 @@ void DefenseMenu::runThreatMonitor() {
     delay(2000);
 }
 
+void DefenseMenu::runBaselineTraining() {
+    displayHeader("Learn Trusted Networks");
+    
+    displayInfo("Records every AP heard on all channels:");
+    displayInfo("BSSID, SSID, channel, security, elements.");
+    displayInfo("The Threat Monitor then reports downgrades,");
+    displayInfo("new BSSIDs and moved APs of these networks.");
+    displayInfo("");
+    displayInfo("Only train where the networks are trusted");
+    
+    delay(3000);
+    trainNetworkBaseline();
+}
+
 void DefenseMenu::runNetworkAnalyzer() {
     displayHeader("Network Security Analyzer");
     
@@ -130,12 +148,26 @@ void DefenseMenu::runDefenseScanner() {
     displayInfo("- Identifying vulnerabilities");
     displayInfo("- Assessing threat landscape");
     
-    delay(2000);
+    // One background scan shared by all checks, ESC cancels it
+    if(!scanSnapshotBegin()) {
+        displayError("Out of memory");
+        delay(1000);
+        return;
+    }
+    while(!scanSnapshotPoll()) {
+        if(check(EscPress)) {
+            scanSnapshotEnd();
+            return;
+        }
+        delay(50);
+    }
     
     // Run comprehensive defensive scan
-    analyzeNetworkTraffic();
-    detectRogueAccessPoints();
-    checkForEvilTwins();
+    const ScanSnapshot& snapshot = *scanSnapshotLatest();
+    analyzeNetworkTraffic(snapshot);
+    detectRogueAccessPoints(snapshot);
+    checkForEvilTwins(snapshot);
+    scanSnapshotEnd();
     
     displayInfo("Scan complete!");
     displayInfo("Check Threat History for results");
@@ -218,11 +250,13 @@ void DefenseMenu::runAntiDeauthProtection() {
 void DefenseMenu::showThreatHistory() {
     displayHeader("Threat Detection History");
     
-    if(trackedDevices.empty()) {
+    const ThreatHistory& history = threatEngine.history();
+    if(threatEngine.empty() && history.empty()) {
         displayInfo("No devices tracked in current session");
         displayInfo("");
         displayInfo("Run Advanced Threat Monitor to begin");
         waitForKeyPress();
+        showThreatJournal();
         return;
     }
     
@@ -235,10 +269,11 @@ void DefenseMenu::showThreatHistory() {
     tft.drawLine(5, 25, tft.width()-5, 25, TFT_CYAN);
     
     int yPos = 35;
-    int maxDisplay = min((int)trackedDevices.size(), 7);
+    int displayCount = 0;
     
-    for (int i = 0; i < maxDisplay; i++) {
-        const AdvancedThreatDevice& device = trackedDevices[i];
+    for (size_t i = 0; i < threatEngine.size(); i++) {
+        if (displayCount >= 7) break;
+        const ThreatDevice device = threatEngine.device(i);
         
         uint16_t color = TFT_GREEN;
         if (device.isMarkedMalicious) color = TFT_RED;
@@ -267,33 +302,88 @@ void DefenseMenu::showThreatHistory() {
         tft.printf("%.8s", threatType.c_str());
         
         yPos += 12;
+        displayCount++;
+    }
+    
+    // Devices that went quiet and were expired, newest first, with their peak score
+    for (size_t i = 0; i < history.size(); i++) {
+        if (displayCount >= 7) break;
+        const ThreatSummary& summary = history.at(i);
+        
+        tft.setTextColor(summary.malicious ? TFT_RED : TFT_DARKGREY);
+        tft.setCursor(5, yPos);
+        tft.printf("%02x:%02x:%02x..", summary.mac[0], summary.mac[1], summary.mac[2]);
+        tft.setCursor(75, yPos);
+        tft.printf("%.1f", summary.peakRisk);
+        tft.setCursor(95, yPos);
+        tft.printf("%.8s", getThreatTypeName((ThreatType)summary.threat).c_str());
+        
+        yPos += 12;
+        displayCount++;
     }
     
     // Stats
     tft.setTextColor(TFT_GREEN);
     tft.setCursor(5, tft.height() - 35);
-    tft.printf("Total Tracked: %d", trackedDevices.size());
+    tft.printf("Total Tracked: %d (expired %u)", threatEngine.size(), threatEngine.expired() + threatEngine.evicted());
     tft.setCursor(5, tft.height() - 25);
     tft.printf("Confirmed Threats: %d", totalThreats);
     tft.setCursor(5, tft.height() - 15);
-    tft.printf("Risk Threshold: %.1f", (float)ATTACK_DETECTION_THRESHOLD);
+    tft.printf("Risk Threshold: %u (%s)", detectionProfile().attackScore, detectionProfile().name);
     
     waitForKeyPress();
+    showThreatJournal();
 }
 
-void DefenseMenu::configureDefenseSettings() {
-    displayHeader("Defense Configuration");
+// Incidents journaled on flash by this and earlier sessions, newest first
+void DefenseMenu::showThreatJournal() {
+    if (!openThreatJournal()) return;
+    threatJournalFlush();
     
-    options = {
-        {"Detection Sensitivity", [=]() { displayInfo("Sensitivity: Normal"); delay(1000); }},
-        {"Alert Threshold",       [=]() { displayInfo("Threshold: 75%"); delay(1000); }},
-        {"Monitoring Interval",   [=]() { displayInfo("Interval: 2 seconds"); delay(1000); }},
-        {"Logging Level",         [=]() { displayInfo("Logging: Detailed"); delay(1000); }},
-        {"Auto-Response",         [=]() { displayInfo("Auto-Response: Alert Only"); delay(1000); }},
-        {"Back",                  [=]() { returnToMenu = true; }}
-    };
+    JournalRecord records[7];
+    const size_t count = threatJournalLast(records, 7);
+    if (count == 0) return;
     
-    loopOptions(options);
+    tft.fillScreen(TFT_BLACK);
+    tft.setTextColor(TFT_WHITE);
+    tft.setTextSize(1);
+    
+    tft.setCursor(5, 10);
+    tft.println("Threat Journal:");
+    tft.drawLine(5, 25, tft.width()-5, 25, TFT_CYAN);
+    
+    int yPos = 35;
+    for (size_t i = 0; i < count; i++) {
+        const JournalRecord& rec = records[i];
+        
+        // How often the journal has seen this MAC (up to 9, older records were compacted)
+        JournalRecord seen[9];
+        const size_t times = threatJournalFind(rec.mac, seen, 9);
+        
+        tft.setTextColor(times > 1 ? TFT_RED : TFT_ORANGE);
+        tft.setCursor(5, yPos);
+        tft.printf("%02x:%02x:%02x..", rec.mac[0], rec.mac[1], rec.mac[2]);
+        tft.setCursor(75, yPos);
+        tft.printf("%.8s", getThreatTypeName((ThreatType)rec.type).c_str());
+        tft.setCursor(130, yPos);
+        tft.printf("x%u", (unsigned)times);
+        
+        yPos += 12;
+    }
+    
+    const ThreatJournalStats stats = threatJournalStats();
+    tft.setTextColor(TFT_GREEN);
+    tft.setCursor(5, tft.height() - 25);
+    tft.printf("Logged: %u incidents", stats.nextSeq - 1);
+    tft.setCursor(5, tft.height() - 15);
+    tft.printf("Segments: %u (" JOURNAL_DIR ")", stats.segments);
+    
+    waitForKeyPress();
+}
+
+void DefenseMenu::configureDefenseSettings() {
+    displayHeader("Defense Configuration");
+    ::configureDefenseSettings();
 }
 
 void DefenseMenu::generateSecurityReport() {
@@ -337,13 +427,14 @@ void DefenseMenu::generateSecurityReport() {
     tft.println("SECURITY STATUS:");
     yPos += 15;
     
-    tft.setTextColor(activeThreatsList.empty() ? TFT_GREEN : TFT_YELLOW);
+    const size_t activeThreats = threatIncidents.active();
+    tft.setTextColor(activeThreats == 0 ? TFT_GREEN : TFT_YELLOW);
     tft.setCursor(5, yPos);
-    tft.printf("Active Threats: %d", activeThreatsList.size());
+    tft.printf("Active Threats: %d", activeThreats);
     yPos += 12;
     
-    String status = activeThreatsList.empty() ? "SECURE" : "MONITORING";
-    uint16_t statusColor = activeThreatsList.empty() ? TFT_GREEN : TFT_YELLOW;
+    String status = activeThreats == 0 ? "SECURE" : "MONITORING";
+    uint16_t statusColor = activeThreats == 0 ? TFT_GREEN : TFT_YELLOW;
     
     tft.setTextColor(statusColor);
     tft.setCursor(5, yPos);
@@ -10,9 +10,11 @@ public:
 
 private:
     void runThreatMonitor();
+    void runBaselineTraining();
     void runNetworkAnalyzer(); 
     void runDefenseScanner();
     void showThreatHistory();
+    void showThreatJournal();
     void configureDefenseSettings();
     void runAntiEvilPortal();
     void runAntiKarmaDefense();
@@ -0,0 +1,124 @@
+#include "oui_db.h"
+#include "sd_functions.h"
+
+// Layout written by tools/oui_gen/oui_gen.py, little endian like the ESP32
+#define OUI_BUCKETS 4096 // by the top 12 bits of the OUI
+#define OUI_HEADER_SIZE 16
+#define OUI_NAME_MAX 64
+
+struct OuiDb {
+    File file;
+    bool tried; // opened once, or found missing
+    uint32_t entries;
+    uint32_t vendors;
+    uint32_t entriesAt;
+    uint32_t vendorsAt;
+    uint32_t stringsAt;
+};
+
+struct OuiCacheEntry {
+    uint32_t oui; // UINT32_MAX = empty
+    char vendor[32];
+};
+
+static OuiDb db;
+static OuiCacheEntry cache[OUI_DB_CACHE];
+
+static bool readAt(uint32_t offset, void *buf, size_t len) {
+    return db.file.seek(offset) && db.file.read((uint8_t *)buf, len) == len;
+}
+
+bool ouiDbReady() {
+    if (db.tried) return (bool)db.file;
+    db.tried = true;
+    for (size_t i = 0; i < OUI_DB_CACHE; i++) cache[i].oui = UINT32_MAX;
+
+    FS *fs;
+    if (!getFsStorage(fs) || !fs->exists(OUI_DB_FILE)) return false;
+    db.file = fs->open(OUI_DB_FILE, FILE_READ);
+    if (!db.file) return false;
+
+    uint8_t header[OUI_HEADER_SIZE];
+    uint32_t stringsSize;
+    if (!readAt(0, header, sizeof(header)) || memcmp(header, "OUI1", 4) != 0) {
+        Serial.println("[OUI] " OUI_DB_FILE " is not an OUI1 table, see tools/oui_gen");
+        db.file.close();
+        return false;
+    }
+    memcpy(&db.entries, header + 4, 4);
+    memcpy(&db.vendors, header + 8, 4);
+    memcpy(&stringsSize, header + 12, 4);
+    db.entriesAt = OUI_HEADER_SIZE + (OUI_BUCKETS + 1) * 4;
+    db.vendorsAt = db.entriesAt + db.entries * 4;
+    db.stringsAt = db.vendorsAt + db.vendors * 4;
+    if (db.file.size() < db.stringsAt + stringsSize) {
+        Serial.println("[OUI] " OUI_DB_FILE " is truncated");
+        db.file.close();
+        return false;
+    }
+    Serial.printf("[OUI] %u vendors for %u OUIs\n", (unsigned)db.vendors, (unsigned)db.entries);
+    return true;
+}
+
+void ouiDbClose() {
+    if (db.file) db.file.close();
+    db.tried = false;
+}
+
+// Vendor of oui from the file, "" when it is not registered
+static bool findVendor(uint32_t oui, char *vendor, size_t size) {
+    vendor[0] = '\0';
+    uint32_t range[2];
+    if (!readAt(OUI_HEADER_SIZE + (oui >> 12) * 4, range, sizeof(range))) return false;
+
+    // Buckets are skewed (early assignments crowd a few), binary search the sorted entries
+    const uint16_t low = oui & 0xFFF;
+    uint16_t found = UINT16_MAX;
+    uint32_t lo = range[0], hi = range[1] < db.entries ? range[1] : db.entries;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        uint16_t entry[2];
+        if (!readAt(db.entriesAt + mid * 4, entry, sizeof(entry))) return false;
+        if (entry[0] == low) {
+            found = entry[1];
+            break;
+        }
+        if (entry[0] < low) lo = mid + 1;
+        else hi = mid;
+    }
+    if (found == UINT16_MAX || found >= db.vendors) return true;
+
+    uint32_t offset;
+    char name[OUI_NAME_MAX];
+    if (!readAt(db.vendorsAt + found * 4, &offset, 4) || !db.file.seek(db.stringsAt + offset)) return false;
+    const size_t len = db.file.read((uint8_t *)name, sizeof(name) - 1);
+    name[len] = '\0';
+    strncpy(vendor, name, size - 1);
+    vendor[size - 1] = '\0';
+    return true;
+}
+
+bool ouiLookup(const uint8_t *mac, char *vendor, size_t size) {
+    if (size == 0) return false;
+    vendor[0] = '\0';
+    if (mac[0] & 0x02) return false; // locally administered: random or private, not registered
+    if (!ouiDbReady()) return false;
+
+    const uint32_t oui = ((uint32_t)mac[0] << 16) | (mac[1] << 8) | mac[2];
+    OuiCacheEntry &slot = cache[(oui ^ (oui >> 12)) & (OUI_DB_CACHE - 1)];
+    if (slot.oui != oui) {
+        if (!findVendor(oui, slot.vendor, sizeof(slot.vendor))) {
+            ouiDbClose(); // read error, the card may be gone
+            return false;
+        }
+        slot.oui = oui;
+    }
+    strncpy(vendor, slot.vendor, size - 1);
+    vendor[size - 1] = '\0';
+    return vendor[0] != '\0';
+}
+
+String ouiVendor(const uint8_t *mac) {
+    char vendor[32];
+    return ouiLookup(mac, vendor, sizeof(vendor)) ? String(vendor) : String();
+}
@@ -0,0 +1,40 @@
+#ifndef __OUI_DB_H__
+#define __OUI_DB_H__
+
+#include <Arduino.h>
+
+// Offline MAC vendor lookup.
+// The IEEE OUI registry, converted by tools/oui_gen/oui_gen.py (the build writes
+// it to sd_files/oui.bin, see pre_build_oui.py), sits in OUI_DB_FILE on the SD
+// card (LittleFS without one) and stays there: a lookup reads the range of the
+// OUI's bucket, binary searches it with 4 byte reads (at most 13, a bucket holds
+// up to 4096 OUIs) and reads one deduplicated name. Recent results are cached in RAM.
+// Nothing leaves the device. Call from the UI task.
+
+#define OUI_DB_FILE "/oui.bin"
+#define OUI_DB_CACHE 16 // recent lookups kept, power of two
+
+/**
+ * @brief Vendor registered for the OUI of mac
+ * @param vendor set to the name, truncated to size - 1 bytes
+ * @return false when the OUI is unknown, mac is locally administered or there is no database
+ */
+bool ouiLookup(const uint8_t *mac, char *vendor, size_t size);
+
+/**
+ * @brief ouiLookup() as a String, empty when not found
+ */
+String ouiVendor(const uint8_t *mac);
+
+/**
+ * @brief Opens OUI_DB_FILE on first use
+ * @return false if there is no valid database
+ */
+bool ouiDbReady();
+
+/**
+ * @brief Closes the database (card removed or replaced), the next lookup opens it again
+ */
+void ouiDbClose();
+
+#endif
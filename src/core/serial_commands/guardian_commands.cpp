@@ -0,0 +1,87 @@
+#include "guardian_commands.h"
+#include "modules/wifi/guardian/guardian_stats.h"
+#include "modules/wifi/guardian/profile_store.h"
+#include "modules/wifi/wifi_defense.h"
+#include <globals.h>
+
+uint32_t guardianStatsCallback(cmd *c) {
+    Command cmd(c);
+    String action = cmd.getArgument("action").getValue();
+    action.trim();
+
+    if (action == "") {
+        printGuardianStats();
+        return true;
+    } else if (action == "json") {
+        Serial.println(guardianStatsJson());
+        return true;
+    } else if (action == "reset") {
+#if GUARDIAN_STATS
+        guardianStatsReset();
+#endif
+        Serial.println("Guardian histograms cleared");
+        return true;
+    }
+
+    Serial.println(
+        "Invalid action: " + action +
+        "\n"
+        "Possible commands: \n"
+        "-> guardian stats       (hot path latency histograms, queue depths and drops)\n"
+        "-> guardian stats json  (same, as JSON)\n"
+        "-> guardian stats reset (clears the histograms)"
+    );
+    return false;
+}
+
+static void printDetectionProfile() {
+    const DetectionProfile &profile = detectionProfile();
+    Serial.printf("Detection profile: %s\n", profile.name);
+    for (size_t k = 0; k < detectionProfileKeyCount(); k++) {
+        Serial.printf("  %-15s %u\n", detectionProfileKey(k), detectionProfileGet(profile, k));
+    }
+}
+
+uint32_t guardianProfileCallback(cmd *c) {
+    Command cmd(c);
+    String name = cmd.getArgument("name").getValue();
+    name.trim();
+
+    detectionProfilesBegin();
+    if (name == "") {
+        printDetectionProfile();
+        return true;
+    } else if (name == "list") {
+        for (const String &profile : detectionProfileNames()) {
+            Serial.println((profile == detectionProfile().name ? "* " : "  ") + profile);
+        }
+        return true;
+    } else if (name == "reload") {
+        // Takes effect on the next analysis pass, staleness on the next monitor start
+        if (!detectionProfilesLoad()) return false;
+        printDetectionProfile();
+        return true;
+    } else if (detectionProfileSelect(name.c_str())) {
+        printDetectionProfile();
+        return true;
+    }
+
+    Serial.println(
+        "Possible commands: \n"
+        "-> guardian profile        (thresholds of the active detection profile)\n"
+        "-> guardian profile list   (profiles of " DETECTION_PROFILES_FILE " and the built-in ones)\n"
+        "-> guardian profile reload (re-reads " DETECTION_PROFILES_FILE ")\n"
+        "-> guardian profile <name> (activates a profile and keeps it active)"
+    );
+    return false;
+}
+
+void createGuardianCommands(SimpleCLI *cli) {
+    Command cmd = cli->addCompositeCommand("guardian");
+
+    Command statsCmd = cmd.addCommand("stats", guardianStatsCallback);
+    statsCmd.addPosArg("action", "");
+
+    Command profileCmd = cmd.addCommand("profile", guardianProfileCallback);
+    profileCmd.addPosArg("name", "");
+}
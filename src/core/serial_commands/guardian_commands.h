@@ -0,0 +1,8 @@
+#ifndef __SERIAL_GUARDIAN_CMD_H__
+#define __SERIAL_GUARDIAN_CMD_H__
+
+#include <SimpleCLI.h>
+
+void createGuardianCommands(SimpleCLI *cli);
+
+#endif
@@ -8,6 +8,7 @@
 #include "core/utils.h"
 #include "core/wifi/wifi_common.h" // using common wifisetup
 #include "esp_task_wdt.h"
+#include "modules/wifi/wifi_defense.h" // Guardian stats
 #include "webFiles.h"
 #include <globals.h>
 
@@ -394,6 +395,15 @@ void configureWebServer() {
         request->send(200, "application/json", response_body);
     });
 
+    // Guardian hot path histograms and counters, as printed by "guardian stats json"
+    server->on("/guardianstats", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (checkUserWebAuth(request)) {
+            request->send(200, "application/json", guardianStatsJson());
+        } else {
+            return request->requestAuthentication();
+        }
+    });
+
     server->on("/getscreen", HTTP_GET, [](AsyncWebServerRequest *request) {
         uint8_t binData[MAX_LOG_ENTRIES * MAX_LOG_SIZE];
         size_t binSize = 0;
@@ -11,6 +11,8 @@
 #include "HostInfo.h"
 #include "core/display.h"
 #include "core/mykeyboard.h"
+#include "core/net_utils.h"
+#include "core/oui_db.h"
 #include "core/utils.h"
 #include "core/wifi/wifi_common.h"
 #include "esp_netif_net_stack.h"
@@ -209,6 +211,10 @@ ScanHostMenu:
     for (auto host : hostslist_eth) {
         String result = host.ip.toString();
         if (host.ip == gateway) result += "(GTW)";
+        uint8_t hostMac[6];
+        stringToMAC(host.mac.c_str(), hostMac);
+        String vendor = ouiVendor(hostMac);
+        if (!vendor.isEmpty()) result += " " + vendor;
         options.push_back({result.c_str(), [=]() { afterScanOptions(host); }});
     }
     addOptionToMainMenu();
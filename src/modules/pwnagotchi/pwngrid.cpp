@@ -11,6 +11,7 @@ Thanks to @bmorcelli (Pirata) for his help doing a better code.
 
 #include "pwngrid.h"
 #include "../wifi/sniffer.h"
+#include "modules/wifi/guardian/ieee80211.h"
 
 uint8_t pwngrid_friends_tot = 0;
 std::vector<pwngrid_peer> pwngrid_peers;
@@ -203,107 +204,66 @@ signed int getPwngridClosestRssi() {
 // Detect pwnagotchi adapted from Marauder
 // https://github.com/justcallmekoko/ESP32Marauder/wiki/detect-pwnagotchi
 // https://github.com/justcallmekoko/ESP32Marauder/blob/master/esp32_marauder/WiFiScan.cpp#L2255
-typedef struct {
-    int16_t fctl;
-    int16_t duration;
-    uint8_t da;
-    uint8_t sa;
-    uint8_t bssid;
-    int16_t seqctl;
-    unsigned char payload[];
-} __attribute__((packed)) WifiMgmtHdr;
-
-typedef struct {
-    uint8_t payload[0];
-    WifiMgmtHdr hdr;
-} wifi_ieee80211_packet_t;
-
-void getMAC(char *addr, uint8_t *data, uint16_t offset) {
-    sprintf(
-        addr,
-        "%02x:%02x:%02x:%02x:%02x:%02x",
-        data[offset + 0],
-        data[offset + 1],
-        data[offset + 2],
-        data[offset + 3],
-        data[offset + 4],
-        data[offset + 5]
-    );
-}
-
 void pwnSnifferCallback(void *buf, wifi_promiscuous_pkt_type_t type) {
     sniffer(buf, type);
     wifi_promiscuous_pkt_t *snifferPacket = (wifi_promiscuous_pkt_t *)buf;
-    WifiMgmtHdr *frameControl = (WifiMgmtHdr *)snifferPacket->payload;
-
-    const uint8_t *frame = snifferPacket->payload;
-    const uint16_t frameCtrl = (uint16_t)frame[0] | ((uint16_t)frame[1] << 8);
-    const uint8_t frameType = (frameCtrl & 0x0C) >> 2;
-    const uint8_t frameSubType = (frameCtrl & 0xF0) >> 4;
-
-    if (frameType == 0x00 && frameSubType == 0x08) {
-        const uint8_t *addr1 = snifferPacket->payload + 4;  // Adresse du destinataire (Adresse 1)
-        const uint8_t *addr2 = snifferPacket->payload + 10; // Adresse de l'expéditeur (Adresse 2)
-        const uint8_t *bssid = snifferPacket->payload + 16; // Adresse BSSID (Adresse 3)
-        const uint8_t *apAddr;
-
-        if (memcmp(addr1, bssid, 6) == 0) {
-            apAddr = addr1;
-        } else {
-            apAddr = addr2;
-        }
-        BeaconList Beacon;
-        memcpy(Beacon.MAC, apAddr, 6);
-        Beacon.channel = ch;
-        if (registeredBeacons.find(Beacon) == registeredBeacons.end()) {
-            registeredBeacons.insert(Beacon); // Save a new MAC to Deauth
-        }
+    if (type != WIFI_PKT_MGMT || snifferPacket->rx_ctrl.sig_len <= IEEE80211_FCS_LEN) return;
+
+    // Remove frame check sequence bytes
+    Ieee80211Frame frame;
+    if (!frame.parse(snifferPacket->payload, snifferPacket->rx_ctrl.sig_len - IEEE80211_FCS_LEN)) return;
+    if (!frame.isBeacon()) return;
+
+    const uint8_t *addr1 = frame.addr1(); // Adresse du destinataire (Adresse 1)
+    const uint8_t *addr2 = frame.addr2(); // Adresse de l'expéditeur (Adresse 2)
+    const uint8_t *bssid = frame.addr3(); // Adresse BSSID (Adresse 3)
+    const uint8_t *apAddr;
+
+    if (memcmp(addr1, bssid, 6) == 0) {
+        apAddr = addr1;
+    } else {
+        apAddr = addr2;
+    }
+    BeaconList Beacon;
+    memcpy(Beacon.MAC, apAddr, 6);
+    Beacon.channel = ch;
+    if (registeredBeacons.find(Beacon) == registeredBeacons.end()) {
+        registeredBeacons.insert(Beacon); // Save a new MAC to Deauth
     }
 
-    String src = "";
-    String essid = "";
+    static const uint8_t pwnagotchiMac[6] = {0xde, 0xad, 0xbe, 0xef, 0xde, 0xad};
+    if (memcmp(addr2, pwnagotchiMac, 6) != 0) return;
 
-    if (type == WIFI_PKT_MGMT) {
-        // Remove frame check sequence bytes
-        int len = snifferPacket->rx_ctrl.sig_len - 4;
-        int fctl = ntohs(frameControl->fctl);
-        const wifi_ieee80211_packet_t *ipkt = (wifi_ieee80211_packet_t *)snifferPacket->payload;
-        const WifiMgmtHdr *hdr = &ipkt->hdr;
-
-        // if ((snifferPacket->payload[0] == 0x80) && (buf == 0)) {
-        if ((snifferPacket->payload[0] == 0x80)) {
-            char addr[] = "00:00:00:00:00:00";
-            getMAC(addr, snifferPacket->payload, 10);
-            src.concat(addr);
-            if (src == "de:ad:be:ef:de:ad") {
-                // Just grab the first 255 bytes of the pwnagotchi beacon
-                // because that is where the name is
-                for (int i = 38; i < len; i++) {
-                    if (isAscii(snifferPacket->payload[i])) { essid.concat((char)snifferPacket->payload[i]); }
-                }
-
-                JsonDocument sniffed_json; // ArduinoJson v6s
-                DeserializationError result = deserializeJson(sniffed_json, essid);
-
-                if (result == DeserializationError::Ok) {
-                    // Serial.println("\nSuccessfully parsed json");
-                    // serializeJson(json, Serial);  // ArduinoJson v6
-                    add_new_peer(sniffed_json, snifferPacket->rx_ctrl.rssi);
-                } else if (result == DeserializationError::IncompleteInput) {
-                    Serial.println("Deserialization error: incomplete input");
-                } else if (result == DeserializationError::NoMemory) {
-                    Serial.println("Deserialization error: no memory");
-                } else if (result == DeserializationError::InvalidInput) {
-                    Serial.println("Deserialization error: invalid input");
-                } else if (result == DeserializationError::TooDeep) {
-                    Serial.println("Deserialization error: too deep");
-                } else {
-                    Serial.println(essid);
-                    Serial.println("Deserialization error");
-                }
-            }
+    // The pwnagotchi json is split across vendor IEs 222 (AC), 255 bytes each
+    String essid = "";
+    Ieee80211IeIterator it = frame.ies();
+    Ieee80211Ie ie;
+    while (it.next(ie)) {
+        if (ie.id != 0xde) continue;
+        for (int i = 0; i < ie.len; i++) {
+            if (isAscii(ie.data[i])) { essid.concat((char)ie.data[i]); }
         }
     }
+
+    JsonDocument sniffed_json; // ArduinoJson v6s
+    DeserializationError result = deserializeJson(sniffed_json, essid);
+
+    if (result == DeserializationError::Ok) {
+        // Serial.println("\nSuccessfully parsed json");
+        // serializeJson(json, Serial);  // ArduinoJson v6
+        add_new_peer(sniffed_json, snifferPacket->rx_ctrl.rssi);
+    } else if (result == DeserializationError::IncompleteInput) {
+        Serial.println("Deserialization error: incomplete input");
+    } else if (result == DeserializationError::NoMemory) {
+        Serial.println("Deserialization error: no memory");
+    } else if (result == DeserializationError::InvalidInput) {
+        Serial.println("Deserialization error: invalid input");
+    } else if (result == DeserializationError::TooDeep) {
+        Serial.println("Deserialization error: too deep");
+    } else {
+        Serial.println(essid);
+        Serial.println("Deserialization error");
+    }
 }
 
 const wifi_promiscuous_filter_t filter = {
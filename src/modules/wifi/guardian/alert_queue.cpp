@@ -0,0 +1,110 @@
+#include "alert_queue.h"
+#include <string.h>
+
+uint16_t guardianAlertPriority(const ThreatIncident &incident) {
+    // Attacks on clients first, then rogue infrastructure, then floods that only add noise
+    static const uint8_t severity[] = {
+        1, // THREAT_BEACON_SPAM
+        3, // THREAT_EVIL_TWIN
+        3, // THREAT_KARMA_ATTACK
+        3, // THREAT_DEAUTH_FLOOD
+        1, // THREAT_PROBE_FLOOD
+        2, // THREAT_CAPTIVE_PORTAL
+        2, // THREAT_ROGUE_AP
+        0  // THREAT_UNKNOWN
+    };
+    const uint8_t level = incident.type < sizeof(severity) ? severity[incident.type] : 0;
+    float confidence = incident.peakConfidence;
+    if (confidence < 0) confidence = 0;
+    if (confidence > 1) confidence = 1;
+    return level * 100 + (uint16_t)(confidence * 99);
+}
+
+void GuardianAlertQueue::clear() {
+    _count = 0;
+    _recentCount = 0;
+    _recentNext = 0;
+    _stats = {};
+}
+
+bool GuardianAlertQueue::push(const ThreatIncident &incident, uint32_t now) {
+    for (size_t i = 0; i < _recentCount; i++) {
+        const Recent &r = _recent[i];
+        if (r.type != incident.type || memcmp(r.mac, incident.mac, 6) != 0) continue;
+        if (now - r.shownAt < ALERT_REPEAT_MS) {
+            _stats.repeated++;
+            return false;
+        }
+        break;
+    }
+
+    const uint16_t priority = guardianAlertPriority(incident);
+    for (size_t i = 0; i < _count; i++) {
+        GuardianAlert &alert = _alerts[i];
+        if (alert.incident.type != incident.type || memcmp(alert.incident.mac, incident.mac, 6) != 0) continue;
+        alert.incident = incident;
+        if (priority > alert.priority) alert.priority = priority;
+        if (alert.merged < UINT16_MAX) alert.merged++;
+        _stats.merged++;
+        return true;
+    }
+
+    size_t slot = _count;
+    if (_count < ALERT_QUEUE_CAPACITY) {
+        _count++;
+    } else {
+        // Push out the least urgent alert, the newest between equals: it has waited the least
+        slot = 0;
+        for (size_t i = 1; i < _count; i++) {
+            const GuardianAlert &a = _alerts[i];
+            const GuardianAlert &b = _alerts[slot];
+            if (a.priority != b.priority ? a.priority < b.priority : (int32_t)(a.queuedAt - b.queuedAt) >= 0) {
+                slot = i;
+            }
+        }
+        _stats.dropped++;
+        if (priority <= _alerts[slot].priority) return false;
+    }
+
+    GuardianAlert &alert = _alerts[slot];
+    alert.incident = incident;
+    alert.priority = priority;
+    alert.merged = 1;
+    alert.queuedAt = now;
+    _stats.raised++;
+    return true;
+}
+
+bool GuardianAlertQueue::pop(GuardianAlert &out, uint32_t now) {
+    if (_count == 0) return false;
+
+    size_t best = 0;
+    for (size_t i = 1; i < _count; i++) {
+        const GuardianAlert &a = _alerts[i];
+        const GuardianAlert &b = _alerts[best];
+        if (a.priority != b.priority ? a.priority > b.priority : (int32_t)(a.queuedAt - b.queuedAt) < 0) best = i;
+    }
+    out = _alerts[best];
+    _alerts[best] = _alerts[--_count];
+    _stats.shown++;
+
+    // Remember when the incident was shown, in its old entry or in place of the oldest
+    Recent *recent = nullptr;
+    for (size_t i = 0; i < _recentCount && !recent; i++) {
+        if (_recent[i].type == out.incident.type && memcmp(_recent[i].mac, out.incident.mac, 6) == 0) {
+            recent = &_recent[i];
+        }
+    }
+    if (!recent) {
+        if (_recentCount < ALERT_RECENT_CAPACITY) {
+            recent = &_recent[_recentCount++];
+        } else {
+            recent = &_recent[_recentNext];
+            _recentNext = (_recentNext + 1) % ALERT_RECENT_CAPACITY;
+        }
+        memcpy(recent->mac, out.incident.mac, 6);
+        recent->type = out.incident.type;
+    }
+    recent->shownAt = now;
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef __GUARDIAN_ALERT_QUEUE_H__
+#define __GUARDIAN_ALERT_QUEUE_H__
+
+#include "threat_incidents.h"
+
+// Alerts waiting for the monitor screen.
+// Detections only queue an alert, the UI task shows them one at a time, most
+// urgent first. A detection of an incident (MAC, ThreatType) already waiting is
+// merged into that alert, and an incident shown less than ALERT_REPEAT_MS ago
+// is not shown again, so a flood raising the same threat on every analysis pass
+// ends up as one banner. The queue is a fixed array: when full, an alert only
+// gets in by pushing out a less urgent one.
+// Not thread safe, the caller serializes access.
+
+#define ALERT_QUEUE_CAPACITY 8
+#define ALERT_RECENT_CAPACITY 32 // incidents remembered for the repeat limit
+#define ALERT_REPEAT_MS 30000
+
+struct GuardianAlert {
+    ThreatIncident incident; // snapshot of the latest detection
+    uint16_t priority;
+    uint16_t merged;         // detections merged into this alert, 1 if none
+    uint32_t queuedAt;
+};
+
+struct GuardianAlertStats {
+    uint32_t raised;    // alerts queued
+    uint32_t merged;    // detections merged into a waiting alert
+    uint32_t repeated;  // detections within ALERT_REPEAT_MS of their last alert
+    uint32_t dropped;   // pushed out or turned away by a full queue
+    uint32_t shown;
+};
+
+/**
+ * @brief Urgency of an incident: its threat type first, then confidence
+ */
+uint16_t guardianAlertPriority(const ThreatIncident &incident);
+
+class GuardianAlertQueue {
+public:
+    void clear();
+
+    /**
+     * @brief Queues an alert for incident, or merges it into the one waiting
+     * @return false if the alert was suppressed or the queue had no room for it
+     */
+    bool push(const ThreatIncident &incident, uint32_t now);
+
+    /**
+     * @brief Takes the most urgent alert, the oldest one between equals
+     * @note The incident of the alert is not shown again for ALERT_REPEAT_MS after now
+     * @return false if no alert is waiting
+     */
+    bool pop(GuardianAlert &out, uint32_t now);
+
+    size_t size() const { return _count; }
+    bool empty() const { return _count == 0; }
+    const GuardianAlertStats &stats() const { return _stats; }
+
+private:
+    struct Recent {
+        uint8_t mac[6];
+        uint8_t type;
+        uint32_t shownAt;
+    };
+
+    GuardianAlert _alerts[ALERT_QUEUE_CAPACITY];
+    size_t _count = 0;
+    Recent _recent[ALERT_RECENT_CAPACITY];
+    size_t _recentCount = 0;
+    size_t _recentNext = 0; // oldest entry once the list is full
+    GuardianAlertStats _stats = {};
+};
+
+#endif
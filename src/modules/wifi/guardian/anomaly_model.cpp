@@ -0,0 +1,24 @@
+#include "anomaly_model.h"
+#include "anomaly_weights.h"
+
+const char *const anomalyFeatureNames[ANOMALY_FEATURES] = {
+    "beacon rate", "probe rate", "response rate", "deauth rate",     "auth rate",
+    "ssid count",  "rssi var",   "seq gap",       "arrival entropy",
+};
+
+const char *const anomalyClassNames[ANOMALY_CLASSES] = {"benign", "beacon spam", "deauth flood", "probe flood"};
+
+int32_t anomalyScore(const AnomalyModel &model, const int16_t *features, uint8_t &cls) {
+    int32_t logit[ANOMALY_CLASSES];
+    for (size_t c = 0; c < ANOMALY_CLASSES; c++) {
+        int32_t acc = model.bias[c];
+        for (size_t f = 0; f < ANOMALY_FEATURES; f++) acc += model.weight[c][f] * features[f];
+        logit[c] = acc;
+    }
+
+    cls = ANOMALY_BENIGN + 1;
+    for (size_t c = cls + 1; c < ANOMALY_CLASSES; c++) {
+        if (logit[c] > logit[cls]) cls = c;
+    }
+    return logit[cls] - logit[ANOMALY_BENIGN];
+}
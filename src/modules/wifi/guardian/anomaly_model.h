@@ -0,0 +1,145 @@
+#ifndef __GUARDIAN_ANOMALY_MODEL_H__
+#define __GUARDIAN_ANOMALY_MODEL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Learned alternative to the rule table of threat_engine.cpp.
+// Every device is described by a small vector of fixed-point features (decayed
+// rates per frame subtype, SSID count, RSSI variance, sequence number gaps and the
+// entropy of its inter-arrival times), and a multinomial linear model with int8
+// weights scores it against each rate based attack. The weights are a const table
+// in flash (anomaly_weights.h), written by tools/guardian_train from labeled
+// captures; inference is ANOMALY_CLASSES * ANOMALY_FEATURES integer multiply-adds.
+// Features are log scaled in Q8 so one weight covers a device sending 2 or 200
+// frames/s, and they are computed from the engine's columns with the helpers
+// below only, so the trainer and the device see the same numbers.
+
+enum AnomalyFeature {
+    ANOMALY_BEACON_RATE,     // log2(1 + beacons/s)
+    ANOMALY_PROBE_RATE,      // log2(1 + probe requests/s)
+    ANOMALY_RESPONSE_RATE,   // log2(1 + probe responses/s)
+    ANOMALY_DEAUTH_RATE,     // log2(1 + genuine deauths/s)
+    ANOMALY_AUTH_RATE,       // log2(1 + auth/(re)assoc frames/s)
+    ANOMALY_SSID_COUNT,      // log2(1 + distinct SSIDs advertised)
+    ANOMALY_RSSI_VARIANCE,   // log2(1 + dB^2), 0 without RSSI (LINKTYPE 105 replays)
+    ANOMALY_SEQ_GAP,         // log2(1 + mean skipped sequence numbers)
+    ANOMALY_ARRIVAL_ENTROPY, // bits, of the inter-arrival time histogram
+    ANOMALY_FEATURES
+};
+
+// What the model tells apart, threat_engine.h maps them to ThreatType
+enum AnomalyClass { ANOMALY_BENIGN, ANOMALY_BEACON_SPAM, ANOMALY_DEAUTH_FLOOD, ANOMALY_PROBE_FLOOD, ANOMALY_CLASSES };
+
+extern const char *const anomalyFeatureNames[ANOMALY_FEATURES];
+extern const char *const anomalyClassNames[ANOMALY_CLASSES];
+
+/**
+ * @brief logit[c] = (bias[c] + sum of weight[c][f] * feature[f]) / unit
+ */
+struct AnomalyModel {
+    int8_t weight[ANOMALY_CLASSES][ANOMALY_FEATURES];
+    int32_t bias[ANOMALY_CLASSES];
+    int32_t unit; // accumulator units per logit
+};
+
+// The trained table (anomaly_weights.h, only included by anomaly_model.cpp)
+extern const AnomalyModel anomalyModel;
+
+/**
+ * @brief Scores one device
+ * @param cls the most likely attack class, never ANOMALY_BENIGN
+ * @return logit of cls over ANOMALY_BENIGN in accumulator units, >= 0 when the
+ *         model prefers the attack
+ */
+int32_t anomalyScore(const AnomalyModel &model, const int16_t *features, uint8_t &cls);
+
+// Per-device feature state, updated by the engine for every frame
+
+#define ANOMALY_ARRIVAL_BUCKETS 8
+
+// Inter-arrival times in buckets of powers of 4 ms, counts halve when one saturates
+struct AnomalyArrivals {
+    uint8_t count[ANOMALY_ARRIVAL_BUCKETS];
+};
+
+/**
+ * @brief log2(v) in Q8, 0 for v <= 1
+ */
+inline int16_t anomalyLog2Q8(uint32_t v) {
+    // log2(1 + i/32) in Q8, the top 5 mantissa bits pick the entry
+    static const uint8_t mantissa[32] = {0,   11,  22,  33,  44,  54,  63,  73,  82,  92,  100,
+                                         109, 118, 126, 134, 142, 150, 157, 165, 172, 179, 186,
+                                         193, 200, 207, 213, 220, 226, 232, 238, 244, 250};
+    if (v <= 1) return 0;
+    const int e = 31 - __builtin_clz(v);
+    const uint32_t top = e >= 5 ? (v >> (e - 5)) & 31 : (v << (5 - e)) & 31;
+    return (int16_t)((e << 8) + mantissa[top]);
+}
+
+inline void anomalyArrivalsClear(AnomalyArrivals &a) {
+    for (int i = 0; i < ANOMALY_ARRIVAL_BUCKETS; i++) a.count[i] = 0;
+}
+
+inline void anomalyArrivalsAdd(AnomalyArrivals &a, uint32_t dtMs) {
+    uint32_t bucket = (31 - __builtin_clz(dtMs + 1)) >> 1; // 0-2 ms, 3-14 ms, 15-62 ms...
+    if (bucket >= ANOMALY_ARRIVAL_BUCKETS) bucket = ANOMALY_ARRIVAL_BUCKETS - 1;
+    if (a.count[bucket] == UINT8_MAX) {
+        for (int i = 0; i < ANOMALY_ARRIVAL_BUCKETS; i++) a.count[i] >>= 1;
+    }
+    a.count[bucket]++;
+}
+
+/**
+ * @brief Shannon entropy of the histogram in Q8 bits, 0 to 3 * 256
+ */
+inline int16_t anomalyArrivalEntropy(const AnomalyArrivals &a) {
+    uint32_t n = 0;
+    int32_t sum = 0; // sum of c * log2(c)
+    for (int i = 0; i < ANOMALY_ARRIVAL_BUCKETS; i++) {
+        n += a.count[i];
+        sum += a.count[i] * anomalyLog2Q8(a.count[i]);
+    }
+    if (n < 2) return 0;
+    const int32_t h = anomalyLog2Q8(n) - sum / (int32_t)n;
+    return h > 0 ? (int16_t)h : 0;
+}
+
+/**
+ * @brief Mean of the sequence numbers skipped between two frames, Q4, 1/8 per frame
+ * @note Retransmissions (same number) count as no gap
+ */
+inline void anomalySeqGapAdd(uint16_t &gapQ4, uint16_t lastSeq, uint16_t seq) {
+    uint32_t skipped = seq == lastSeq ? 0 : (seq - lastSeq - 1) & 0xFFF;
+    if (skipped > 255) skipped = 255;
+    gapQ4 = (uint16_t)((int32_t)gapQ4 + (((int32_t)(skipped << 4) - (int32_t)gapQ4) >> 3));
+}
+
+/**
+ * @brief Running RSSI mean (Q4 dBm, 0 until the first sample) and variance (Q4 dB^2)
+ * @note Frames without RSSI (rssi 0) are left out
+ */
+inline void anomalyRssiAdd(int16_t &meanQ4, uint16_t &varQ4, int8_t rssi) {
+    if (rssi == 0) return;
+    const int32_t x = rssi * 16;
+    if (meanQ4 == 0) {
+        meanQ4 = (int16_t)x;
+        return;
+    }
+    const int32_t d = x - meanQ4;
+    meanQ4 = (int16_t)(meanQ4 + d / 8);
+    int32_t var = varQ4 + ((d * d / 16 - varQ4) >> 3);
+    varQ4 = var > UINT16_MAX ? UINT16_MAX : (uint16_t)var;
+}
+
+/**
+ * @brief Rate feature from a Q16 rate (rate_estimator.h)
+ */
+inline int16_t anomalyRateFeature(uint32_t rateQ16) { return anomalyLog2Q8((rateQ16 >> 8) + 256) - (8 << 8); }
+
+/**
+ * @brief log2(1 + v) in Q8 of a Q4 value
+ */
+inline int16_t anomalyQ4Feature(uint32_t vQ4) { return anomalyLog2Q8(vQ4 + 16) - (4 << 8); }
+
+#endif
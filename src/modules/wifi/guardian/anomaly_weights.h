@@ -0,0 +1,24 @@
+// Generated by tools/guardian_train, do not edit
+// Trained on 41943 samples of:
+//   bench_seed1.pcap
+//   bench_seed2.pcap
+//   bench_seed3.pcap
+//   bench_seed4.pcap
+#ifndef __GUARDIAN_ANOMALY_WEIGHTS_H__
+#define __GUARDIAN_ANOMALY_WEIGHTS_H__
+
+#include "anomaly_model.h"
+
+// Features: beacon rate, probe rate, response rate, deauth rate, auth rate, ssid count, rssi var, seq gap, arrival entropy
+const AnomalyModel anomalyModel = {
+    {
+        {  10,  -48,   -1,  -97,    0,  -25,   -7,    1,  102}, // benign
+        {   2,   -3,   -1,   -8,    0,   53,   -1,    0,   16}, // beacon spam
+        {  -5,  -19,    0,  127,    0,  -11,    3,    0,   -2}, // deauth flood
+        {  -7,   70,    1,  -22,    0,  -17,    5,    0, -116}, // probe flood
+    },
+    {77456, -24152, -6818, -1789},
+    6707,
+};
+
+#endif
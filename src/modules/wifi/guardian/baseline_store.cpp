@@ -0,0 +1,46 @@
+#include "baseline_store.h"
+#include <Arduino.h>
+
+#define NETWORK_BASELINE_TMP NETWORK_BASELINE_FILE ".tmp"
+
+// A save was cut short: the temporary file is complete once the old baseline is gone
+static void recoverBaseline(FS &fs) {
+    if (!fs.exists(NETWORK_BASELINE_TMP)) return;
+    if (fs.exists(NETWORK_BASELINE_FILE)) fs.remove(NETWORK_BASELINE_TMP);
+    else fs.rename(NETWORK_BASELINE_TMP, NETWORK_BASELINE_FILE);
+}
+
+bool networkBaselineLoad(FS &fs, NetworkBaseline &baseline) {
+    baseline.clear();
+    recoverBaseline(fs);
+    if (!fs.exists(NETWORK_BASELINE_FILE)) return false;
+    File file = fs.open(NETWORK_BASELINE_FILE, FILE_READ);
+    if (!file) return false;
+
+    BaselineRecord rec;
+    uint32_t corrupt = 0;
+    while (file.read((uint8_t *)&rec, sizeof(rec)) == sizeof(rec)) {
+        if (!baseline.restore(rec)) corrupt++;
+    }
+    file.close();
+    if (corrupt) Serial.printf("[GUARDIAN] Baseline: %u records skipped\n", (unsigned)corrupt);
+    return true;
+}
+
+bool networkBaselineSave(FS &fs, const NetworkBaseline &baseline) {
+    File file = fs.open(NETWORK_BASELINE_TMP, FILE_WRITE);
+    if (!file) return false;
+    bool ok = true;
+    baseline.forEachRecord([&](const BaselineRecord &rec) {
+        if (ok && file.write((const uint8_t *)&rec, sizeof(rec)) != sizeof(rec)) ok = false;
+    });
+    file.close();
+    if (!ok) {
+        fs.remove(NETWORK_BASELINE_TMP);
+        return false;
+    }
+
+    // A failed rename leaves the complete .tmp for recoverBaseline()
+    fs.remove(NETWORK_BASELINE_FILE);
+    return fs.rename(NETWORK_BASELINE_TMP, NETWORK_BASELINE_FILE);
+}
@@ -0,0 +1,27 @@
+#ifndef __GUARDIAN_BASELINE_STORE_H__
+#define __GUARDIAN_BASELINE_STORE_H__
+
+#include "network_baseline.h"
+#include <FS.h>
+
+// Learned network baseline on flash, next to the detection profiles (SD card,
+// LittleFS without one): the BaselineRecords of network_baseline.h back to back,
+// ~11KB when full. A corrupt record fails its CRC and is skipped. Saving writes
+// a temporary file, removes the old one and renames it: a power loss keeps the
+// previous baseline, or the new one once the old was removed, which the next
+// load takes over.
+
+#define NETWORK_BASELINE_FILE "/bruce_baseline.bin"
+
+/**
+ * @brief Replaces the content of baseline with the stored one
+ * @return false if there is no readable baseline file, baseline is then empty
+ */
+bool networkBaselineLoad(FS &fs, NetworkBaseline &baseline);
+
+/**
+ * @brief Stores the learned APs of baseline
+ */
+bool networkBaselineSave(FS &fs, const NetworkBaseline &baseline);
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef __GUARDIAN_CAPTURE_RING_H__
+#define __GUARDIAN_CAPTURE_RING_H__
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Lock-free single-producer/single-consumer ring buffer
+ * @note The producer is the WiFi driver callback and the consumer is the
+ *       guardian drain task. No other thread may call reserve()/commit()
+ *       or pop() while they are running.
+ * @note Storage is supplied by the caller so it can live in PSRAM, and the
+ *       capacity must be a power of two.
+ */
+template <typename T> class SpscRing {
+public:
+    void attach(T *storage, uint32_t capacity) {
+        _items = storage;
+        _mask = capacity - 1;
+        reset();
+    }
+
+    void detach() {
+        _items = nullptr;
+        _mask = 0;
+    }
+
+    /**
+     * @brief Clears indexes and counters
+     * @note only call while producer and consumer are both stopped
+     */
+    void reset() {
+        _head.store(0, std::memory_order_relaxed);
+        _tail.store(0, std::memory_order_relaxed);
+        _enqueued.store(0, std::memory_order_relaxed);
+        _dropped.store(0, std::memory_order_relaxed);
+        _drained.store(0, std::memory_order_relaxed);
+        _highWater = 0;
+    }
+
+    /**
+     * @brief Producer side: returns a slot to fill in place, or nullptr when full
+     * @note a full ring counts the frame as dropped, the caller just returns
+     */
+    T *reserve() {
+        if (!_items) return nullptr;
+        const uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) > _mask) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &_items[head & _mask];
+    }
+
+    /**
+     * @brief Producer side: publishes the slot returned by reserve()
+     */
+    void commit() {
+        _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        _enqueued.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Consumer side: copies up to max items into out
+     * @return number of items copied
+     */
+    size_t pop(T *out, size_t max) {
+        if (!_items) return 0;
+        const uint32_t tail = _tail.load(std::memory_order_relaxed);
+        const uint32_t depth = _head.load(std::memory_order_acquire) - tail;
+        if (depth > _highWater) _highWater = depth;
+
+        size_t n = depth < max ? depth : max;
+        for (size_t i = 0; i < n; i++) out[i] = _items[(tail + i) & _mask];
+
+        _tail.store(tail + n, std::memory_order_release);
+        _drained.fetch_add(n, std::memory_order_relaxed);
+        return n;
+    }
+
+    uint32_t capacity() const { return _items ? _mask + 1 : 0; }
+    uint32_t depth() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+    uint32_t enqueued() const { return _enqueued.load(std::memory_order_relaxed); }
+    uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+    uint32_t drained() const { return _drained.load(std::memory_order_relaxed); }
+    uint32_t highWater() const { return _highWater; }
+
+private:
+    T *_items = nullptr;
+    uint32_t _mask = 0;
+    std::atomic<uint32_t> _head{0};
+    std::atomic<uint32_t> _tail{0};
+    std::atomic<uint32_t> _enqueued{0};
+    std::atomic<uint32_t> _dropped{0};
+    std::atomic<uint32_t> _drained{0};
+    uint32_t _highWater = 0; // written by the consumer only
+};
+
+#endif
@@ -0,0 +1,30 @@
+#include "deauth_detector.h"
+
+bool DeauthDetector::begin(size_t maxTargets) {
+    end();
+    _spoofed = 0;
+    return _targets.allocate(maxTargets);
+}
+
+void DeauthDetector::end() { _targets.release(); }
+
+bool DeauthDetector::observe(const GuardianFrame &frame, float threshold, DeauthFlood &flood) {
+    _spoofed++;
+    Target *t = _targets.insert(frame.addr1);
+    if (!t) return false;
+
+    const int32_t dt = frame.timestamp - t->lastSeen;
+    t->rate = t->frames ? rateEvent(t->rate, dt > 0 ? dt : 0) : RATE_EVENT_Q16;
+    t->lastSeen = frame.timestamp;
+    t->frames++;
+
+    const float rate = rateToFloat(t->rate);
+    if (t->reported || !(rate > threshold)) return false;
+    t->reported = true;
+
+    memcpy(flood.target, frame.addr1, 6);
+    memcpy(flood.spoofed, frame.addr2, 6);
+    flood.frames = t->frames;
+    flood.rate = rate;
+    return true;
+}
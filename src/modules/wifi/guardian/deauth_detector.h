@@ -0,0 +1,107 @@
+#ifndef __GUARDIAN_DEAUTH_DETECTOR_H__
+#define __GUARDIAN_DEAUTH_DETECTOR_H__
+
+#include "guardian_frame.h"
+#include "mac_table.h"
+#include "rate_estimator.h"
+
+// Spoofed deauthentication detector.
+// Deauth tools forge the AP's MAC but not its radio: the 12 bit sequence counter
+// an AP shares between all its management frames and the signal level its frames
+// arrive with. Every transmitter keeps a reference from its beacons and other
+// management frames, a deauth/disassoc claiming that MAC whose sequence number
+// jumps out of the counter's window, or whose RSSI is far from the AP's, is
+// classified as spoofed. Spoofed floods are charged to the station they target
+// instead of the AP whose MAC was forged.
+
+#define DEAUTH_SEQ_NONE 0xFFFF   // no reference sequence number yet
+#define DEAUTH_SEQ_WINDOW 256    // forward jump still accepted from the AP's own counter
+#define DEAUTH_RSSI_JUMP_DB 12   // signal difference that gives a second radio away
+#define DEAUTH_RSSI_SHIFT 3      // RSSI average weight of 1/8 per frame
+#ifndef DEAUTH_MAX_TARGETS
+#define DEAUTH_MAX_TARGETS 64    // stations spoofed floods are attributed to
+#endif
+
+/**
+ * @brief Sequence number and signal level of a transmitter's genuine frames
+ * @note POD: zeroed means no signal reference, seq must start at DEAUTH_SEQ_NONE.
+ */
+struct DeauthReference {
+    uint16_t seq;   // last sequence number, DEAUTH_SEQ_NONE if unknown
+    int16_t rssiQ4; // moving average in 1/16 dBm, 0 if unknown (pcap replays carry no RSSI)
+};
+
+inline void deauthReferenceReset(DeauthReference &ref) {
+    ref.seq = DEAUTH_SEQ_NONE;
+    ref.rssiQ4 = 0;
+}
+
+/**
+ * @brief Accounts a management frame that is not a deauth/disassoc
+ */
+inline void deauthReferenceUpdate(DeauthReference &ref, const GuardianFrame &frame) {
+    ref.seq = frame.seqCtrl >> 4;
+    if (frame.rssi == 0) return;
+    const int16_t rssi = frame.rssi * 16;
+    if (ref.rssiQ4 == 0) ref.rssiQ4 = rssi;
+    else ref.rssiQ4 += (rssi - ref.rssiQ4) >> DEAUTH_RSSI_SHIFT;
+}
+
+/**
+ * @brief Whether a deauth/disassoc cannot come from the radio behind ref
+ * @return false without a reference, the frame is then taken at face value
+ */
+inline bool deauthSpoofed(const DeauthReference &ref, const GuardianFrame &frame) {
+    if (ref.seq == DEAUTH_SEQ_NONE) return false;
+    const uint16_t ahead = ((frame.seqCtrl >> 4) - ref.seq) & 0xFFF; // 0 is a retransmission
+    if (ahead > DEAUTH_SEQ_WINDOW) return true;
+    if (ref.rssiQ4 == 0 || frame.rssi == 0) return false;
+    const int16_t diff = frame.rssi * 16 - ref.rssiQ4;
+    return diff > DEAUTH_RSSI_JUMP_DB * 16 || diff < -DEAUTH_RSSI_JUMP_DB * 16;
+}
+
+/**
+ * @brief A spoofed deauth flood against one station (broadcast for all of them)
+ */
+struct DeauthFlood {
+    uint8_t target[6];
+    uint8_t spoofed[6]; // MAC the frames claimed to come from
+    uint32_t frames;    // spoofed frames against target so far
+    float rate;         // per second
+};
+
+typedef void (*DeauthFloodHandler)(const DeauthFlood &flood);
+
+class DeauthDetector {
+public:
+    ~DeauthDetector() { end(); }
+
+    /**
+     * @return false if the allocation failed
+     */
+    bool begin(size_t maxTargets = DEAUTH_MAX_TARGETS);
+    void end();
+
+    /**
+     * @brief Charges a spoofed deauth/disassoc to its target station
+     * @param flood filled when the function returns true
+     * @return true once per target, when its spoofed rate exceeds threshold per second
+     */
+    bool observe(const GuardianFrame &frame, float threshold, DeauthFlood &flood);
+
+    uint32_t spoofed() const { return _spoofed; }
+    size_t targets() const { return _targets.size(); }
+
+private:
+    struct Target {
+        uint32_t rate; // Q16, see rate_estimator.h
+        uint32_t lastSeen;
+        uint32_t frames;
+        bool reported;
+    };
+
+    MacTable<Target> _targets;
+    uint32_t _spoofed = 0;
+};
+
+#endif
@@ -0,0 +1,136 @@
+#include "detection_profile.h"
+#include "threat_engine.h"
+#include <atomic>
+#include <string.h>
+
+// Keys after the rule names, in field order
+static const char *const extraKeys[] = {"spoofed deauth", "attack score", "stale ms", "shark stale ms", "anomaly model"};
+#define EXTRA_KEYS (sizeof(extraKeys) / sizeof(extraKeys[0]))
+
+struct ProfileOverride {
+    const char *key;
+    uint32_t value;
+};
+
+// "home" is the threshold defaults of threat_engine.h, the others start from it
+static const ProfileOverride officeOverrides[] = {
+    {"probe flood",    8 }, // laptops rescanning on every roam
+    {"multiple SSIDs", 3 }, // guest and corporate networks on one radio
+    {"burst",          90},
+};
+
+static const ProfileOverride stadiumOverrides[] = {
+    {"beacon spam",    25   },
+    {"probe flood",    12   },
+    {"deauth flood",   3    }, // APs shedding clients under load
+    {"multiple SSIDs", 4    },
+    {"burst",          150  },
+    {"spoofed deauth", 3    },
+    {"stale ms",       15000}, // crowds move, keep scoring the ones still here
+    {"anomaly model",  0    }, // the shipped weights are trained on synthetic captures, not on a real venue yet
+};
+
+struct BuiltinProfile {
+    const char *name;
+    const ProfileOverride *overrides;
+    size_t count;
+};
+
+static const BuiltinProfile builtins[] = {
+    {"home",    nullptr,          0                                                  },
+    {"office",  officeOverrides,  sizeof(officeOverrides) / sizeof(officeOverrides[0])},
+    {"stadium", stadiumOverrides, sizeof(stadiumOverrides) / sizeof(stadiumOverrides[0])},
+};
+
+static DetectionProfile slots[2];
+static std::atomic<const DetectionProfile *> active(nullptr);
+
+size_t detectionProfileBuiltinCount() { return sizeof(builtins) / sizeof(builtins[0]); }
+
+const char *detectionProfileBuiltinName(size_t i) { return i < detectionProfileBuiltinCount() ? builtins[i].name : ""; }
+
+static DetectionProfile homeProfile() {
+    DetectionProfile out;
+    memset(&out, 0, sizeof(out));
+    strcpy(out.name, "home");
+    for (size_t i = 0; i < threatRuleCount; i++) out.rule[i] = threatRules[i].threshold;
+    out.spoofedDeauth = DEAUTH_ATTACK_THRESHOLD;
+    out.attackScore = ATTACK_DETECTION_THRESHOLD;
+    out.staleMs = THREAT_STALE_MS;
+    out.sharkStaleMs = SHARK_STALE_MS;
+    out.anomalyModel = ANOMALY_MODEL_DEFAULT;
+    return out;
+}
+
+bool detectionProfileBuiltin(const char *name, DetectionProfile &out) {
+    out = homeProfile();
+    strncpy(out.name, name, DETECTION_PROFILE_NAME_LEN - 1);
+    out.name[DETECTION_PROFILE_NAME_LEN - 1] = '\0';
+    for (size_t i = 0; i < detectionProfileBuiltinCount(); i++) {
+        const BuiltinProfile &builtin = builtins[i];
+        if (strcmp(builtin.name, name) != 0) continue;
+        for (size_t o = 0; o < builtin.count; o++) {
+            detectionProfileSet(out, builtin.overrides[o].key, builtin.overrides[o].value);
+        }
+        return true;
+    }
+    return false;
+}
+
+const DetectionProfile &detectionProfile() {
+    const DetectionProfile *profile = active.load(std::memory_order_acquire);
+    if (profile) return *profile;
+    static const DetectionProfile home = homeProfile(); // threatRules is set up by then
+    return home;
+}
+
+void detectionProfileActivate(const DetectionProfile &profile) {
+    // The slot not in use is written, readers holding the active one are not disturbed
+    DetectionProfile *next = active.load(std::memory_order_relaxed) == &slots[0] ? &slots[1] : &slots[0];
+    *next = profile;
+    next->name[DETECTION_PROFILE_NAME_LEN - 1] = '\0';
+    active.store(next, std::memory_order_release);
+}
+
+size_t detectionProfileKeyCount() { return threatRuleCount + EXTRA_KEYS; }
+
+const char *detectionProfileKey(size_t key) {
+    if (key < threatRuleCount) return threatRules[key].name;
+    key -= threatRuleCount;
+    return key < EXTRA_KEYS ? extraKeys[key] : "";
+}
+
+uint32_t detectionProfileGet(const DetectionProfile &profile, size_t key) {
+    if (key < threatRuleCount) return profile.rule[key];
+    switch (key - threatRuleCount) {
+        case 0: return profile.spoofedDeauth;
+        case 1: return profile.attackScore;
+        case 2: return profile.staleMs;
+        case 3: return profile.sharkStaleMs;
+        case 4: return profile.anomalyModel;
+        default: return 0;
+    }
+}
+
+size_t detectionProfileFind(const char *name) {
+    size_t key = 0;
+    while (key < detectionProfileKeyCount() && strcmp(detectionProfileKey(key), name) != 0) key++;
+    return key;
+}
+
+bool detectionProfileSet(DetectionProfile &profile, const char *key, uint32_t value) {
+    const size_t i = detectionProfileFind(key);
+    const uint16_t small = value > UINT16_MAX ? UINT16_MAX : value;
+    if (i < threatRuleCount) {
+        profile.rule[i] = small;
+        return true;
+    }
+    switch (i - threatRuleCount) {
+        case 0: profile.spoofedDeauth = small; return true;
+        case 1: profile.attackScore = small; return true;
+        case 2: profile.staleMs = value; return true;
+        case 3: profile.sharkStaleMs = value; return true;
+        case 4: profile.anomalyModel = value ? 1 : 0; return true;
+        default: return false;
+    }
+}
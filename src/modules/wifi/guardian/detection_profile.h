@@ -0,0 +1,77 @@
+#ifndef __GUARDIAN_DETECTION_PROFILE_H__
+#define __GUARDIAN_DETECTION_PROFILE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Detection thresholds of the threat engine as one flat table of integers.
+// A profile tunes the engine for a kind of venue: a stadium is full of phones
+// probing and APs beaconing that would flood a home's thresholds. The analysis
+// pass loads the active profile pointer once and reads plain fields from it, so
+// activating another profile takes no lock and never mixes two in one pass.
+// Profiles are addressed by key: the rule names of threatRules, then the
+// thresholds checked outside the rule table (detectionProfileKey()).
+// Built-in profiles come from here, profile_store.h loads edited ones from flash.
+
+#define DETECTION_PROFILE_NAME_LEN 16
+#define DETECTION_RULE_SLOTS 8 // room for threatRules, checked in threat_engine.cpp
+
+struct DetectionProfile {
+    char name[DETECTION_PROFILE_NAME_LEN];
+    uint16_t rule[DETECTION_RULE_SLOTS]; // threatRules[i] fires when its feature > rule[i]
+    uint16_t spoofedDeauth;              // spoofed deauths/s against one station
+    uint16_t attackScore;                // risk score that confirms a device
+    uint32_t staleMs;                    // Guardian: devices silent for longer are not scored
+    uint32_t sharkStaleMs;               // Shark-Bait, which only cares about what is on air now
+    uint16_t anomalyModel;               // 1: the trained model (anomaly_model.h) scores rate attacks instead of rule[]
+};
+
+size_t detectionProfileBuiltinCount();
+const char *detectionProfileBuiltinName(size_t i);
+
+/**
+ * @brief Fills out with the built-in profile called name
+ * @return false if there is none, out then holds the "home" profile under that name
+ */
+bool detectionProfileBuiltin(const char *name, DetectionProfile &out);
+
+/**
+ * @brief The active profile, "home" until another one is activated
+ * @note Take the reference once per pass: it stays valid until the second
+ *       activation after it was taken.
+ */
+const DetectionProfile &detectionProfile();
+
+/**
+ * @brief Makes a copy of profile the active one
+ * @note One writer at a time, readers are never blocked
+ */
+void detectionProfileActivate(const DetectionProfile &profile);
+
+/**
+ * @brief Number of keys: every rule of threatRules, then the other thresholds
+ */
+size_t detectionProfileKeyCount();
+const char *detectionProfileKey(size_t key);
+
+/**
+ * @return index of the key called name, detectionProfileKeyCount() if there is none
+ */
+size_t detectionProfileFind(const char *name);
+
+uint32_t detectionProfileGet(const DetectionProfile &profile, size_t key);
+
+/**
+ * @brief Sets one threshold, values are clamped to what the field holds
+ * @return false for an unknown key name
+ */
+bool detectionProfileSet(DetectionProfile &profile, const char *key, uint32_t value);
+
+/**
+ * @brief Threshold of the active profile by key, for display
+ */
+inline uint32_t detectionThreshold(const char *key) {
+    return detectionProfileGet(detectionProfile(), detectionProfileFind(key));
+}
+
+#endif
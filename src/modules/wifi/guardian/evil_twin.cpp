@@ -0,0 +1,114 @@
+#include "evil_twin.h"
+#include "ssid_sketch.h"
+
+uint8_t beaconFingerprintDistance(const BeaconFingerprint &a, const BeaconFingerprint &b) {
+    uint8_t d = 0;
+    if (a.rsn != b.rsn) d += 3;
+    if (a.vendor != b.vendor) d += 2;
+    if (a.rates != b.rates) d += 1;
+    if (a.ht != b.ht) d += 1;
+    if (a.vht != b.vht) d += 1;
+    if (a.interval != b.interval) d += 1;
+    return d;
+}
+
+static uint16_t fingerprintHash(const BeaconFingerprint &fp, uint8_t channel) {
+    return guardianIeHash(&channel, 1, guardianIeHash((const uint8_t *)&fp, sizeof(fp)));
+}
+
+static bool sameFingerprint(const BeaconFingerprint &a, const BeaconFingerprint &b) {
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+bool EvilTwinDetector::begin(size_t maxBssids, size_t maxSsids) {
+    end();
+    return _bssids.allocate(maxBssids) && _ssids.allocate(maxSsids);
+}
+
+void EvilTwinDetector::end() {
+    _bssids.release();
+    _ssids.release();
+}
+
+EvilTwinVerdict EvilTwinDetector::observe(const GuardianFrame &frame, uint8_t *distance) {
+    // Probe responses often carry other vendor IEs (WPS, P2P) than beacons, only beacons compare
+    if ((frame.frameCtrl >> 4) != IEEE80211_SUBTYPE_BEACON) return EVIL_TWIN_NONE;
+    if (frame.ssidLen == 0) return EVIL_TWIN_NONE; // hidden networks all share the empty SSID
+
+    bool created;
+    Bssid *b = _bssids.insert(frame.addr3, &created);
+    if (!b) return EVIL_TWIN_NONE;
+
+    const uint32_t ssid = ssidHash(frame.ssid, frame.ssidLen);
+    if (created || b->ssid != ssid) { // new AP, or one that was renamed: start over
+        memset(b, 0, sizeof(*b));
+        b->ssid = ssid;
+        b->fingerprint = frame.fingerprint;
+        b->channel = frame.channel;
+        b->confirmations = 1;
+        b->lastSeen = frame.timestamp;
+        return EVIL_TWIN_NONE;
+    }
+
+    if (sameFingerprint(b->fingerprint, frame.fingerprint) && b->channel == frame.channel) {
+        b->lastSeen = frame.timestamp;
+        if (b->confirmations >= EVIL_TWIN_CONFIRM_BEACONS) return EVIL_TWIN_NONE;
+        if (++b->confirmations < EVIL_TWIN_CONFIRM_BEACONS) return EVIL_TWIN_NONE;
+        return establish(*b, distance);
+    }
+
+    // Another fingerprint: a one-off corrupted beacon, a reconfigured AP, or a second radio
+    const uint16_t alt = fingerprintHash(frame.fingerprint, frame.channel);
+    if (alt == b->alt) {
+        if (b->altConfirmations < 255) b->altConfirmations++;
+    } else {
+        b->alt = alt;
+        b->altConfirmations = 1;
+    }
+    if (b->altConfirmations < EVIL_TWIN_CONFIRM_BEACONS) return EVIL_TWIN_NONE;
+
+    // Both fingerprints trusted and on the air at the same time: two radios share the BSSID
+    const bool trusted = b->confirmations >= EVIL_TWIN_CONFIRM_BEACONS;
+    if (trusted && frame.timestamp - b->lastSeen < EVIL_TWIN_CLONE_WINDOW_MS) {
+        if (b->reported) return EVIL_TWIN_NONE;
+        b->reported = true;
+        return EVIL_TWIN_CLONED;
+    }
+
+    // The old fingerprint stopped or never settled: the AP was reconfigured or changed channel
+    b->fingerprint = frame.fingerprint;
+    b->channel = frame.channel;
+    b->confirmations = EVIL_TWIN_CONFIRM_BEACONS;
+    b->lastSeen = frame.timestamp;
+    b->alt = 0;
+    b->altConfirmations = 0;
+    return trusted ? EVIL_TWIN_NONE : establish(*b, distance);
+}
+
+// Compares a newly trusted fingerprint to its SSID's reference, then counts it in
+EvilTwinVerdict EvilTwinDetector::establish(Bssid &b, uint8_t *distance) {
+    Cluster *c = _ssids.insertKey(b.ssid);
+    if (!c) return EVIL_TWIN_NONE;
+
+    const int ref = c->members[0] >= c->members[1] ? 0 : 1;
+    const uint8_t d = c->members[ref] ? beaconFingerprintDistance(c->candidate[ref], b.fingerprint) : 0;
+
+    // Two counter frequent-items summary: the majority fingerprint of the SSID
+    // keeps its slot, a lone outlier only ever competes for the other one
+    int slot = -1;
+    for (int i = 0; i < 2; i++) {
+        if (c->members[i] && sameFingerprint(c->candidate[i], b.fingerprint)) slot = i;
+    }
+    if (slot < 0) {
+        slot = c->members[0] <= c->members[1] ? 0 : 1;
+        if (c->members[slot] > 0) c->members[slot]--;
+        if (c->members[slot] == 0) c->candidate[slot] = b.fingerprint;
+        else slot = -1;
+    }
+    if (slot >= 0 && c->members[slot] < UINT16_MAX) c->members[slot]++;
+
+    if (d < EVIL_TWIN_DIVERGENCE || b.reported) return EVIL_TWIN_NONE;
+    b.reported = true;
+    if (distance) *distance = d;
+    return EVIL_TWIN_DIVERGENT;
+}
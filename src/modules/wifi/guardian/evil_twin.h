@@ -0,0 +1,83 @@
+#ifndef __GUARDIAN_EVIL_TWIN_H__
+#define __GUARDIAN_EVIL_TWIN_H__
+
+#include "guardian_frame.h"
+#include "mac_table.h"
+
+// Streaming evil twin detector.
+// Every BSSID gets a fingerprint of what its beacons advertise (guardian_frame.h)
+// and BSSIDs are clustered by SSID. Mesh and enterprise APs of one network run
+// the same firmware and agree on everything but the channel, a rogue AP copying
+// the SSID rarely matches the RSN element, rates, capabilities and vendor IEs
+// all at once. A BSSID is only flagged when its fingerprint diverges from the one
+// established by the rest of its SSID, or when one BSSID beacons two fingerprints
+// (cloned BSSID). Runs per beacon in fixed memory.
+
+#ifndef EVIL_TWIN_MAX_BSSIDS
+#define EVIL_TWIN_MAX_BSSIDS 512 // APs fingerprinted, later ones are not checked
+#endif
+#ifndef EVIL_TWIN_MAX_SSIDS
+#define EVIL_TWIN_MAX_SSIDS 256 // distinct SSIDs clustered
+#endif
+#define EVIL_TWIN_CONFIRM_BEACONS 3   // identical beacons before a fingerprint is trusted
+#define EVIL_TWIN_DIVERGENCE 2        // weighted mismatch that flags a BSSID
+#define EVIL_TWIN_CLONE_WINDOW_MS 5000 // both fingerprints seen within it: cloned BSSID
+
+enum EvilTwinVerdict {
+    EVIL_TWIN_NONE,
+    EVIL_TWIN_DIVERGENT, // fingerprint differs from the SSID's established cluster
+    EVIL_TWIN_CLONED     // BSSID seen with two fingerprints or channels at once
+};
+
+/**
+ * @brief Weighted count of differing fingerprint elements
+ * @note RSN weighs most (security downgrade), then vendor IEs (different hardware).
+ */
+uint8_t beaconFingerprintDistance(const BeaconFingerprint &a, const BeaconFingerprint &b);
+
+class EvilTwinDetector {
+public:
+    ~EvilTwinDetector() { end(); }
+
+    /**
+     * @return false if the allocation failed
+     */
+    bool begin(size_t maxBssids = EVIL_TWIN_MAX_BSSIDS, size_t maxSsids = EVIL_TWIN_MAX_SSIDS);
+    void end();
+
+    /**
+     * @brief Accounts one beacon, other frames are ignored
+     * @param distance set to the fingerprint distance behind a DIVERGENT verdict
+     * @return a verdict once per BSSID and fingerprint, NONE for every other frame
+     */
+    EvilTwinVerdict observe(const GuardianFrame &frame, uint8_t *distance = nullptr);
+
+    size_t bssids() const { return _bssids.size(); }
+    size_t ssids() const { return _ssids.size(); }
+    uint32_t rejected() const { return _bssids.rejected() + _ssids.rejected(); } // APs not checked, tables full
+
+private:
+    struct Bssid {
+        uint32_t ssid; // ssidHash() of the SSID the fingerprint was built for
+        BeaconFingerprint fingerprint;
+        uint8_t channel;
+        uint8_t confirmations; // identical beacons, trusted from EVIL_TWIN_CONFIRM_BEACONS
+        uint8_t altConfirmations;
+        bool reported;
+        uint16_t alt; // hash of the other fingerprint of a BSSID that changed
+        uint32_t lastSeen; // last beacon matching fingerprint
+    };
+
+    // Two candidate fingerprints per SSID, the one with more BSSIDs is the reference
+    struct Cluster {
+        BeaconFingerprint candidate[2];
+        uint16_t members[2];
+    };
+
+    EvilTwinVerdict establish(Bssid &b, uint8_t *distance);
+
+    MacTable<Bssid> _bssids;
+    MacTable<Cluster> _ssids; // keyed by ssidHash()
+};
+
+#endif
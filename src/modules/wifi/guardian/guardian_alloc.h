@@ -0,0 +1,20 @@
+#ifndef __GUARDIAN_ALLOC_H__
+#define __GUARDIAN_ALLOC_H__
+
+#include <stdlib.h>
+#if defined(ARDUINO)
+#include <Arduino.h>
+#endif
+
+/**
+ * @brief Allocates Guardian tables, preferring PSRAM when the board has it
+ * @note plain malloc on host builds, release with free()
+ */
+inline void *guardianAlloc(size_t bytes) {
+#if defined(ARDUINO)
+    if (psramFound()) return ps_malloc(bytes);
+#endif
+    return malloc(bytes);
+}
+
+#endif
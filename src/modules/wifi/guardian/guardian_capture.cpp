@@ -0,0 +1,120 @@
+#include "guardian_capture.h"
+#include "guardian_alloc.h"
+#include "guardian_stats.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static SpscRing<GuardianFrame> captureRing;
+static GuardianFrame *ringStorage = nullptr;
+
+static GuardianBatchHandler batchHandler = nullptr;
+static GuardianTickHandler tickHandler = nullptr;
+static uint32_t tickInterval = 0;
+
+static volatile bool drainRunning = false;
+static TaskHandle_t drainTaskHandle = nullptr;
+static volatile uint32_t drainWakeups = 0; // written by the producer only
+static volatile bool drainNotified = false; // set by the producer, cleared by the drain task before it pops
+
+void IRAM_ATTR guardianCapturePush(const wifi_promiscuous_pkt_t *pkt) {
+    const uint16_t len = pkt->rx_ctrl.sig_len;
+    if (len <= IEEE80211_FCS_LEN) return;
+    GUARDIAN_STAT_SCOPE(GUARDIAN_PROBE_CAPTURE);
+    if (!guardianCaptureFrame(captureRing, pkt->payload, len - IEEE80211_FCS_LEN, pkt->rx_ctrl.rssi,
+                              pkt->rx_ctrl.channel, millis())) {
+        return;
+    }
+    // Once per batch rather than per frame: a notification costs more than the copy.
+    // The drain task pops concurrently, so depth may step over the batch size.
+    TaskHandle_t drain = drainTaskHandle;
+    if (drain && !drainNotified && captureRing.depth() >= GUARDIAN_DRAIN_BATCH) {
+        drainNotified = true;
+        drainWakeups = drainWakeups + 1;
+        xTaskNotifyGive(drain);
+    }
+}
+
+static void guardianDrainTask(void *pvParameters) {
+    GuardianFrame batch[GUARDIAN_DRAIN_BATCH];
+    uint32_t lastTick = micros();
+
+    while (drainRunning) {
+        drainNotified = false; // frames arriving from here on may wake the task again
+        size_t n;
+        while ((n = captureRing.pop(batch, GUARDIAN_DRAIN_BATCH)) > 0) {
+            if (batchHandler) {
+                GUARDIAN_STAT_SCOPE(GUARDIAN_PROBE_APPLY);
+                batchHandler(batch, n);
+            }
+            if (n < GUARDIAN_DRAIN_BATCH) break;
+        }
+
+        const uint32_t sinceTick = micros() - lastTick;
+        if (tickHandler && sinceTick >= tickInterval * 1000) {
+            GUARDIAN_STAT_RECORD(GUARDIAN_PROBE_TICK_LATE, sinceTick - tickInterval * 1000);
+            {
+                GUARDIAN_STAT_SCOPE(GUARDIAN_PROBE_ANALYZE);
+                tickHandler();
+            }
+            lastTick = micros();
+        }
+
+        // A backlog left by a flood is drained on the next tick, the idle task must still run
+        if (captureRing.depth() >= GUARDIAN_DRAIN_BATCH) vTaskDelay(1);
+        else ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(GUARDIAN_DRAIN_INTERVAL_MS));
+    }
+
+    drainTaskHandle = nullptr;
+    vTaskDelete(NULL);
+}
+
+bool guardianCaptureBegin(GuardianBatchHandler onBatch, GuardianTickHandler onTick, uint32_t tickIntervalMs) {
+    guardianCaptureEnd();
+
+    const size_t bytes = GUARDIAN_RING_SIZE * sizeof(GuardianFrame);
+    ringStorage = (GuardianFrame *)guardianAlloc(bytes);
+    if (!ringStorage) {
+        Serial.println("[GUARDIAN] Failed to allocate capture ring");
+        return false;
+    }
+    captureRing.attach(ringStorage, GUARDIAN_RING_SIZE);
+
+    batchHandler = onBatch;
+    tickHandler = onTick;
+    tickInterval = tickIntervalMs;
+    drainRunning = true;
+    drainWakeups = 0;
+    drainNotified = false;
+
+    if (xTaskCreatePinnedToCore(guardianDrainTask, "GuardianDrain", 6144, NULL, 1, &drainTaskHandle,
+                                GUARDIAN_ANALYSIS_CORE) != pdPASS) {
+        Serial.println("[GUARDIAN] Failed to start drain task");
+        drainRunning = false;
+        drainTaskHandle = nullptr;
+        guardianCaptureEnd();
+        return false;
+    }
+    return true;
+}
+
+void guardianCaptureEnd() {
+    drainRunning = false;
+    while (drainTaskHandle != nullptr) vTaskDelay(pdMS_TO_TICKS(GUARDIAN_DRAIN_INTERVAL_MS));
+
+    captureRing.detach();
+    if (ringStorage) {
+        free(ringStorage);
+        ringStorage = nullptr;
+    }
+}
+
+GuardianCaptureStats guardianCaptureStats() {
+    GuardianCaptureStats stats;
+    stats.enqueued = captureRing.enqueued();
+    stats.dropped = captureRing.dropped();
+    stats.drained = captureRing.drained();
+    stats.highWater = captureRing.highWater();
+    stats.capacity = captureRing.capacity();
+    stats.wakeups = drainWakeups;
+    return stats;
+}
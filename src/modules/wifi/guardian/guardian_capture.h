@@ -0,0 +1,57 @@
+#ifndef __GUARDIAN_CAPTURE_H__
+#define __GUARDIAN_CAPTURE_H__
+
+#include "capture_ring.h"
+#include "guardian_frame.h"
+#include <Arduino.h>
+#include <esp_wifi_types.h>
+
+// Capture stage of the Guardian monitor.
+// The promiscuous callback only copies header fields into a lock-free ring,
+// a dedicated task drains it in batches and hands them to the detector.
+// The drain task is the analysis stage: it is pinned to the core the Arduino
+// loop (the UI) does not run on, and the callback wakes it as soon as a full
+// batch is waiting, so a burst is analyzed at the pace it arrives.
+
+#define GUARDIAN_RING_SIZE 512       // frames, must be a power of two
+#define GUARDIAN_DRAIN_BATCH 32      // frames handed to the detector per call
+#define GUARDIAN_DRAIN_INTERVAL_MS 10 // longest wait of the drain task for a batch
+
+#if portNUM_PROCESSORS > 1 && defined(CONFIG_ARDUINO_RUNNING_CORE)
+#define GUARDIAN_ANALYSIS_CORE (CONFIG_ARDUINO_RUNNING_CORE ? 0 : 1)
+#else
+#define GUARDIAN_ANALYSIS_CORE tskNO_AFFINITY
+#endif
+
+struct GuardianCaptureStats {
+    uint32_t enqueued;
+    uint32_t dropped;
+    uint32_t drained;
+    uint32_t highWater; // deepest backlog seen by the drain task
+    uint32_t capacity;
+    uint32_t wakeups;   // drain task woken early by a full batch
+};
+
+/**
+ * @brief Allocates the ring and starts the drain task
+ * @param onBatch called from the drain task with every batch of frames
+ * @param onTick called from the drain task every tickIntervalMs (may be nullptr)
+ * @note onBatch and onTick run on the same task, so they never race each other
+ * @return false if the ring or task could not be allocated
+ */
+bool guardianCaptureBegin(GuardianBatchHandler onBatch, GuardianTickHandler onTick, uint32_t tickIntervalMs);
+
+/**
+ * @brief Stops the drain task and frees the ring
+ * @note promiscuous mode must be disabled before calling it
+ */
+void guardianCaptureEnd();
+
+/**
+ * @brief Producer side, to be called from the promiscuous rx callback
+ */
+void IRAM_ATTR guardianCapturePush(const wifi_promiscuous_pkt_t *pkt);
+
+GuardianCaptureStats guardianCaptureStats();
+
+#endif
@@ -0,0 +1,40 @@
+#include "guardian_clock.h"
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+static volatile bool clockVirtual = false;
+static volatile uint32_t clockNow = 0;
+
+uint32_t guardianWallMillis() {
+#if defined(ARDUINO)
+    return millis();
+#else
+    using namespace std::chrono;
+    static const steady_clock::time_point epoch = steady_clock::now();
+    return (uint32_t)duration_cast<milliseconds>(steady_clock::now() - epoch).count();
+#endif
+}
+
+void guardianSleepMs(uint32_t ms) {
+#if defined(ARDUINO)
+    delay(ms);
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+#endif
+}
+
+uint32_t guardianMillis() { return clockVirtual ? clockNow : guardianWallMillis(); }
+
+void guardianClockSet(uint32_t ms) {
+    clockNow = ms;
+    clockVirtual = true;
+}
+
+void guardianClockRelease() { clockVirtual = false; }
+
+bool guardianClockIsVirtual() { return clockVirtual; }
@@ -0,0 +1,34 @@
+#ifndef __GUARDIAN_CLOCK_H__
+#define __GUARDIAN_CLOCK_H__
+
+#include <stdint.h>
+
+// Time source of the Guardian detectors.
+// Live capture runs on millis(), a pcap replay switches the detectors to the
+// capture's own timeline so recorded incidents reproduce deterministically.
+
+/**
+ * @brief Detector time in ms: replay time while a replay runs, millis() otherwise
+ */
+uint32_t guardianMillis();
+
+/**
+ * @brief Switches to virtual time and sets it
+ */
+void guardianClockSet(uint32_t ms);
+
+/**
+ * @brief Returns to millis()
+ */
+void guardianClockRelease();
+
+bool guardianClockIsVirtual();
+
+/**
+ * @brief Wall clock in ms, unaffected by guardianClockSet()
+ */
+uint32_t guardianWallMillis();
+
+void guardianSleepMs(uint32_t ms);
+
+#endif
@@ -0,0 +1,243 @@
+#ifndef __GUARDIAN_FRAME_H__
+#define __GUARDIAN_FRAME_H__
+
+#include "ieee80211.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Frame record consumed by the Guardian detectors.
+// Filled either by the live promiscuous capture or by the pcap replay source,
+// header-only so the detector input can be produced on a Linux host as well.
+
+/**
+ * @brief What an AP advertises about itself in beacons and probe responses
+ * @note Each element is reduced to a 16 bit hash, 0 when the AP does not send it.
+ *       Vendor IEs only contribute their OUI and type, their payload (WPS state,
+ *       vendor counters) changes between beacons.
+ */
+struct BeaconFingerprint {
+    uint16_t rsn;      // whole RSN element: version, ciphers, AKMs, capabilities
+    uint16_t rates;    // supported + extended rates
+    uint16_t ht;       // HT capabilities
+    uint16_t vht;      // VHT capabilities
+    uint16_t vendor;   // vendor OUI:type set, order independent
+    uint16_t interval; // beacon interval in TUs
+};
+
+// Compact pre-parsed management frame
+struct GuardianFrame {
+    uint32_t timestamp; // guardianMillis() when the frame was received
+    uint8_t addr1[6];   // receiver
+    uint8_t addr2[6];   // transmitter/source
+    uint8_t addr3[6];   // BSSID
+    uint16_t seqCtrl;
+    uint8_t frameCtrl; // first frame control byte (type/subtype)
+    int8_t rssi;
+    uint8_t channel;   // DS parameter set when advertised, receive channel otherwise
+    uint8_t flags;     // GUARDIAN_FRAME_* bits
+    uint16_t security; // GUARDIAN_SEC_* bits, beacons and probe responses, 0 otherwise
+    uint8_t ssidLen;   // beacons, probe requests and responses, 0 otherwise
+    char ssid[32];
+    BeaconFingerprint fingerprint; // beacons and probe responses, zeroed otherwise
+    uint32_t probeFingerprint;     // probe requests, see guardianProbeHash(), 0 otherwise
+};
+
+#define GUARDIAN_FRAME_RSN 0x01    // frame carries an RSN element
+#define GUARDIAN_FRAME_VENDOR 0x02 // frame carries vendor specific elements
+
+// Security an AP advertises, GuardianFrame::security
+#define GUARDIAN_SEC_PRIVACY 0x0001 // capability privacy bit: WEP or better
+#define GUARDIAN_SEC_WPA 0x0002     // WPA vendor element (pre-RSN)
+#define GUARDIAN_SEC_RSN 0x0004     // RSN element (WPA2/WPA3)
+#define GUARDIAN_SEC_CCMP 0x0008    // CCMP or GCMP pairwise cipher
+#define GUARDIAN_SEC_TKIP 0x0010    // TKIP pairwise or group cipher
+#define GUARDIAN_SEC_PSK 0x0020     // pre-shared key AKM
+#define GUARDIAN_SEC_SAE 0x0040     // SAE AKM (WPA3 personal)
+#define GUARDIAN_SEC_8021X 0x0080   // 802.1X AKM (enterprise)
+#define GUARDIAN_SEC_MFP 0x0100     // management frame protection required
+
+// Losing a strong bit or gaining a weak one weakens a network
+#define GUARDIAN_SEC_STRONG                                                                                 \
+    (GUARDIAN_SEC_PRIVACY | GUARDIAN_SEC_RSN | GUARDIAN_SEC_CCMP | GUARDIAN_SEC_SAE | GUARDIAN_SEC_8021X | \
+     GUARDIAN_SEC_MFP)
+#define GUARDIAN_SEC_WEAK (GUARDIAN_SEC_WPA | GUARDIAN_SEC_TKIP | GUARDIAN_SEC_PSK)
+
+typedef void (*GuardianBatchHandler)(const GuardianFrame *frames, size_t count);
+typedef void (*GuardianTickHandler)();
+
+/**
+ * @brief 16 bit FNV-1a of an element body, folded, never 0 so presence always shows
+ */
+inline uint16_t guardianIeHash(const uint8_t *data, uint8_t len, uint32_t h = 2166136261u) {
+    for (uint8_t i = 0; i < len; i++) {
+        h ^= data[i];
+        h *= 16777619u;
+    }
+    const uint16_t folded = (h >> 16) ^ (h & 0xFFFF);
+    return folded ? folded : 1;
+}
+
+/**
+ * @brief GUARDIAN_SEC_* bits an AP loses or gains between two security sets that weaken it:
+ *        WPA2 to open or WPA, WPA3 to transition mode, enterprise to PSK, TKIP or no MFP
+ * @return 0 when now is as strong as was
+ */
+inline uint16_t guardianSecurityWeakened(uint16_t was, uint16_t now) {
+    return (was & ~now & GUARDIAN_SEC_STRONG) | (now & ~was & GUARDIAN_SEC_WEAK);
+}
+
+/**
+ * @brief GUARDIAN_SEC_* bits of a parsed RSN element
+ */
+inline uint16_t guardianRsnSecurity(const Ieee80211Rsn &rsn) {
+    uint16_t sec = GUARDIAN_SEC_RSN;
+    if (rsn.groupCipher == Ieee80211Rsn::CIPHER_TKIP) sec |= GUARDIAN_SEC_TKIP;
+    for (uint8_t i = 0; i < rsn.pairwiseCount && i < 4; i++) {
+        switch (rsn.pairwise[i]) {
+            case Ieee80211Rsn::CIPHER_TKIP: sec |= GUARDIAN_SEC_TKIP; break;
+            case Ieee80211Rsn::CIPHER_CCMP:
+            case Ieee80211Rsn::CIPHER_GCMP:
+            case Ieee80211Rsn::CIPHER_GCMP256:
+            case Ieee80211Rsn::CIPHER_CCMP256: sec |= GUARDIAN_SEC_CCMP; break;
+        }
+    }
+    for (uint8_t i = 0; i < rsn.akmCount && i < 4; i++) {
+        switch (rsn.akm[i]) {
+            case Ieee80211Rsn::AKM_8021X:
+            case Ieee80211Rsn::AKM_FT_8021X:
+            case Ieee80211Rsn::AKM_8021X_SHA256: sec |= GUARDIAN_SEC_8021X; break;
+            case Ieee80211Rsn::AKM_PSK:
+            case Ieee80211Rsn::AKM_FT_PSK:
+            case Ieee80211Rsn::AKM_PSK_SHA256: sec |= GUARDIAN_SEC_PSK; break;
+            case Ieee80211Rsn::AKM_SAE:
+            case Ieee80211Rsn::AKM_FT_SAE:
+            case Ieee80211Rsn::AKM_SAE_EXT: sec |= GUARDIAN_SEC_SAE; break;
+        }
+    }
+    if (rsn.capabilities & Ieee80211Rsn::CAP_MFP_REQUIRED) sec |= GUARDIAN_SEC_MFP;
+    return sec;
+}
+
+/**
+ * @brief Adds one element of a probe request to its device fingerprint
+ * @note Only what a client sends the same way in every probe, whatever its MAC:
+ *       the element order, and the bodies of rates, HT/VHT and extended
+ *       capabilities; vendor elements by OUI and type. The SSID and channel
+ *       change from probe to probe and are left out.
+ */
+inline uint32_t guardianProbeHash(uint32_t h, const Ieee80211Ie &ie) {
+    h = (h ^ ie.id) * 16777619u;
+    uint8_t len = 0;
+    switch (ie.id) {
+        case IEEE80211_IE_SSID:
+        case IEEE80211_IE_DS_PARAMS: return h;
+        case IEEE80211_IE_RATES:
+        case IEEE80211_IE_EXT_RATES:
+        case IEEE80211_IE_HT_CAPS:
+        case IEEE80211_IE_EXT_CAPS:
+        case IEEE80211_IE_VHT_CAPS: len = ie.len; break;
+        case IEEE80211_IE_VENDOR: len = ie.len < 4 ? ie.len : 4; break;
+    }
+    for (uint8_t i = 0; i < len; i++) h = (h ^ ie.data[i]) * 16777619u;
+    return h;
+}
+
+/**
+ * @brief Copies the fields used by the detectors out of a parsed management frame
+ * @param rssi receive strength, 0 when unknown (pcap replay)
+ * @param channel receive channel, replaced by the DS parameter set when present
+ */
+inline void guardianFillFrame(
+    GuardianFrame *frame, const Ieee80211Frame &dot11, int8_t rssi, uint8_t channel, uint32_t timestamp
+) {
+    frame->timestamp = timestamp;
+    frame->frameCtrl = dot11.frameControl() & 0xFF;
+    memcpy(frame->addr1, dot11.addr1(), 6);
+    memcpy(frame->addr2, dot11.addr2(), 6);
+    memcpy(frame->addr3, dot11.addr3(), 6);
+    frame->seqCtrl = dot11.seqCtrl();
+    frame->rssi = rssi;
+    frame->channel = channel;
+    frame->flags = 0;
+    frame->security = 0;
+    frame->ssidLen = 0;
+    memset(&frame->fingerprint, 0, sizeof(frame->fingerprint));
+    const bool advertises = dot11.isBeacon() || dot11.isProbeResp();
+    if (advertises) {
+        frame->fingerprint.interval = dot11.beaconInterval();
+        if (dot11.capabilityInfo() & IEEE80211_CAP_PRIVACY) frame->security = GUARDIAN_SEC_PRIVACY;
+    }
+    const bool probes = dot11.isProbeReq();
+    uint32_t probeHash = 2166136261u;
+
+    Ieee80211IeIterator it = dot11.ies();
+    Ieee80211Ie ie;
+    while (it.next(ie)) {
+        if (probes) probeHash = guardianProbeHash(probeHash, ie);
+        if (advertises) {
+            BeaconFingerprint &fp = frame->fingerprint;
+            switch (ie.id) {
+                case IEEE80211_IE_RSN: fp.rsn = guardianIeHash(ie.data, ie.len); break;
+                case IEEE80211_IE_RATES:
+                case IEEE80211_IE_EXT_RATES: // extended rates continue the hash of the basic ones
+                    fp.rates = guardianIeHash(ie.data, ie.len, fp.rates ? fp.rates : 2166136261u);
+                    break;
+                case IEEE80211_IE_HT_CAPS: fp.ht = guardianIeHash(ie.data, ie.len); break;
+                case IEEE80211_IE_VHT_CAPS: fp.vht = guardianIeHash(ie.data, ie.len); break;
+                case IEEE80211_IE_VENDOR:
+                    fp.vendor += guardianIeHash(ie.data, ie.len < 4 ? ie.len : 4);
+                    if (ie.len >= 4 && memcmp(ie.data, IEEE80211_WPA_OUI_TYPE, 4) == 0) {
+                        frame->security |= GUARDIAN_SEC_WPA;
+                    }
+                    break;
+            }
+        }
+
+        switch (ie.id) {
+            case IEEE80211_IE_SSID:
+                if (ie.len <= sizeof(frame->ssid) && frame->ssidLen == 0) {
+                    frame->ssidLen = ie.len;
+                    memcpy(frame->ssid, ie.data, ie.len);
+                }
+                break;
+            case IEEE80211_IE_DS_PARAMS:
+                if (ie.dsChannel()) frame->channel = ie.dsChannel();
+                break;
+            case IEEE80211_IE_RSN: {
+                Ieee80211Rsn rsn;
+                if (rsn.parse(ie)) {
+                    frame->flags |= GUARDIAN_FRAME_RSN;
+                    if (advertises) frame->security |= guardianRsnSecurity(rsn);
+                }
+                break;
+            }
+            case IEEE80211_IE_VENDOR: frame->flags |= GUARDIAN_FRAME_VENDOR; break;
+        }
+    }
+    frame->probeFingerprint = probes ? (probeHash ? probeHash : 1) : 0;
+}
+
+/**
+ * @brief Capture hot path: queues a raw frame into ring when it is a management frame
+ * @note Shared by the promiscuous callback and the host benchmark (tools/guardian_bench),
+ *       Ring is an SpscRing<GuardianFrame> (capture_ring.h).
+ * @param len frame length without FCS
+ * @return false if the frame was skipped or the ring is full
+ */
+template <typename Ring>
+inline bool guardianCaptureFrame(
+    Ring &ring, const uint8_t *payload, size_t len, int8_t rssi, uint8_t channel, uint32_t timestamp
+) {
+    Ieee80211Frame dot11;
+    if (!dot11.parse(payload, len) || !dot11.isMgmt()) return false;
+
+    GuardianFrame *frame = ring.reserve();
+    if (!frame) return false; // ring full, counted as dropped
+
+    guardianFillFrame(frame, dot11, rssi, channel, timestamp);
+    ring.commit();
+    return true;
+}
+
+#endif
@@ -0,0 +1,42 @@
+#include "guardian_stats.h"
+#include <string.h>
+
+#if GUARDIAN_STATS
+GuardianHistogram guardianHistograms[GUARDIAN_PROBE_COUNT];
+
+void guardianStatsReset() { memset(guardianHistograms, 0, sizeof(guardianHistograms)); }
+#endif
+
+const char *guardianProbeName(GuardianProbe probe) {
+    switch (probe) {
+        case GUARDIAN_PROBE_CAPTURE: return "capture";
+        case GUARDIAN_PROBE_APPLY: return "apply";
+        case GUARDIAN_PROBE_ANALYZE: return "analyze";
+        case GUARDIAN_PROBE_TICK_LATE: return "tickLate";
+        case GUARDIAN_PROBE_DISPLAY: return "display";
+        case GUARDIAN_PROBE_JOURNAL: return "journal";
+        default: return "unknown";
+    }
+}
+
+const char *guardianProbeUnit(GuardianProbe probe) {
+    if (probe == GUARDIAN_PROBE_TICK_LATE) return "us";
+#if defined(ARDUINO)
+    return "cycles";
+#else
+    return "ns";
+#endif
+}
+
+uint32_t guardianHistogramQuantile(const GuardianHistogram &h, float q) {
+    if (h.count == 0) return 0;
+    const uint32_t rank = (uint32_t)(q * (h.count - 1)) + 1;
+    uint32_t seen = 0;
+    for (int i = 0; i < GUARDIAN_HISTOGRAM_BUCKETS; i++) {
+        seen += h.buckets[i];
+        if (seen < rank) continue;
+        const uint32_t bound = i == 31 ? UINT32_MAX : ((uint32_t)2 << i) - 1;
+        return bound < h.max ? bound : h.max;
+    }
+    return h.max;
+}
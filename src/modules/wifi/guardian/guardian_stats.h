@@ -0,0 +1,110 @@
+#ifndef __GUARDIAN_STATS_H__
+#define __GUARDIAN_STATS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#if defined(ARDUINO)
+#include <hal/cpu_hal.h>
+#else
+#include <chrono>
+#endif
+
+// Latency histograms of the Guardian hot paths.
+// Each probe has a single writer (the task or callback it measures), so recording
+// is a cycle counter read and three plain increments: no locks, no atomics.
+// Values land in log2 buckets, bucket i holds [2^i, 2^(i+1)). Readers may see a
+// sample half recorded, which is fine for statistics.
+// Built with GUARDIAN_STATS 0, GUARDIAN_STAT_SCOPE() and GUARDIAN_STAT_RECORD()
+// compile to nothing and the histograms do not exist.
+
+#ifndef GUARDIAN_STATS
+#if defined(LITE_VERSION)
+#define GUARDIAN_STATS 0
+#else
+#define GUARDIAN_STATS 1
+#endif
+#endif
+
+#define GUARDIAN_HISTOGRAM_BUCKETS 32
+
+enum GuardianProbe {
+    GUARDIAN_PROBE_CAPTURE,   // promiscuous callback, per frame (cycles)
+    GUARDIAN_PROBE_APPLY,     // detector apply, per batch (cycles)
+    GUARDIAN_PROBE_ANALYZE,   // analysis pass over the tracked devices (cycles)
+    GUARDIAN_PROBE_TICK_LATE, // analysis pass started late by (us)
+    GUARDIAN_PROBE_DISPLAY,   // monitor screen refresh (cycles)
+    GUARDIAN_PROBE_JOURNAL,   // journal batch written to flash (cycles)
+    GUARDIAN_PROBE_COUNT
+};
+
+struct GuardianHistogram {
+    uint32_t buckets[GUARDIAN_HISTOGRAM_BUCKETS];
+    uint32_t count;
+    uint32_t max;
+    uint64_t total;
+};
+
+const char *guardianProbeName(GuardianProbe probe);
+const char *guardianProbeUnit(GuardianProbe probe);
+
+/**
+ * @brief Upper bound of the bucket holding quantile q (0..1) of the samples
+ */
+uint32_t guardianHistogramQuantile(const GuardianHistogram &h, float q);
+
+#if GUARDIAN_STATS
+
+extern GuardianHistogram guardianHistograms[GUARDIAN_PROBE_COUNT];
+
+/**
+ * @brief CPU cycles on the ESP32, nanoseconds on a host
+ */
+__attribute__((always_inline)) inline uint32_t guardianCycles() {
+#if defined(ARDUINO)
+    return cpu_hal_get_cycle_count();
+#else
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+__attribute__((always_inline)) inline void guardianStatRecord(GuardianProbe probe, uint32_t value) {
+    GuardianHistogram &h = guardianHistograms[probe];
+    h.buckets[31 - __builtin_clz(value | 1)]++;
+    h.count++;
+    h.total += value;
+    if (value > h.max) h.max = value;
+}
+
+// Records the cycles spent in the enclosing scope
+class GuardianStatScope {
+public:
+    __attribute__((always_inline)) explicit GuardianStatScope(GuardianProbe probe)
+        : _probe(probe), _start(guardianCycles()) {}
+    __attribute__((always_inline)) ~GuardianStatScope() { guardianStatRecord(_probe, guardianCycles() - _start); }
+
+private:
+    GuardianProbe _probe;
+    uint32_t _start;
+};
+
+/**
+ * @brief Clears every histogram, samples recorded meanwhile may be lost
+ */
+void guardianStatsReset();
+
+#define GUARDIAN_STAT_SCOPE(probe) GuardianStatScope guardianStatScope(probe)
+#define GUARDIAN_STAT_RECORD(probe, value) guardianStatRecord(probe, value)
+
+#else
+
+#define GUARDIAN_STAT_SCOPE(probe) \
+    do {                           \
+    } while (0)
+#define GUARDIAN_STAT_RECORD(probe, value) \
+    do {                                   \
+    } while (0)
+
+#endif
+
+#endif
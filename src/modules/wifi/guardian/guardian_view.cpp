@@ -0,0 +1,37 @@
+#include "guardian_view.h"
+#include <string.h>
+
+void guardianBuildView(const ThreatEngine &engine, uint32_t now, GuardianView &view) {
+    view.builtAt = now;
+    view.tracked = engine.size();
+    view.recent = 0;
+    memset(view.attacks, 0, sizeof(view.attacks));
+    view.count = 0;
+
+    // Insertion into a sorted array of six rows, the engine table is walked once
+    for (size_t row = 0; row < engine.size(); row++) {
+        const ThreatDevice device = engine.device(row);
+        if (device.isMarkedMalicious && device.suspectedThreat <= THREAT_UNKNOWN &&
+            view.attacks[device.suspectedThreat] < UINT16_MAX) {
+            view.attacks[device.suspectedThreat]++;
+        }
+        if (now - device.lastSeen > GUARDIAN_VIEW_RECENT_MS) continue;
+        view.recent++;
+        size_t at = view.count;
+        while (at > 0 && view.devices[at - 1].riskScore < device.riskScore) at--;
+        if (at >= GUARDIAN_VIEW_DEVICES) continue;
+
+        const size_t last = view.count < GUARDIAN_VIEW_DEVICES ? view.count : GUARDIAN_VIEW_DEVICES - 1;
+        memmove(&view.devices[at + 1], &view.devices[at], (last - at) * sizeof(GuardianViewDevice));
+        if (view.count < GUARDIAN_VIEW_DEVICES) view.count++;
+
+        GuardianViewDevice &entry = view.devices[at];
+        memcpy(entry.mac, device.mac, 6);
+        entry.threat = device.suspectedThreat;
+        entry.malicious = device.isMarkedMalicious;
+        entry.riskScore = device.riskScore;
+        entry.beaconRate = device.beaconRate;
+        entry.probeRate = device.probeRate;
+        entry.ssidCount = device.ssidCount < UINT16_MAX ? device.ssidCount : UINT16_MAX;
+    }
+}
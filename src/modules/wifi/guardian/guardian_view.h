@@ -0,0 +1,48 @@
+#ifndef __GUARDIAN_VIEW_H__
+#define __GUARDIAN_VIEW_H__
+
+#include "threat_engine.h"
+
+// What the Guardian and Shark-Bait monitor screens show, built by the analysis
+// task after every pass and handed to the render loop through a one-slot mailbox.
+// The render loop never reads threatEngine while the analysis task is changing
+// it, and a slow frame only skips views instead of holding up analysis.
+
+#define GUARDIAN_VIEW_DEVICES 6       // rows on the monitor screen
+#define GUARDIAN_VIEW_RECENT_MS 10000 // devices silent for longer are not listed
+#define GUARDIAN_FRAME_MS 50          // render loop period: input, alerts and redraws
+
+struct GuardianViewDevice {
+    uint8_t mac[6];
+    uint8_t threat; // ThreatType
+    bool malicious;
+    float riskScore;
+    float beaconRate; // per second
+    float probeRate;
+    uint16_t ssidCount;
+};
+
+struct GuardianView {
+    uint32_t builtAt;                     // guardianMillis()
+    uint32_t tracked;
+    uint32_t recent;                      // devices seen in the last GUARDIAN_VIEW_RECENT_MS
+    uint16_t attacks[THREAT_UNKNOWN + 1]; // devices marked malicious, by ThreatType
+    uint8_t count;
+    GuardianViewDevice devices[GUARDIAN_VIEW_DEVICES]; // riskiest first
+};
+
+// Backpressure between the pipeline stages, the capture ring keeps its own counters
+struct GuardianViewStats {
+    uint32_t published;  // views built by the analysis task
+    uint32_t superseded; // replaced before the render loop took them
+    uint32_t frames;     // render loop iterations
+    uint32_t overruns;   // frames that took longer than GUARDIAN_FRAME_MS
+};
+
+/**
+ * @brief Fills view with the riskiest devices of engine seen in the last GUARDIAN_VIEW_RECENT_MS
+ * @note Call from the task that runs analyze()
+ */
+void guardianBuildView(const ThreatEngine &engine, uint32_t now, GuardianView &view);
+
+#endif
@@ -0,0 +1,319 @@
+#ifndef __GUARDIAN_IEEE80211_H__
+#define __GUARDIAN_IEEE80211_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Zero-copy, bounds-checked 802.11 frame parser.
+// Header-only and free of Arduino/IDF types so it also builds on a Linux host.
+// Every accessor returns views into the original buffer, nothing is copied.
+
+#define IEEE80211_TYPE_MGMT 0
+#define IEEE80211_TYPE_CTRL 1
+#define IEEE80211_TYPE_DATA 2
+
+#define IEEE80211_SUBTYPE_ASSOC_REQ 0x0
+#define IEEE80211_SUBTYPE_ASSOC_RESP 0x1
+#define IEEE80211_SUBTYPE_REASSOC_REQ 0x2
+#define IEEE80211_SUBTYPE_REASSOC_RESP 0x3
+#define IEEE80211_SUBTYPE_PROBE_REQ 0x4
+#define IEEE80211_SUBTYPE_PROBE_RESP 0x5
+#define IEEE80211_SUBTYPE_BEACON 0x8
+#define IEEE80211_SUBTYPE_DISASSOC 0xA
+#define IEEE80211_SUBTYPE_AUTH 0xB
+#define IEEE80211_SUBTYPE_DEAUTH 0xC
+#define IEEE80211_SUBTYPE_ACTION 0xD
+
+#define IEEE80211_IE_SSID 0
+#define IEEE80211_IE_RATES 1
+#define IEEE80211_IE_DS_PARAMS 3
+#define IEEE80211_IE_HT_CAPS 45
+#define IEEE80211_IE_RSN 48
+#define IEEE80211_IE_EXT_RATES 50
+#define IEEE80211_IE_EXT_CAPS 127
+#define IEEE80211_IE_VHT_CAPS 191
+#define IEEE80211_IE_VENDOR 221
+
+#define IEEE80211_FCS_LEN 4
+
+#define IEEE80211_CAP_PRIVACY 0x0010               // capability info: encryption required
+#define IEEE80211_WPA_OUI_TYPE "\x00\x50\xF2\x01" // vendor element of (pre-RSN) WPA
+
+/**
+ * @brief One information element, data points into the frame buffer
+ */
+struct Ieee80211Ie {
+    uint8_t id;
+    uint8_t len;
+    const uint8_t *data;
+
+    /**
+     * @brief Vendor specific IE: 24 bit OUI, 0 if this is not a vendor IE
+     */
+    uint32_t vendorOui() const {
+        if (id != IEEE80211_IE_VENDOR || len < 3) return 0;
+        return ((uint32_t)data[0] << 16) | ((uint32_t)data[1] << 8) | data[2];
+    }
+
+    /**
+     * @brief DS parameter set: current channel, 0 if not a DS IE
+     */
+    uint8_t dsChannel() const { return (id == IEEE80211_IE_DS_PARAMS && len >= 1) ? data[0] : 0; }
+};
+
+/**
+ * @brief Walks a TLV information element list, stops at the first truncated element
+ */
+class Ieee80211IeIterator {
+public:
+    Ieee80211IeIterator(const uint8_t *buf, size_t len) : _p(buf), _end(buf ? buf + len : buf) {}
+
+    bool next(Ieee80211Ie &ie) {
+        if (_p == nullptr || _end - _p < 2) return false;
+        const uint8_t len = _p[1];
+        if ((size_t)(_end - _p - 2) < len) {
+            _p = _end; // malformed tail, stop here
+            return false;
+        }
+        ie.id = _p[0];
+        ie.len = len;
+        ie.data = _p + 2;
+        _p += 2 + len;
+        return true;
+    }
+
+private:
+    const uint8_t *_p;
+    const uint8_t *_end;
+};
+
+/**
+ * @brief Parsed RSN element (WPA2/WPA3), suites are 32 bit OUI:type values
+ */
+struct Ieee80211Rsn {
+    uint16_t version;
+    uint32_t groupCipher;
+    uint8_t pairwiseCount;
+    uint32_t pairwise[4]; // first suites only
+    uint8_t akmCount;
+    uint32_t akm[4];
+    uint16_t capabilities;
+
+    // Suite selectors from 802.11-2020 table 9-149/9-151 (OUI 00-0F-AC)
+    static const uint32_t CIPHER_TKIP = 0x000FAC02;
+    static const uint32_t CIPHER_CCMP = 0x000FAC04;
+    static const uint32_t CIPHER_GCMP = 0x000FAC08;
+    static const uint32_t CIPHER_GCMP256 = 0x000FAC09;
+    static const uint32_t CIPHER_CCMP256 = 0x000FAC0A;
+    static const uint32_t AKM_8021X = 0x000FAC01;
+    static const uint32_t AKM_PSK = 0x000FAC02;
+    static const uint32_t AKM_FT_8021X = 0x000FAC03;
+    static const uint32_t AKM_FT_PSK = 0x000FAC04;
+    static const uint32_t AKM_8021X_SHA256 = 0x000FAC05;
+    static const uint32_t AKM_PSK_SHA256 = 0x000FAC06;
+    static const uint32_t AKM_SAE = 0x000FAC08;
+    static const uint32_t AKM_FT_SAE = 0x000FAC09;
+    static const uint32_t AKM_SAE_EXT = 0x000FAC18;
+    static const uint16_t CAP_MFP_REQUIRED = 0x0040;
+    static const uint16_t CAP_MFP_CAPABLE = 0x0080;
+
+    /**
+     * @brief Decodes an RSN IE, fields missing from a short IE keep their defaults
+     * @return false if ie is not a well formed RSN element
+     */
+    bool parse(const Ieee80211Ie &ie) {
+        memset(this, 0, sizeof(*this));
+        if (ie.id != IEEE80211_IE_RSN || ie.len < 2) return false;
+        const uint8_t *p = ie.data;
+        const uint8_t *end = ie.data + ie.len;
+        version = p[0] | (p[1] << 8);
+        p += 2;
+
+        groupCipher = CIPHER_CCMP; // defaults when the IE is cut short
+        if (end - p < 4) return true;
+        groupCipher = suite(p);
+        p += 4;
+
+        if (end - p < 2) return true;
+        uint16_t n = p[0] | (p[1] << 8);
+        p += 2;
+        if ((size_t)(end - p) < (size_t)n * 4) return false;
+        pairwiseCount = n > 255 ? 255 : n;
+        for (uint16_t i = 0; i < n; i++, p += 4) {
+            if (i < 4) pairwise[i] = suite(p);
+        }
+
+        if (end - p < 2) return true;
+        n = p[0] | (p[1] << 8);
+        p += 2;
+        if ((size_t)(end - p) < (size_t)n * 4) return false;
+        akmCount = n > 255 ? 255 : n;
+        for (uint16_t i = 0; i < n; i++, p += 4) {
+            if (i < 4) akm[i] = suite(p);
+        }
+
+        if (end - p >= 2) capabilities = p[0] | (p[1] << 8);
+        return true;
+    }
+
+    bool hasAkm(uint32_t s) const {
+        for (uint8_t i = 0; i < akmCount && i < 4; i++) {
+            if (akm[i] == s) return true;
+        }
+        return false;
+    }
+
+private:
+    static uint32_t suite(const uint8_t *p) {
+        return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+    }
+};
+
+/**
+ * @brief View over one 802.11 frame (without FCS)
+ * @note parse() validates the header length, including the address 4, QoS
+ *       control and HT control shifts, so every accessor is in bounds afterwards.
+ */
+class Ieee80211Frame {
+public:
+    /**
+     * @return false if buf is too short for the header its frame control announces
+     */
+    bool parse(const uint8_t *buf, size_t len) {
+        _buf = buf;
+        _len = len;
+        _hdrLen = 0;
+        if (!buf || len < 10) return false; // frame control + duration + addr1
+
+        _fc = buf[0] | (buf[1] << 8);
+        size_t hdr;
+        if (type() == IEEE80211_TYPE_CTRL) {
+            hdr = 10; // only the ACK/CTS form is relied on, addr2 is not exposed for control frames
+        } else {
+            hdr = 24;
+            if (type() == IEEE80211_TYPE_DATA) {
+                if (toDS() && fromDS()) hdr += 6; // addr4
+                if (isQos()) {
+                    hdr += 2;
+                    if (order()) hdr += 4; // HT control
+                }
+            } else if (order()) {
+                hdr += 4; // +HTC management frame
+            }
+        }
+        if (len < hdr) return false;
+        _hdrLen = hdr;
+        return true;
+    }
+
+    uint16_t frameControl() const { return _fc; }
+    uint8_t type() const { return (_fc >> 2) & 0x3; }
+    uint8_t subtype() const { return (_fc >> 4) & 0xF; }
+    bool toDS() const { return _fc & 0x0100; }
+    bool fromDS() const { return _fc & 0x0200; }
+    bool isProtected() const { return _fc & 0x4000; }
+    bool order() const { return _fc & 0x8000; }
+
+    bool isMgmt() const { return type() == IEEE80211_TYPE_MGMT; }
+    bool isData() const { return type() == IEEE80211_TYPE_DATA; }
+    bool isQos() const { return isData() && (subtype() & 0x8); }
+    bool isMgmt(uint8_t sub) const { return isMgmt() && subtype() == sub; }
+    bool isBeacon() const { return isMgmt(IEEE80211_SUBTYPE_BEACON); }
+    bool isProbeReq() const { return isMgmt(IEEE80211_SUBTYPE_PROBE_REQ); }
+    bool isProbeResp() const { return isMgmt(IEEE80211_SUBTYPE_PROBE_RESP); }
+    bool isDeauth() const { return isMgmt(IEEE80211_SUBTYPE_DEAUTH); }
+    bool isDisassoc() const { return isMgmt(IEEE80211_SUBTYPE_DISASSOC); }
+
+    const uint8_t *addr1() const { return _buf + 4; }
+    const uint8_t *addr2() const { return _hdrLen >= 24 ? _buf + 10 : nullptr; }
+    const uint8_t *addr3() const { return _hdrLen >= 24 ? _buf + 16 : nullptr; }
+    const uint8_t *addr4() const { return (isData() && toDS() && fromDS()) ? _buf + 24 : nullptr; }
+
+    uint16_t seqCtrl() const { return _hdrLen >= 24 ? (_buf[22] | (_buf[23] << 8)) : 0; }
+    uint16_t seqNum() const { return seqCtrl() >> 4; }
+    uint8_t fragNum() const { return seqCtrl() & 0xF; }
+
+    size_t headerLen() const { return _hdrLen; }
+    const uint8_t *body() const { return _buf + _hdrLen; }
+    size_t bodyLen() const { return _len - _hdrLen; }
+
+    /**
+     * @brief Bytes of fixed fields preceding the IEs for this management subtype
+     * @return -1 if the subtype carries no IE list
+     */
+    int fixedFieldsLen() const {
+        if (!isMgmt()) return -1;
+        switch (subtype()) {
+            case IEEE80211_SUBTYPE_ASSOC_REQ: return 4;
+            case IEEE80211_SUBTYPE_ASSOC_RESP:
+            case IEEE80211_SUBTYPE_REASSOC_RESP: return 6;
+            case IEEE80211_SUBTYPE_REASSOC_REQ: return 10;
+            case IEEE80211_SUBTYPE_PROBE_REQ: return 0;
+            case IEEE80211_SUBTYPE_PROBE_RESP:
+            case IEEE80211_SUBTYPE_BEACON: return 12;
+            case IEEE80211_SUBTYPE_AUTH: return 6;
+            default: return -1;
+        }
+    }
+
+    /**
+     * @brief Beacon/probe response interval in TUs, 0 for other frames
+     */
+    uint16_t beaconInterval() const {
+        if (!(isBeacon() || isProbeResp()) || bodyLen() < 12) return 0;
+        return body()[8] | (body()[9] << 8);
+    }
+
+    /**
+     * @brief Beacon/probe response capability info, 0 for other frames
+     */
+    uint16_t capabilityInfo() const {
+        if (!(isBeacon() || isProbeResp()) || bodyLen() < 12) return 0;
+        return body()[10] | (body()[11] << 8);
+    }
+
+    /**
+     * @brief Deauth/disassoc reason code, 0 for other frames
+     */
+    uint16_t reasonCode() const {
+        if (!(isDeauth() || isDisassoc()) || bodyLen() < 2) return 0;
+        return body()[0] | (body()[1] << 8);
+    }
+
+    /**
+     * @brief Iterator over the information elements, empty if the frame has none
+     */
+    Ieee80211IeIterator ies() const {
+        const int fixed = fixedFieldsLen();
+        if (fixed < 0 || isProtected() || bodyLen() < (size_t)fixed) return Ieee80211IeIterator(nullptr, 0);
+        return Ieee80211IeIterator(body() + fixed, bodyLen() - fixed);
+    }
+
+    bool findIe(uint8_t id, Ieee80211Ie &out) const {
+        Ieee80211IeIterator it = ies();
+        while (it.next(out)) {
+            if (out.id == id) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief EtherType of an LLC/SNAP encapsulated data frame, 0 otherwise
+     * @note 0x888E is EAPOL
+     */
+    uint16_t llcEtherType() const {
+        if (!isData() || isProtected() || bodyLen() < 8) return 0;
+        const uint8_t *b = body();
+        if (b[0] != 0xAA || b[1] != 0xAA || b[2] != 0x03 || b[3] || b[4] || b[5]) return 0;
+        return (b[6] << 8) | b[7];
+    }
+
+private:
+    const uint8_t *_buf = nullptr;
+    size_t _len = 0;
+    size_t _hdrLen = 0;
+    uint16_t _fc = 0;
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef __GUARDIAN_JOURNAL_RECORD_H__
+#define __GUARDIAN_JOURNAL_RECORD_H__
+
+#include "mac_table.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// On-flash record of the threat journal (threat_journal.h).
+// Fixed size and self-checking: a record torn by a power loss fails its CRC and
+// is skipped, so no header or commit marker is needed around it. Little endian,
+// as written by the ESP32.
+
+#define JOURNAL_RECORD_SIZE 76
+#define JOURNAL_BLOOM_BYTES 256 // per segment MAC filter, ~1% false positives at 200 MACs
+
+struct JournalRecord {
+    uint32_t seq;      // increments with every record, never reused
+    uint32_t epoch;    // seconds since 1970, 0 when the clock was not set
+    uint32_t uptimeMs; // millis() when the incident was raised
+    uint8_t mac[6];
+    uint8_t type;   // ThreatType
+    uint8_t detail; // ThreatIncidentDetail
+    uint8_t peer[6];
+    uint8_t ssidLen;
+    uint8_t reserved;
+    float value;
+    float confidence;
+    uint32_t hits;
+    char ssid[32]; // not NUL terminated, see ssidLen
+    uint32_t crc;  // CRC-32 of every byte above
+};
+
+static_assert(sizeof(JournalRecord) == JOURNAL_RECORD_SIZE, "journal record layout changed");
+
+/**
+ * @brief CRC-32 (IEEE 802.3, as zlib), bitwise: records are short and rare
+ */
+inline uint32_t journalCrc32(const uint8_t *data, size_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+inline void journalSeal(JournalRecord &rec) {
+    rec.crc = journalCrc32((const uint8_t *)&rec, offsetof(JournalRecord, crc));
+}
+
+inline bool journalValid(const JournalRecord &rec) {
+    return rec.crc == journalCrc32((const uint8_t *)&rec, offsetof(JournalRecord, crc)) && rec.ssidLen <= 32;
+}
+
+/**
+ * @brief Key of the incident a record belongs to, for compaction
+ */
+inline uint64_t journalIncidentKey(const JournalRecord &rec) { return macToKey(rec.mac) | ((uint64_t)rec.type << 48); }
+
+/**
+ * @brief Bloom filter over the MACs of one segment (3 probes)
+ */
+struct JournalBloom {
+    uint8_t bits[JOURNAL_BLOOM_BYTES];
+
+    void clear() { memset(bits, 0, sizeof(bits)); }
+
+    void add(const uint8_t *mac) {
+        uint64_t h = mix(macToKey(mac));
+        for (int i = 0; i < 3; i++, h >>= 16) bits[(h >> 3) % JOURNAL_BLOOM_BYTES] |= 1 << (h & 7);
+    }
+
+    bool mayContain(const uint8_t *mac) const {
+        uint64_t h = mix(macToKey(mac));
+        for (int i = 0; i < 3; i++, h >>= 16) {
+            if (!(bits[(h >> 3) % JOURNAL_BLOOM_BYTES] & (1 << (h & 7)))) return false;
+        }
+        return true;
+    }
+
+private:
+    static uint64_t mix(uint64_t x) { // splitmix64 finalizer
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+};
+
+#endif
@@ -0,0 +1,40 @@
+#include "karma.h"
+
+bool KarmaDetector::begin(size_t maxBssids) {
+    end();
+    memset(_cache, 0, sizeof(_cache));
+    _probes = 0;
+    _answers = 0;
+    return _bssids.allocate(maxBssids);
+}
+
+void KarmaDetector::end() { _bssids.release(); }
+
+bool KarmaDetector::observe(const GuardianFrame &frame, uint32_t *answered) {
+    const uint8_t subtype = frame.frameCtrl >> 4;
+    if (subtype != IEEE80211_SUBTYPE_PROBE_REQ && subtype != IEEE80211_SUBTYPE_PROBE_RESP) return false;
+    if (frame.ssidLen == 0) return false; // wildcard probes ask nothing in particular
+
+    const uint32_t hash = ssidHash(frame.ssid, frame.ssidLen);
+    const uint32_t ssid = hash | 1; // never 0, the empty slot
+    Probe &slot = _cache[hash & (KARMA_PROBE_CACHE - 1)]; // the raw hash, so even slots are used too
+
+    if (subtype == IEEE80211_SUBTYPE_PROBE_REQ) {
+        slot.ssid = ssid; // newest probe wins the slot
+        slot.at = frame.timestamp;
+        _probes++;
+        return false;
+    }
+
+    if (slot.ssid != ssid || frame.timestamp - slot.at > KARMA_RESPONSE_WINDOW_MS) return false;
+    _answers++;
+
+    Responder *r = _bssids.insert(frame.addr3);
+    if (!r) return false;
+    r->answered.add(ssid);
+    const uint32_t count = r->answered.count();
+    if (answered) *answered = count;
+    if (r->reported || count < KARMA_SSID_THRESHOLD) return false;
+    r->reported = true;
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef __GUARDIAN_KARMA_H__
+#define __GUARDIAN_KARMA_H__
+
+#include "guardian_frame.h"
+#include "mac_table.h"
+#include "ssid_sketch.h"
+
+// Streaming Karma/MANA correlator.
+// Directed probe requests leave their SSID in a small direct-mapped cache, and a
+// probe response for a recently probed SSID counts as an answer of its BSSID.
+// A real AP only ever answers for its own network, a Karma AP answers for
+// whatever clients ask for, so the distinct SSIDs a BSSID answered for are
+// counted in a fixed SsidSketch. Matching is by SSID, not by client, which also
+// catches MANA answering one client with SSIDs probed by another.
+// O(1) work per frame, no strings kept.
+
+#ifndef KARMA_MAX_BSSIDS
+#define KARMA_MAX_BSSIDS 256 // responding BSSIDs tracked
+#endif
+#define KARMA_PROBE_CACHE 256         // probed SSIDs remembered, power of two
+#define KARMA_RESPONSE_WINDOW_MS 500  // a response within it answers the probe
+#define KARMA_SSID_THRESHOLD 3        // distinct SSIDs answered that flag a BSSID
+
+class KarmaDetector {
+public:
+    ~KarmaDetector() { end(); }
+
+    /**
+     * @return false if the allocation failed
+     */
+    bool begin(size_t maxBssids = KARMA_MAX_BSSIDS);
+    void end();
+
+    /**
+     * @brief Accounts a probe request or probe response, other frames are ignored
+     * @param answered set to the distinct SSIDs the responding BSSID answered for
+     * @return true once per BSSID, when it reaches KARMA_SSID_THRESHOLD
+     */
+    bool observe(const GuardianFrame &frame, uint32_t *answered = nullptr);
+
+    size_t bssids() const { return _bssids.size(); }
+    uint32_t probes() const { return _probes; }   // directed probe requests seen
+    uint32_t answers() const { return _answers; } // responses matched to a probe
+    uint32_t rejected() const { return _bssids.rejected(); }
+
+private:
+    struct Probe {
+        uint32_t ssid; // ssidHash(), 0 = empty
+        uint32_t at;
+    };
+
+    struct Responder {
+        SsidSketch answered;
+        bool reported;
+    };
+
+    Probe _cache[KARMA_PROBE_CACHE];
+    MacTable<Responder> _bssids;
+    uint32_t _probes = 0;
+    uint32_t _answers = 0;
+};
+
+#endif
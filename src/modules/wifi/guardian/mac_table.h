@@ -0,0 +1,207 @@
+#ifndef __GUARDIAN_MAC_TABLE_H__
+#define __GUARDIAN_MAC_TABLE_H__
+
+#include "guardian_alloc.h"
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MAC_TABLE_EMPTY UINT64_MAX
+
+/**
+ * @brief Packs a 6 byte MAC into the low 48 bits of a uint64_t
+ */
+inline uint64_t macToKey(const uint8_t *mac) {
+    return ((uint64_t)mac[0] << 40) | ((uint64_t)mac[1] << 32) | ((uint64_t)mac[2] << 24) |
+           ((uint64_t)mac[3] << 16) | ((uint64_t)mac[4] << 8) | (uint64_t)mac[5];
+}
+
+inline void keyToMac(uint64_t key, uint8_t *mac) {
+    for (int i = 5; i >= 0; i--) {
+        mac[i] = key & 0xFF;
+        key >>= 8;
+    }
+}
+
+/**
+ * @brief Fixed-capacity open-addressing (linear probing) table keyed by MAC
+ * @note All memory is allocated once in allocate(), so find()/insert() never allocate
+ *       and can run on the capture drain task at frame rate.
+ * @note Single writer. Readers on other tasks may iterate while the writer inserts:
+ *       the value is constructed before its key is published. erase() moves entries
+ *       and needs readers to be excluded.
+ */
+template <typename T> class MacTable {
+public:
+    ~MacTable() { release(); }
+
+    /**
+     * @brief Allocates room for maxEntries (rounded up to a power of two, at most 3/4 full)
+     * @return false if the allocation failed
+     */
+    bool allocate(size_t maxEntries) {
+        release();
+        size_t slots = 8;
+        while (slots * 3 / 4 < maxEntries) slots <<= 1;
+
+        _keys = (volatile uint64_t *)guardianAlloc(slots * sizeof(uint64_t));
+        _values = (T *)guardianAlloc(slots * sizeof(T));
+        if (!_keys || !_values) {
+            release();
+            return false;
+        }
+        _mask = slots - 1;
+        _shift = 64;
+        for (size_t s = slots; s > 1; s >>= 1) _shift--;
+        _limit = maxEntries;
+        for (size_t i = 0; i < slots; i++) _keys[i] = MAC_TABLE_EMPTY;
+        _size = 0;
+        _rejected = 0;
+        return true;
+    }
+
+    void release() {
+        clear();
+        free((void *)_keys);
+        free(_values);
+        _keys = nullptr;
+        _values = nullptr;
+        _mask = 0;
+        _limit = 0;
+    }
+
+    void clear() {
+        if (!_keys) return;
+        for (size_t i = 0; i <= _mask; i++) {
+            if (_keys[i] == MAC_TABLE_EMPTY) continue;
+            _keys[i] = MAC_TABLE_EMPTY;
+            _values[i].~T();
+        }
+        _size = 0;
+    }
+
+    T *find(const uint8_t *mac) { return findKey(macToKey(mac)); }
+
+    T *findKey(uint64_t key) {
+        if (!_keys) return nullptr;
+        for (size_t i = slotFor(key);; i = (i + 1) & _mask) {
+            const uint64_t k = _keys[i];
+            if (k == key) return &_values[i];
+            if (k == MAC_TABLE_EMPTY) return nullptr;
+        }
+    }
+
+    const T *findKey(uint64_t key) const { return const_cast<MacTable *>(this)->findKey(key); }
+
+    /**
+     * @brief Returns the entry for mac, default-constructing it when missing
+     * @param created set to true when a new entry was inserted
+     * @return nullptr when the table is full (counted in rejected())
+     */
+    T *insert(const uint8_t *mac, bool *created = nullptr) { return insertKey(macToKey(mac), created); }
+
+    /**
+     * @brief insert() for keys that are not MACs (any value but MAC_TABLE_EMPTY)
+     */
+    T *insertKey(uint64_t key, bool *created = nullptr) {
+        if (created) *created = false;
+        if (!_keys) return nullptr;
+        size_t i = slotFor(key);
+        for (;; i = (i + 1) & _mask) {
+            const uint64_t k = _keys[i];
+            if (k == key) return &_values[i];
+            if (k == MAC_TABLE_EMPTY) break;
+        }
+        if (_size >= _limit) {
+            _rejected++;
+            return nullptr;
+        }
+        new (&_values[i]) T();
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        _keys[i] = key;
+        _size++;
+        if (created) *created = true;
+        return &_values[i];
+    }
+
+    bool erase(const uint8_t *mac) { return eraseKey(macToKey(mac)); }
+
+    /**
+     * @brief Removes key, shifting the rest of its probe run back (no tombstones)
+     * @return false if key was not in the table
+     */
+    bool eraseKey(uint64_t key) {
+        if (!_keys) return false;
+        size_t i = slotFor(key);
+        for (;; i = (i + 1) & _mask) {
+            const uint64_t k = _keys[i];
+            if (k == key) break;
+            if (k == MAC_TABLE_EMPTY) return false;
+        }
+        _values[i].~T();
+
+        // Move back every later entry of the run whose home slot is not in (i, j]
+        for (size_t j = (i + 1) & _mask;; j = (j + 1) & _mask) {
+            const uint64_t k = _keys[j];
+            if (k == MAC_TABLE_EMPTY) break;
+            const size_t home = slotFor(k);
+            const bool stays = (i < j) ? (home > i && home <= j) : (home > i || home <= j);
+            if (stays) continue;
+            new (&_values[i]) T(_values[j]);
+            _values[j].~T();
+            _keys[i] = k;
+            i = j;
+        }
+        _keys[i] = MAC_TABLE_EMPTY;
+        _size--;
+        return true;
+    }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    size_t capacity() const { return _limit; }
+    uint32_t rejected() const { return _rejected; }
+
+    // Iteration over occupied slots, in table order
+    template <typename V> class Iter {
+    public:
+        Iter(const MacTable *table, size_t i) : _t(table), _i(i) { skip(); }
+        V &operator*() const { return _t->_values[_i]; }
+        V *operator->() const { return &_t->_values[_i]; }
+        uint64_t key() const { return _t->_keys[_i]; }
+        Iter &operator++() {
+            _i++;
+            skip();
+            return *this;
+        }
+        bool operator!=(const Iter &o) const { return _i != o._i; }
+
+    private:
+        void skip() {
+            while (_i < _t->slotCount() && _t->_keys[_i] == MAC_TABLE_EMPTY) _i++;
+        }
+        const MacTable *_t;
+        size_t _i;
+    };
+    typedef Iter<T> iterator;
+    typedef Iter<const T> const_iterator;
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, slotCount()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, slotCount()); }
+
+private:
+    size_t slotCount() const { return _keys ? _mask + 1 : 0; }
+    size_t slotFor(uint64_t key) const { return (size_t)((key * 0x9E3779B97F4A7C15ull) >> _shift); }
+
+    volatile uint64_t *_keys = nullptr;
+    T *_values = nullptr;
+    size_t _mask = 0;
+    unsigned _shift = 64;
+    size_t _limit = 0;
+    size_t _size = 0;
+    uint32_t _rejected = 0;
+};
+
+#endif
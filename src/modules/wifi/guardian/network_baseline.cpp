@@ -0,0 +1,204 @@
+#include "network_baseline.h"
+#include "journal_record.h"
+#include "ssid_sketch.h"
+
+// Security of an SSID served by APs advertising a and b: the strong bits all have, any weak one
+static uint16_t weakest(uint16_t a, uint16_t b) {
+    return (a & b & GUARDIAN_SEC_STRONG) | ((a | b) & GUARDIAN_SEC_WEAK);
+}
+
+// Tells repeats of one deviating advertisement from others
+static uint16_t advertHash(const GuardianFrame &frame) {
+    const uint8_t tail[3] = {frame.channel, (uint8_t)frame.security, (uint8_t)(frame.security >> 8)};
+    uint16_t h = guardianIeHash((const uint8_t *)&frame.fingerprint, sizeof(frame.fingerprint));
+    h = guardianIeHash(tail, sizeof(tail), h);
+    return guardianIeHash((const uint8_t *)frame.ssid, frame.ssidLen, h);
+}
+
+bool NetworkBaseline::begin(size_t maxAps) {
+    end();
+    if (!_aps.allocate(maxAps) || !_ssids.allocate(BASELINE_MAX_SSIDS) ||
+        !_strangers.allocate(BASELINE_MAX_STRANGERS)) {
+        end();
+        return false;
+    }
+    _deviations = 0;
+    _learning = false;
+    return true;
+}
+
+void NetworkBaseline::end() {
+    _aps.release();
+    _ssids.release();
+    _strangers.release();
+    _learned = 0;
+}
+
+void NetworkBaseline::clear() {
+    _aps.clear();
+    _ssids.clear();
+    _strangers.clear();
+    _learned = 0;
+    _deviations = 0;
+}
+
+void NetworkBaseline::setLearning(bool learning) {
+    if (learning == _learning) return;
+    _learning = learning;
+    _strangers.clear();
+    for (MacTable<Ap>::iterator it = _aps.begin(); it != _aps.end(); ++it) {
+        it->reported = 0;
+        it->pendingCount = 0;
+    }
+}
+
+bool NetworkBaseline::observe(const GuardianFrame &frame, BaselineDeviation &deviation) {
+    // Hidden networks all share the empty SSID, probe responses vary their vendor IEs
+    if ((frame.frameCtrl >> 4) != IEEE80211_SUBTYPE_BEACON || frame.ssidLen == 0) return false;
+
+    const uint32_t ssid = ssidHash(frame.ssid, frame.ssidLen);
+    if (_learning) {
+        learn(frame, ssid);
+        return false;
+    }
+
+    BaselineDeviationKind kind;
+    uint8_t learnedChannel = 0;
+    uint16_t learnedSecurity;
+    Ap *ap = _aps.find(frame.addr3);
+    if (ap && ap->learned) {
+        if (ap->ssid == ssid && sameAdvert(*ap, frame)) return false;
+
+        const bool renamed = ap->ssid != ssid;
+        if (!renamed && guardianSecurityWeakened(ap->security, frame.security)) kind = BASELINE_DOWNGRADE;
+        else if (!renamed && ap->security == frame.security &&
+                 memcmp(&ap->fingerprint, &frame.fingerprint, sizeof(frame.fingerprint)) == 0) kind = BASELINE_CHANNEL;
+        else kind = BASELINE_CHANGED;
+        if (ap->reported & (1 << kind)) return false;
+        if (!confirm(ap->pending, ap->pendingCount, ap->pendingLast, frame)) return false;
+        ap->reported |= 1 << kind;
+        learnedChannel = ap->channel;
+        learnedSecurity = ap->security;
+    } else {
+        // Not a learned AP: only of interest when it claims a trusted SSID
+        const Ssid *trusted = _ssids.findKey(ssid);
+        if (!trusted) return false;
+        Stranger *s = _strangers.insert(frame.addr3);
+        if (!s || s->reported) return false;
+        if (!confirm(s->pending, s->pendingCount, s->pendingLast, frame)) return false;
+        s->reported = true;
+        kind = guardianSecurityWeakened(trusted->security, frame.security) ? BASELINE_DOWNGRADE : BASELINE_NEW_BSSID;
+        learnedSecurity = trusted->security;
+    }
+
+    deviation.kind = kind;
+    memcpy(deviation.bssid, frame.addr3, 6);
+    deviation.channel = frame.channel;
+    deviation.learnedChannel = learnedChannel;
+    deviation.security = frame.security;
+    deviation.learnedSecurity = learnedSecurity;
+    deviation.ssidLen = frame.ssidLen;
+    memcpy(deviation.ssid, frame.ssid, frame.ssidLen);
+    _deviations++;
+    return true;
+}
+
+void NetworkBaseline::learn(const GuardianFrame &frame, uint32_t ssid) {
+    bool created;
+    Ap *ap = _aps.insert(frame.addr3, &created);
+    if (!ap) return;
+
+    if (!created && ap->ssid == ssid && sameAdvert(*ap, frame)) {
+        if (!ap->learned && ++ap->confirmations >= BASELINE_CONFIRM_BEACONS) trust(*ap, frame.ssid, frame.ssidLen);
+        return;
+    }
+    if (!ap->learned) { // first beacon, or the previous ones never settled
+        adopt(*ap, frame, ssid);
+        return;
+    }
+
+    // Reconfigured during training: the new advertisement replaces the old once it settles
+    if (!confirm(ap->pending, ap->pendingCount, ap->pendingLast, frame)) return;
+    untrust(*ap);
+    adopt(*ap, frame, ssid);
+    trust(*ap, frame.ssid, frame.ssidLen);
+}
+
+void NetworkBaseline::adopt(Ap &ap, const GuardianFrame &frame, uint32_t ssid) {
+    memset(&ap, 0, sizeof(ap));
+    ap.ssid = ssid;
+    ap.fingerprint = frame.fingerprint;
+    ap.security = frame.security;
+    ap.channel = frame.channel;
+    ap.confirmations = 1;
+}
+
+void NetworkBaseline::trust(Ap &ap, const char *name, uint8_t len) {
+    bool created;
+    Ssid *s = _ssids.insertKey(ap.ssid, &created);
+    if (!s) return; // SSID table full, the AP stays unlearned
+    if (created) {
+        s->security = ap.security;
+        s->len = len;
+        memcpy(s->name, name, len);
+    } else {
+        s->security = weakest(s->security, ap.security);
+    }
+    if (s->aps < UINT16_MAX) s->aps++;
+    ap.learned = true;
+    _learned++;
+}
+
+void NetworkBaseline::untrust(Ap &ap) {
+    Ssid *s = _ssids.findKey(ap.ssid);
+    if (s && s->aps > 0 && --s->aps == 0) _ssids.eraseKey(ap.ssid);
+    ap.learned = false;
+    _learned--;
+}
+
+bool NetworkBaseline::sameAdvert(const Ap &ap, const GuardianFrame &frame) {
+    return ap.channel == frame.channel && ap.security == frame.security &&
+           memcmp(&ap.fingerprint, &frame.fingerprint, sizeof(frame.fingerprint)) == 0;
+}
+
+bool NetworkBaseline::confirm(uint16_t &pending, uint8_t &count, uint32_t &last, const GuardianFrame &frame) {
+    const uint16_t h = advertHash(frame);
+    if (h != pending || frame.timestamp - last > BASELINE_CONFIRM_MS) {
+        pending = h;
+        count = 0;
+    }
+    last = frame.timestamp;
+    if (count < UINT8_MAX) count++;
+    return count >= BASELINE_CONFIRM_BEACONS;
+}
+
+bool NetworkBaseline::restore(const BaselineRecord &record) {
+    if (record.crc != journalCrc32((const uint8_t *)&record, offsetof(BaselineRecord, crc))) return false;
+    if (record.ssidLen == 0 || record.ssidLen > sizeof(record.ssid)) return false;
+
+    bool created;
+    Ap *ap = _aps.insert(record.bssid, &created);
+    if (!ap) return false;
+    if (ap->learned) untrust(*ap); // listed twice, the later record wins
+    memset(ap, 0, sizeof(*ap));
+    ap->ssid = ssidHash(record.ssid, record.ssidLen);
+    ap->fingerprint = record.fingerprint;
+    ap->security = record.security;
+    ap->channel = record.channel;
+    trust(*ap, record.ssid, record.ssidLen);
+    return ap->learned;
+}
+
+bool NetworkBaseline::toRecord(uint64_t bssid, const Ap &ap, BaselineRecord &out) const {
+    const Ssid *s = _ssids.findKey(ap.ssid);
+    if (!s) return false;
+    memset(&out, 0, sizeof(out));
+    keyToMac(bssid, out.bssid);
+    out.channel = ap.channel;
+    out.ssidLen = s->len;
+    out.security = ap.security;
+    out.fingerprint = ap.fingerprint;
+    memcpy(out.ssid, s->name, s->len);
+    out.crc = journalCrc32((const uint8_t *)&out, offsetof(BaselineRecord, crc));
+    return true;
+}
@@ -0,0 +1,163 @@
+#ifndef __GUARDIAN_NETWORK_BASELINE_H__
+#define __GUARDIAN_NETWORK_BASELINE_H__
+
+#include "guardian_frame.h"
+#include "mac_table.h"
+
+// Learned baseline of the networks around a known-good place.
+// During a training window every beaconing AP is recorded as it advertises
+// itself: BSSID, SSID, channel, security (GUARDIAN_SEC_*) and the fingerprint
+// of its elements (guardian_frame.h). Monitoring then diffs each beacon against
+// it with two hash lookups, BSSID then SSID, and names what changed: a known AP
+// advertising weaker security, an unknown BSSID beaconing a trusted SSID, an AP
+// that moved channel or changed its elements. Each deviation has to repeat
+// BASELINE_CONFIRM_BEACONS times before it is reported, once per AP and kind,
+// so a corrupted beacon raises nothing. Fixed memory, the entries persist as
+// BaselineRecords (baseline_store.h).
+
+#ifndef BASELINE_MAX_APS
+#define BASELINE_MAX_APS 192 // APs learned, later ones are left out
+#endif
+#define BASELINE_MAX_SSIDS 64      // distinct SSIDs learned
+#define BASELINE_MAX_STRANGERS 64  // unknown BSSIDs of trusted SSIDs followed while monitoring
+#define BASELINE_CONFIRM_BEACONS 3 // identical beacons before an AP is learned or a deviation reported
+#define BASELINE_CONFIRM_MS 10000  // a deviation not repeated within it starts over
+
+enum BaselineDeviationKind {
+    BASELINE_NONE,
+    BASELINE_DOWNGRADE, // a trusted SSID advertised with weaker security, by a known AP or a new one
+    BASELINE_NEW_BSSID, // unknown BSSID beaconing a trusted SSID as securely as its APs
+    BASELINE_CHANNEL,   // known AP on another channel, otherwise unchanged
+    BASELINE_CHANGED    // known AP with other elements (rates, capabilities, vendor IEs) or another SSID
+};
+
+struct BaselineDeviation {
+    BaselineDeviationKind kind;
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t learnedChannel;   // 0 for a new BSSID
+    uint16_t security;        // GUARDIAN_SEC_* bits
+    uint16_t learnedSecurity; // of the AP, or of the SSID's weakest AP for a new BSSID
+    uint8_t ssidLen;
+    char ssid[32];
+};
+
+typedef void (*BaselineDeviationHandler)(const BaselineDeviation &deviation);
+
+/**
+ * @brief One learned AP as stored on flash, little endian
+ */
+struct BaselineRecord {
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t ssidLen;
+    uint16_t security;
+    uint16_t reserved;
+    BeaconFingerprint fingerprint;
+    char ssid[32]; // not NUL terminated, see ssidLen
+    uint32_t crc;  // journalCrc32() of every byte above
+};
+
+static_assert(sizeof(BaselineRecord) == 60, "baseline record layout changed");
+
+class NetworkBaseline {
+public:
+    ~NetworkBaseline() { end(); }
+
+    /**
+     * @brief Allocates the tables, empty and monitoring
+     * @return false if the allocation failed
+     */
+    bool begin(size_t maxAps = BASELINE_MAX_APS);
+    void end();
+    void clear();
+
+    /**
+     * @brief While set, beacons are learned instead of diffed
+     * @note APs whose beacons never settled stay unlearned, reported deviations are
+     *       forgotten on every switch
+     */
+    void setLearning(bool learning);
+    bool learning() const { return _learning; }
+
+    /**
+     * @brief Learns or diffs one beacon, other frames are ignored
+     * @return true when deviation was filled in with a newly confirmed deviation
+     */
+    bool observe(const GuardianFrame &frame, BaselineDeviation &deviation);
+
+    /**
+     * @brief Adds a stored AP
+     * @return false if the record is corrupt or the tables are full
+     */
+    bool restore(const BaselineRecord &record);
+
+    /**
+     * @brief Calls fn(const BaselineRecord &) with the stored form of every learned AP
+     */
+    template <typename Fn> void forEachRecord(Fn fn) const {
+        BaselineRecord rec;
+        for (MacTable<Ap>::const_iterator it = _aps.begin(); it != _aps.end(); ++it) {
+            if (it->learned && toRecord(it.key(), *it, rec)) fn(rec);
+        }
+    }
+
+    /**
+     * @brief Calls fn(name, len, aps) for every learned SSID
+     */
+    template <typename Fn> void forEachSsid(Fn fn) const {
+        for (MacTable<Ssid>::const_iterator it = _ssids.begin(); it != _ssids.end(); ++it) {
+            fn(it->name, it->len, it->aps);
+        }
+    }
+
+    size_t aps() const { return _learned; } // learned APs
+    size_t ssids() const { return _ssids.size(); }
+    uint32_t rejected() const { return _aps.rejected() + _ssids.rejected(); } // APs not learned, tables full
+    uint32_t deviations() const { return _deviations; }
+
+private:
+    struct Ap {
+        uint32_t ssid; // ssidHash()
+        BeaconFingerprint fingerprint;
+        uint16_t security;
+        uint8_t channel;
+        uint8_t confirmations; // identical beacons while learning
+        bool learned;
+        uint8_t reported;     // 1 << BaselineDeviationKind, each raised once
+        uint8_t pendingCount; // repeats of the deviating advertisement being confirmed
+        uint16_t pending;     // its hash
+        uint32_t pendingLast;
+    };
+
+    struct Ssid {
+        uint16_t security; // of its weakest AP: the strong bits all have, any weak one
+        uint16_t aps;
+        uint8_t len;
+        char name[32];
+    };
+
+    struct Stranger {
+        uint16_t pending;
+        uint8_t pendingCount;
+        bool reported;
+        uint32_t pendingLast;
+    };
+
+    void learn(const GuardianFrame &frame, uint32_t ssid);
+    void adopt(Ap &ap, const GuardianFrame &frame, uint32_t ssid);
+    void trust(Ap &ap, const char *name, uint8_t len);
+    void untrust(Ap &ap);
+    bool toRecord(uint64_t bssid, const Ap &ap, BaselineRecord &out) const;
+    static bool sameAdvert(const Ap &ap, const GuardianFrame &frame);
+    static bool confirm(uint16_t &pending, uint8_t &count, uint32_t &last, const GuardianFrame &frame);
+
+    MacTable<Ap> _aps;             // by BSSID
+    MacTable<Ssid> _ssids;         // by ssidHash()
+    MacTable<Stranger> _strangers; // by BSSID
+    size_t _learned = 0;
+    uint32_t _deviations = 0;
+    bool _learning = false;
+};
+
+#endif
@@ -0,0 +1,296 @@
+#ifndef __GUARDIAN_PCAP_REPLAY_H__
+#define __GUARDIAN_PCAP_REPLAY_H__
+
+#include "guardian_alloc.h"
+#include "guardian_clock.h"
+#include "guardian_frame.h"
+#include <stdlib.h>
+
+// Pcap replay source for the Guardian detectors.
+// Reads LINKTYPE_IEEE802_11 captures (as written by the sniffer to /BrucePCAP),
+// and LINKTYPE_IEEE802_11_RADIOTAP ones (Linux monitor mode) with their RSSI, and feeds them to the same batch/tick handlers the live capture uses, with the
+// detector clock following the capture timestamps.
+// Stream is anything with size_t read(uint8_t *, size_t): an Arduino File on the
+// device, PcapStdioStream on a Linux host.
+
+#define PCAP_LINKTYPE_IEEE802_11 105
+#define PCAP_LINKTYPE_RADIOTAP 127
+#define PCAP_REPLAY_MAX_FRAME 2500 // sniffer snaplen, longer records are truncated
+#define PCAP_REPLAY_BATCH 32
+
+struct PcapRecord {
+    uint32_t tsSec;
+    uint32_t tsFrac;  // microseconds, nanoseconds for nanosecond captures
+    uint32_t inclLen; // bytes stored in the file
+    uint32_t origLen; // bytes on air
+};
+
+template <typename Stream> class PcapReader {
+public:
+    explicit PcapReader(Stream &stream) : _stream(stream) {}
+
+    /**
+     * @brief Reads the global header
+     * @return false if the stream is not a pcap file
+     */
+    bool open() {
+        uint8_t hdr[24];
+        if (!readExact(hdr, sizeof(hdr))) return false;
+
+        const uint32_t magic = hdr[0] | (hdr[1] << 8) | (hdr[2] << 16) | ((uint32_t)hdr[3] << 24);
+        switch (magic) {
+            case 0xA1B2C3D4: _swapped = false; _nanos = false; break;
+            case 0xD4C3B2A1: _swapped = true; _nanos = false; break;
+            case 0xA1B23C4D: _swapped = false; _nanos = true; break;
+            case 0x4D3CB2A1: _swapped = true; _nanos = true; break;
+            default: return false;
+        }
+        _snapLen = u32(hdr + 16);
+        _linkType = u32(hdr + 20) & 0x0FFFFFFF; // upper bits carry FCS flags
+        return true;
+    }
+
+    uint32_t linkType() const { return _linkType; }
+    uint32_t snapLen() const { return _snapLen; }
+    bool nanosecond() const { return _nanos; }
+
+    /**
+     * @brief Reads the next record, copying at most cap bytes of it to buf
+     * @param copied bytes written to buf, the rest of the record is skipped
+     * @return false at the end of the file or on a truncated record
+     */
+    bool next(PcapRecord &rec, uint8_t *buf, size_t cap, size_t &copied) {
+        uint8_t hdr[16];
+        if (!readExact(hdr, sizeof(hdr))) return false;
+        rec.tsSec = u32(hdr);
+        rec.tsFrac = u32(hdr + 4);
+        rec.inclLen = u32(hdr + 8);
+        rec.origLen = u32(hdr + 12);
+
+        copied = rec.inclLen < cap ? rec.inclLen : cap;
+        if (!readExact(buf, copied)) return false;
+        return skip(rec.inclLen - copied);
+    }
+
+    /**
+     * @brief Record timestamp in microseconds
+     */
+    uint64_t micros(const PcapRecord &rec) const {
+        return (uint64_t)rec.tsSec * 1000000 + (_nanos ? rec.tsFrac / 1000 : rec.tsFrac);
+    }
+
+private:
+    Stream &_stream;
+    bool _swapped = false;
+    bool _nanos = false;
+    uint32_t _snapLen = 0;
+    uint32_t _linkType = 0;
+
+    uint32_t u32(const uint8_t *p) const {
+        if (_swapped) return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+        return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    bool readExact(uint8_t *buf, size_t len) {
+        while (len > 0) {
+            size_t n = _stream.read(buf, len);
+            if (n == 0 || n > len) return false;
+            buf += n;
+            len -= n;
+        }
+        return true;
+    }
+
+    bool skip(size_t len) {
+        uint8_t scratch[64];
+        while (len > 0) {
+            size_t n = len < sizeof(scratch) ? len : sizeof(scratch);
+            if (!readExact(scratch, n)) return false;
+            len -= n;
+        }
+        return true;
+    }
+};
+
+inline bool pcapLinkTypeSupported(uint32_t linkType) {
+    return linkType == PCAP_LINKTYPE_IEEE802_11 || linkType == PCAP_LINKTYPE_RADIOTAP;
+}
+
+/**
+ * @brief Reads the radiotap header in front of an 802.11 frame
+ * @param rssi antenna signal in dBm, 0 when the header has none
+ * @param channel channel of the frequency field, 0 when the header has none
+ * @return header length, 0 if buf does not start with a valid radiotap header
+ */
+inline size_t pcapRadiotap(const uint8_t *buf, size_t len, int8_t &rssi, uint8_t &channel) {
+    rssi = 0;
+    channel = 0;
+    if (len < 8 || buf[0] != 0) return 0;
+    const size_t hdrLen = buf[2] | (buf[3] << 8);
+    if (hdrLen < 8 || hdrLen > len) return 0;
+
+    // Fields follow the present words in bit order, each aligned to its own size
+    const uint32_t present = buf[4] | (buf[5] << 8) | (buf[6] << 16) | ((uint32_t)buf[7] << 24);
+    size_t off = 8;
+    for (uint32_t more = present; more & 0x80000000u; off += 4) {
+        if (off + 4 > hdrLen) return 0;
+        more = (uint32_t)buf[off + 3] << 24;
+    }
+    static const uint8_t fieldSize[] = {8, 1, 1, 4, 2, 1}; // TSFT, flags, rate, channel, FHSS, dBm signal
+    static const uint8_t fieldAlign[] = {8, 1, 1, 2, 2, 1};
+    for (uint8_t field = 0; field < sizeof(fieldSize); field++) {
+        if (!(present & (1u << field))) continue;
+        off = (off + fieldAlign[field] - 1) & ~(size_t)(fieldAlign[field] - 1);
+        if (off + fieldSize[field] > hdrLen) break;
+        if (field == 3) {
+            const uint16_t mhz = buf[off] | (buf[off + 1] << 8);
+            if (mhz >= 2412 && mhz <= 2472) channel = (mhz - 2407) / 5;
+            else if (mhz == 2484) channel = 14;
+            else if (mhz >= 5000 && mhz < 6000) channel = (mhz - 5000) / 5;
+        } else if (field == 5) {
+            rssi = (int8_t)buf[off];
+        }
+        off += fieldSize[field];
+    }
+    return hdrLen;
+}
+
+#if !defined(ARDUINO)
+#include <stdio.h>
+
+// FILE* adapter for host builds
+class PcapStdioStream {
+public:
+    explicit PcapStdioStream(FILE *f) : _f(f) {}
+    size_t read(uint8_t *buf, size_t len) { return fread(buf, 1, len, _f); }
+
+private:
+    FILE *_f;
+};
+#endif
+
+struct GuardianReplayOptions {
+    GuardianBatchHandler onBatch;
+    GuardianTickHandler onTick; // may be nullptr
+    uint32_t tickIntervalMs;    // virtual time between onTick calls
+    uint16_t speed;             // 0 = as fast as possible, 1 = original speed, N = N times faster
+    bool (*shouldStop)();       // polled between frames, may be nullptr
+};
+
+struct GuardianReplayStats {
+    uint32_t records;   // pcap records read
+    uint32_t frames;    // management frames handed to onBatch
+    uint32_t skipped;   // control/data frames and unparseable records
+    uint32_t truncated; // records longer than PCAP_REPLAY_MAX_FRAME
+    uint32_t ticks;
+    uint32_t virtualMs; // capture duration
+    uint32_t wallMs;    // replay duration
+    bool aborted;       // stopped by shouldStop
+};
+
+/**
+ * @brief Feeds an opened LINKTYPE 105 or 127 capture to the detector handlers
+ * @note Runs on the calling task; onBatch and onTick never race each other, as with
+ *       the live capture. The detector clock starts at 0 on the first record and
+ *       follows the capture timestamps, onTick fires every tickIntervalMs of capture
+ *       time regardless of the speed, so results do not depend on it.
+ * @note The clock stays virtual afterwards so the final state can still be displayed,
+ *       call guardianClockRelease() when done with it.
+ */
+template <typename Stream>
+GuardianReplayStats guardianReplay(PcapReader<Stream> &reader, const GuardianReplayOptions &opt) {
+    GuardianReplayStats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    uint8_t *buf = (uint8_t *)guardianAlloc(PCAP_REPLAY_MAX_FRAME);
+    GuardianFrame *batch = (GuardianFrame *)guardianAlloc(PCAP_REPLAY_BATCH * sizeof(GuardianFrame));
+    if (!buf || !batch) {
+        free(buf);
+        free(batch);
+        stats.aborted = true;
+        return stats;
+    }
+
+    const uint32_t wallStart = guardianWallMillis();
+    const uint32_t tickMs = opt.tickIntervalMs ? opt.tickIntervalMs : 1;
+    uint64_t firstUs = 0;
+    uint32_t now = 0;
+    uint32_t nextTick = tickMs;
+    size_t pending = 0;
+    guardianClockSet(0);
+
+    PcapRecord rec;
+    size_t len;
+    while (reader.next(rec, buf, PCAP_REPLAY_MAX_FRAME, len)) {
+        const uint64_t us = reader.micros(rec);
+        if (stats.records++ == 0) firstUs = us;
+        if (rec.inclLen > len) stats.truncated++;
+
+        // Capture time, kept monotonic when records are out of order
+        uint32_t t = us > firstUs ? (uint32_t)((us - firstUs) / 1000) : 0;
+        if (t < now) t = now;
+
+        bool stop = opt.shouldStop && (stats.records & 63) == 1 && opt.shouldStop();
+        if (opt.speed) {
+            const uint32_t due = wallStart + t / opt.speed;
+            while (!stop && (int32_t)(due - guardianWallMillis()) > 0) {
+                if (pending) { // hand over what is there before idling
+                    opt.onBatch(batch, pending);
+                    pending = 0;
+                }
+                uint32_t wait = due - guardianWallMillis();
+                guardianSleepMs(wait > 50 ? 50 : wait);
+                stop = opt.shouldStop && opt.shouldStop();
+            }
+        }
+        if (stop) {
+            stats.aborted = true;
+            break;
+        }
+
+        while (nextTick <= t) {
+            if (pending) {
+                opt.onBatch(batch, pending);
+                pending = 0;
+            }
+            guardianClockSet(nextTick);
+            if (opt.onTick) opt.onTick();
+            stats.ticks++;
+            nextTick += tickMs;
+        }
+        now = t;
+        guardianClockSet(now);
+
+        int8_t rssi = 0;
+        uint8_t channel = 0;
+        size_t hdrLen = 0;
+        if (reader.linkType() == PCAP_LINKTYPE_RADIOTAP) hdrLen = pcapRadiotap(buf, len, rssi, channel);
+        Ieee80211Frame dot11;
+        if ((reader.linkType() == PCAP_LINKTYPE_RADIOTAP && hdrLen == 0) || !dot11.parse(buf + hdrLen, len - hdrLen) ||
+            !dot11.isMgmt()) {
+            stats.skipped++;
+            continue;
+        }
+        guardianFillFrame(&batch[pending++], dot11, rssi, channel, now);
+        stats.frames++;
+        if (pending == PCAP_REPLAY_BATCH) {
+            opt.onBatch(batch, pending);
+            pending = 0;
+        }
+    }
+
+    if (pending) opt.onBatch(batch, pending);
+    if (!stats.aborted && opt.onTick) { // analyze the trailing frames
+        guardianClockSet(nextTick);
+        opt.onTick();
+        stats.ticks++;
+    }
+
+    stats.virtualMs = now;
+    stats.wallMs = guardianWallMillis() - wallStart;
+    free(buf);
+    free(batch);
+    return stats;
+}
+
+#endif
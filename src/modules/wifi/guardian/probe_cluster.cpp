@@ -0,0 +1,67 @@
+#include "probe_cluster.h"
+
+bool ProbeClusters::begin() {
+    end();
+    const size_t bytes = PROBE_CLUSTER_SETS * PROBE_CLUSTER_WAYS * sizeof(Cluster);
+    _table = (Cluster *)guardianAlloc(bytes);
+    if (!_table) return false;
+    memset(_table, 0, bytes);
+    _clusters = 0;
+    _merged = 0;
+    return true;
+}
+
+void ProbeClusters::end() {
+    free(_table);
+    _table = nullptr;
+}
+
+uint64_t ProbeClusters::resolve(const GuardianFrame &frame) {
+    const uint64_t mac = macToKey(frame.addr2);
+    if (!_table || !frame.probeFingerprint || !macRandomized(frame.addr2)) return mac;
+
+    const uint32_t fp = frame.probeFingerprint;
+    const uint16_t seq = frame.seqCtrl >> 4;
+    Cluster *set = _table + (fp & (PROBE_CLUSTER_SETS - 1)) * PROBE_CLUSTER_WAYS; // fingerprints are already mixed
+
+    // Own MAC (the rest of a scan burst, or the MAC that started it) first, else the
+    // closest sequence continuation
+    Cluster *best = nullptr;
+    uint16_t bestAhead = PROBE_CLUSTER_SEQ_WINDOW;
+    for (size_t w = 0; w < PROBE_CLUSTER_WAYS; w++) {
+        Cluster &c = set[w];
+        const uint32_t idle = frame.timestamp - c.lastSeen;
+        if (c.fingerprint != fp || idle > PROBE_CLUSTER_IDLE_MS) continue;
+        if (c.lastMac == mac || c.key == mac) {
+            best = &c;
+            break;
+        }
+        const uint16_t ahead = (seq - c.lastSeq) & 0xFFF;
+        const uint16_t window = idle < PROBE_CLUSTER_BURST_MS ? PROBE_CLUSTER_BURST_SEQ : PROBE_CLUSTER_SEQ_WINDOW;
+        if (ahead < window && ahead < bestAhead) {
+            best = &c;
+            bestAhead = ahead;
+        }
+    }
+
+    if (best) {
+        if (best->lastMac != mac) _merged++;
+        best->lastMac = mac;
+        best->lastSeen = frame.timestamp;
+        best->lastSeq = seq;
+        return best->key;
+    }
+
+    // New client: an empty way, else the least recently seen one
+    Cluster *victim = &set[0];
+    for (size_t w = 0; w < PROBE_CLUSTER_WAYS && victim->fingerprint; w++) {
+        if (!set[w].fingerprint || (int32_t)(set[w].lastSeen - victim->lastSeen) < 0) victim = &set[w];
+    }
+    victim->key = mac;
+    victim->lastMac = mac;
+    victim->fingerprint = fp;
+    victim->lastSeen = frame.timestamp;
+    victim->lastSeq = seq;
+    _clusters++;
+    return mac;
+}
@@ -0,0 +1,67 @@
+#ifndef __GUARDIAN_PROBE_CLUSTER_H__
+#define __GUARDIAN_PROBE_CLUSTER_H__
+
+#include "guardian_frame.h"
+#include "mac_table.h"
+
+// Groups the randomized MACs of one client into a single device.
+// Phones probe from a new locally administered MAC every scan, which would make
+// a device of each. The elements of their probe requests stay the same though
+// (GuardianFrame::probeFingerprint) and most keep the sequence counter running
+// across MACs, so a probe from a new random MAC joins the recent cluster with
+// the same fingerprint whose sequence number it continues. Identical phones
+// share a fingerprint but not a sequence counter, and stay apart; while a
+// cluster is mid-burst only its very next sequence numbers join, so two such
+// phones probing at the same time are not merged by a near counter.
+// Clusters live in a set associative cache: O(1) per frame, fixed memory, the
+// least recently seen cluster of a set makes room. Every phone of a model lands
+// in the same set, hence the many ways.
+
+#define PROBE_CLUSTER_SETS 16          // power of two
+#define PROBE_CLUSTER_WAYS 16          // clusters per set
+#define PROBE_CLUSTER_SEQ_WINDOW 64    // sequence numbers a client may skip between MACs
+#define PROBE_CLUSTER_BURST_MS 1000    // a cluster seen more recently is mid-burst
+#define PROBE_CLUSTER_BURST_SEQ 4      // sequence window of a cluster mid-burst
+#define PROBE_CLUSTER_IDLE_MS 60000    // a cluster silent for longer is not joined
+
+/**
+ * @brief Locally administered MAC, the kind clients randomize
+ */
+inline bool macRandomized(const uint8_t *mac) { return mac[0] & 0x02; }
+
+class ProbeClusters {
+public:
+    ~ProbeClusters() { end(); }
+
+    /**
+     * @return false if the allocation failed
+     */
+    bool begin();
+    void end();
+
+    /**
+     * @brief Device key of the transmitter: the key of its cluster for probe requests
+     *        from randomized MACs, macToKey(addr2) otherwise
+     * @note A cluster is keyed by its first MAC, so rows keyed by it collect the
+     *       frames of every MAC it gathered.
+     */
+    uint64_t resolve(const GuardianFrame &frame);
+
+    uint32_t clusters() const { return _clusters; } // clusters started
+    uint32_t merged() const { return _merged; }     // random MACs folded into an existing cluster
+
+private:
+    struct Cluster {
+        uint64_t key;     // first MAC
+        uint64_t lastMac; // MAC of the latest probe
+        uint32_t fingerprint; // 0 = empty way
+        uint32_t lastSeen;
+        uint16_t lastSeq;
+    };
+
+    Cluster *_table = nullptr; // PROBE_CLUSTER_SETS sets of PROBE_CLUSTER_WAYS
+    uint32_t _clusters = 0;
+    uint32_t _merged = 0;
+};
+
+#endif
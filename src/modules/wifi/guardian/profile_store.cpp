@@ -0,0 +1,141 @@
+#include "profile_store.h"
+#include "core/sd_functions.h"
+#include "ssid_matcher.h"
+#include <ArduinoJson.h>
+
+static bool profilesLoaded = false;
+
+static bool readProfiles(FS &fs, JsonDocument &doc) {
+    File file = fs.open(DETECTION_PROFILES_FILE, FILE_READ);
+    if (!file) return false;
+    DeserializationError err = deserializeJson(doc, file);
+    file.close();
+    if (err) {
+        Serial.printf("[GUARDIAN] %s: %s\n", DETECTION_PROFILES_FILE, err.c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool writeProfiles(FS &fs, const JsonDocument &doc) {
+    File file = fs.open(DETECTION_PROFILES_FILE, FILE_WRITE);
+    if (!file) return false;
+    const bool ok = serializeJsonPretty(doc, file) > 0;
+    file.close();
+    return ok;
+}
+
+// The built-in profiles without overrides, so they follow the firmware's values
+// until the user sets some ("guardian profile" prints them in full)
+static void defaultProfiles(JsonDocument &doc) {
+    doc["active"] = "home";
+    JsonObject profiles = doc["profiles"].to<JsonObject>();
+    for (size_t i = 0; i < detectionProfileBuiltinCount(); i++) {
+        profiles[detectionProfileBuiltinName(i)].to<JsonObject>();
+    }
+}
+
+// Opens the file, creating it from the built-in profiles when missing
+static bool openProfiles(FS *&fs, JsonDocument &doc) {
+    if (!getFsStorage(fs)) {
+        fs = nullptr;
+        defaultProfiles(doc);
+        return true;
+    }
+    if (fs->exists(DETECTION_PROFILES_FILE)) return readProfiles(*fs, doc);
+
+    defaultProfiles(doc);
+    if (!writeProfiles(*fs, doc)) Serial.println("[GUARDIAN] Failed to write " DETECTION_PROFILES_FILE);
+    return true;
+}
+
+static bool compileProfile(const JsonDocument &doc, const char *name, DetectionProfile &out) {
+    JsonObjectConst json = doc["profiles"][name].as<JsonObjectConst>();
+    if (!detectionProfileBuiltin(name, out) && json.isNull()) return false;
+
+    for (JsonPairConst kv : json) {
+        if (!kv.value().is<uint32_t>()) {
+            Serial.printf("[GUARDIAN] Profile %s: \"%s\" must be a non-negative integer\n", name, kv.key().c_str());
+        } else if (!detectionProfileSet(out, kv.key().c_str(), kv.value().as<uint32_t>())) {
+            Serial.printf("[GUARDIAN] Profile %s: unknown threshold \"%s\"\n", name, kv.key().c_str());
+        }
+    }
+    if (out.attackScore == 0) out.attackScore = 1; // 0 would confirm every device
+    return true;
+}
+
+// User signatures, added to the built-in ones of ssid_signatures.txt
+static void loadSignatures(const JsonDocument &doc) {
+    std::vector<SsidSignature> signatures;
+    for (JsonPairConst kv : doc["signatures"].as<JsonObjectConst>()) {
+        const uint8_t kind = ssidSignatureKindFind(kv.key().c_str());
+        if (kind == SSID_SIGNATURE_KINDS) {
+            Serial.printf("[GUARDIAN] Unknown signature kind \"%s\"\n", kv.key().c_str());
+            continue;
+        }
+        for (JsonVariantConst pattern : kv.value().as<JsonArrayConst>()) {
+            const char *text = pattern.as<const char *>();
+            if (!text || !*text || strlen(text) > SSID_SIGNATURE_MAX_LEN) {
+                Serial.printf("[GUARDIAN] Signatures %s: patterns must be 1-%d characters\n", kv.key().c_str(),
+                              SSID_SIGNATURE_MAX_LEN);
+                continue;
+            }
+            signatures.push_back({text, kind});
+        }
+    }
+    // Copied and built later by the scanning task (ssidSignaturesApply()), doc may go away after this
+    if (!ssidSignaturesUse(signatures.data(), signatures.size())) {
+        Serial.println("[GUARDIAN] Not enough memory for the user signatures");
+    } else if (!signatures.empty()) {
+        Serial.printf("[GUARDIAN] %u user SSID signatures\n", (unsigned)signatures.size());
+    }
+}
+
+bool detectionProfilesLoad(const char *name) {
+    FS *fs;
+    JsonDocument doc;
+    if (!openProfiles(fs, doc)) return false;
+    profilesLoaded = true;
+    loadSignatures(doc);
+
+    const String wanted = name ? String(name) : doc["active"] | "home";
+    DetectionProfile profile;
+    if (!compileProfile(doc, wanted.c_str(), profile)) {
+        Serial.printf("[GUARDIAN] No detection profile \"%s\"\n", wanted.c_str());
+        return false;
+    }
+    detectionProfileActivate(profile);
+    Serial.printf("[GUARDIAN] Detection profile: %s\n", profile.name);
+    return true;
+}
+
+void detectionProfilesBegin() {
+    if (!profilesLoaded) detectionProfilesLoad();
+}
+
+bool detectionProfileSelect(const char *name) {
+    if (!detectionProfilesLoad(name)) return false;
+
+    FS *fs;
+    JsonDocument doc;
+    if (!openProfiles(fs, doc) || !fs) return true; // active for this session only
+    doc["active"] = name;
+    if (!writeProfiles(*fs, doc)) Serial.println("[GUARDIAN] Failed to write " DETECTION_PROFILES_FILE);
+    return true;
+}
+
+std::vector<String> detectionProfileNames() {
+    std::vector<String> names;
+    FS *fs;
+    JsonDocument doc;
+    if (openProfiles(fs, doc)) {
+        for (JsonPairConst kv : doc["profiles"].as<JsonObjectConst>()) names.push_back(kv.key().c_str());
+    }
+    for (size_t i = 0; i < detectionProfileBuiltinCount(); i++) {
+        const String builtin = detectionProfileBuiltinName(i);
+        bool listed = false;
+        for (const String &n : names) listed |= n == builtin;
+        if (!listed) names.push_back(builtin);
+    }
+    return names;
+}
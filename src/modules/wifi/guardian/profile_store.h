@@ -0,0 +1,44 @@
+#ifndef __GUARDIAN_PROFILE_STORE_H__
+#define __GUARDIAN_PROFILE_STORE_H__
+
+#include "detection_profile.h"
+#include <Arduino.h>
+#include <vector>
+
+// Detection profiles on flash, next to /bruce.conf (SD card, LittleFS without one):
+//   {"active": "home",
+//    "profiles": {"home": {"beacon spam": 15, ...}, "stadium": {...}, "my venue": {...}},
+//    "signatures": {"rogue": ["airport"], "skimmer": ["cashpoint"]}}
+// A profile lists only the thresholds it changes: the rest come from the built-in
+// profile of the same name, or "home". JSON is only read here, when a profile is
+// loaded, the engine gets the compiled DetectionProfile. A new file lists the
+// built-in profiles with nothing changed, so a firmware update still retunes
+// them. The optional "signatures" are SSID patterns added to the built-in ones
+// of ssid_matcher.h on every load.
+
+#define DETECTION_PROFILES_FILE "/bruce_guardian.json"
+
+/**
+ * @brief Compiles the profile name (the file's active one if nullptr) and activates it
+ * @note Writes the file with the built-in profiles when there is none, also loads the
+ *       user SSID signatures
+ * @return false if the file is unreadable or has no such profile, the active profile is kept
+ */
+bool detectionProfilesLoad(const char *name = nullptr);
+
+/**
+ * @brief detectionProfilesLoad() once, later calls do nothing
+ */
+void detectionProfilesBegin();
+
+/**
+ * @brief Activates name and makes it the file's active profile
+ */
+bool detectionProfileSelect(const char *name);
+
+/**
+ * @brief Profiles of the file, then the built-in ones it does not override
+ */
+std::vector<String> detectionProfileNames();
+
+#endif
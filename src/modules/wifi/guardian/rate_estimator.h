@@ -0,0 +1,50 @@
+#ifndef __GUARDIAN_RATE_ESTIMATOR_H__
+#define __GUARDIAN_RATE_ESTIMATOR_H__
+
+#include <stdint.h>
+
+// Exponentially decaying event rate, in Q16.16 events per second.
+// Every event adds RATE_EVENT_Q16 and the value halves every RATE_HALF_LIFE_MS,
+// so a steady stream of N events/s converges to N with no window boundaries.
+// Updates cost shifts, a table lookup and two multiplies, no divisions.
+
+#define RATE_HALF_LIFE_SHIFT 10                      // half-life of 2^10 ms
+#define RATE_HALF_LIFE_MS (1u << RATE_HALF_LIFE_SHIFT)
+#define RATE_EVENT_Q16 44361                         // 1000 * ln2 / RATE_HALF_LIFE_MS, in Q16
+#define RATE_ONE_Q16 65536
+#define RATE_FINE_STEP_Q16 44                        // ln2 / RATE_HALF_LIFE_MS, decay per ms in Q16
+
+// 2^(-k/64) in Q16, k in 1/64 of a half-life (16 ms steps)
+static const uint32_t RATE_DECAY_Q16[64] = {
+    65536, 64830, 64132, 63441, 62757, 62081, 61413, 60751,
+    60097, 59449, 58809, 58176, 57549, 56929, 56316, 55709,
+    55109, 54515, 53928, 53347, 52773, 52204, 51642, 51085,
+    50535, 49991, 49452, 48920, 48393, 47871, 47356, 46846,
+    46341, 45842, 45348, 44859, 44376, 43898, 43425, 42958,
+    42495, 42037, 41584, 41136, 40693, 40255, 39821, 39392,
+    38968, 38548, 38133, 37722, 37316, 36914, 36516, 36123,
+    35734, 35349, 34968, 34591, 34219, 33850, 33486, 33125,
+};
+
+/**
+ * @brief Decays a rate by dtMs of silence
+ */
+inline uint32_t rateDecay(uint32_t rate, uint32_t dtMs) {
+    const uint32_t halves = dtMs >> RATE_HALF_LIFE_SHIFT;
+    if (halves >= 32) return 0;
+    rate >>= halves;
+    const uint32_t step = (dtMs >> (RATE_HALF_LIFE_SHIFT - 6)) & 63;
+    // 2^(-x/1024) ~ 1 - x * ln2 / 1024 for the last x < 16 ms, so short gaps still decay
+    const uint32_t fine = RATE_ONE_Q16 - RATE_FINE_STEP_Q16 * (dtMs & 15);
+    rate = (uint32_t)(((uint64_t)rate * RATE_DECAY_Q16[step]) >> 16);
+    return (uint32_t)(((uint64_t)rate * fine) >> 16);
+}
+
+/**
+ * @brief Accounts one event dtMs after the previous update
+ */
+inline uint32_t rateEvent(uint32_t rate, uint32_t dtMs) { return rateDecay(rate, dtMs) + RATE_EVENT_Q16; }
+
+inline float rateToFloat(uint32_t rate) { return rate * (1.0f / RATE_ONE_Q16); }
+
+#endif
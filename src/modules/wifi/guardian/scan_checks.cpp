@@ -0,0 +1,70 @@
+#include "scan_checks.h"
+#include <string.h>
+
+size_t scanCheckRogueAps(const ScanSnapshot &snapshot, const SsidMatcher &signatures, ScanFindingHandler onFinding) {
+    size_t findings = 0;
+    for (uint16_t i = 0; i < snapshot.count; i++) {
+        const ScanAp &ap = snapshot.aps[i];
+        const uint16_t signature = signatures.find(ap.ssid, ap.ssidLen, ssidSignatureKindMask(SSID_SIGNATURE_ROGUE));
+        if (signature == SSID_SIGNATURE_NONE) continue;
+        ScanFinding finding = {i, THREAT_ROGUE_AP, ROGUE_SSID_CONFIDENCE, signature};
+        if (onFinding) onFinding(snapshot, finding);
+        findings++;
+    }
+    return findings;
+}
+
+uint8_t scanAuthRank(uint8_t authmode) {
+    switch (authmode) {
+        case SCAN_AUTH_OPEN: return 0;
+        case SCAN_AUTH_WEP: return 1;
+        case SCAN_AUTH_OWE: return 2; // encrypted, not authenticated
+        case SCAN_AUTH_WPA_PSK: return 3;
+        case SCAN_AUTH_WPA_WPA2_PSK: return 4;
+        case SCAN_AUTH_WPA2_PSK:
+        case SCAN_AUTH_WAPI_PSK: return 5;
+        case SCAN_AUTH_WPA2_ENTERPRISE:
+        case SCAN_AUTH_WPA2_WPA3_PSK: return 6;
+        case SCAN_AUTH_WPA3_PSK: return 7;
+        case SCAN_AUTH_WPA3_ENT_192: return 8;
+        default: return SCAN_AUTH_RANK_UNKNOWN;
+    }
+}
+
+size_t scanCheckEvilTwins(const ScanSnapshot &snapshot, ScanFindingHandler onFinding) {
+    size_t findings = 0;
+    for (uint16_t i = 0; i < snapshot.count; i++) {
+        const ScanAp &ap = snapshot.aps[i];
+        const uint8_t rank = scanAuthRank(ap.authmode);
+        if (ap.ssidLen == 0 || rank == SCAN_AUTH_RANK_UNKNOWN) continue;
+
+        uint16_t same = 0;
+        uint8_t strongest = 0;
+        for (uint16_t j = 0; j < snapshot.count; j++) {
+            const ScanAp &other = snapshot.aps[j];
+            if (other.ssidLen != ap.ssidLen || memcmp(other.ssid, ap.ssid, ap.ssidLen) != 0) continue;
+            same++;
+            const uint8_t otherRank = scanAuthRank(other.authmode);
+            if (otherRank != SCAN_AUTH_RANK_UNKNOWN && otherRank > strongest) strongest = otherRank;
+        }
+        if (same < 2 || rank >= strongest) continue;
+
+        ScanFinding finding = {i, THREAT_EVIL_TWIN, EVIL_TWIN_CONFIDENCE, same};
+        if (onFinding) onFinding(snapshot, finding);
+        findings++;
+    }
+    return findings;
+}
+
+size_t scanCheckLookalikes(const ScanSnapshot &snapshot, const SsidTrustList &trusted, ScanFindingHandler onFinding) {
+    size_t findings = 0;
+    for (uint16_t i = 0; i < snapshot.count; i++) {
+        const ScanAp &ap = snapshot.aps[i];
+        const uint8_t imitated = trusted.lookalike(ap.ssid, ap.ssidLen);
+        if (imitated == SSID_LOOKALIKE_NONE) continue;
+        ScanFinding finding = {i, THREAT_EVIL_TWIN, LOOKALIKE_CONFIDENCE, imitated};
+        if (onFinding) onFinding(snapshot, finding);
+        findings++;
+    }
+    return findings;
+}
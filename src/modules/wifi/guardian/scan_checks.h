@@ -0,0 +1,74 @@
+#ifndef __GUARDIAN_SCAN_CHECKS_H__
+#define __GUARDIAN_SCAN_CHECKS_H__
+
+#include "scan_snapshot.h"
+#include "ssid_lookalike.h"
+#include "ssid_matcher.h"
+#include "threat_engine.h"
+
+// Passive checks over one access point scan.
+// Pure functions of the snapshot: no radio, no globals, so they run on a host.
+
+#define ROGUE_SSID_CONFIDENCE 0.6f // generic hotspot name, a rogue signature of ssid_matcher.h
+#define EVIL_TWIN_CONFIDENCE 0.7f  // SSID advertised by several BSSIDs
+#define LOOKALIKE_CONFIDENCE 0.75f // SSID imitating a trusted one
+
+// wifi_auth_mode_t of the ESP-IDF 4.4 the Arduino core ships, kept here so the checks build on a host
+enum ScanAuthMode {
+    SCAN_AUTH_OPEN,
+    SCAN_AUTH_WEP,
+    SCAN_AUTH_WPA_PSK,
+    SCAN_AUTH_WPA2_PSK,
+    SCAN_AUTH_WPA_WPA2_PSK,
+    SCAN_AUTH_WPA2_ENTERPRISE,
+    SCAN_AUTH_WPA3_PSK,
+    SCAN_AUTH_WPA2_WPA3_PSK,
+    SCAN_AUTH_WAPI_PSK,
+    SCAN_AUTH_OWE,
+    SCAN_AUTH_WPA3_ENT_192
+};
+
+#define SCAN_AUTH_RANK_UNKNOWN 0xFF
+
+struct ScanFinding {
+    uint16_t ap; // index into snapshot.aps
+    ThreatType type;
+    float confidence;
+    uint16_t related; // APs sharing the SSID for evil twins, the index into signatures for rogue APs,
+                      // the trusted SSID for lookalikes
+};
+
+typedef void (*ScanFindingHandler)(const ScanSnapshot &snapshot, const ScanFinding &finding);
+
+/**
+ * @brief Reports APs whose SSID matches a rogue signature of signatures (ssidSignatures() on the device)
+ * @return number of findings
+ */
+size_t scanCheckRogueAps(const ScanSnapshot &snapshot, const SsidMatcher &signatures, ScanFindingHandler onFinding);
+
+/**
+ * @brief Strength of an auth mode, for comparing the APs of one SSID
+ * @note The enum values are not in order of strength: OPEN < WEP < OWE < WPA <
+ *       WPA/WPA2 < WPA2 = WAPI < WPA2-Enterprise = WPA2/WPA3 < WPA3 < WPA3-Enterprise 192.
+ *       A WPA2/WPA3 transition AP still accepts WPA2 clients, so it ranks below WPA3 only.
+ * @return SCAN_AUTH_RANK_UNKNOWN for modes of a newer IDF, never compared
+ */
+uint8_t scanAuthRank(uint8_t authmode);
+
+/**
+ * @brief Reports APs advertising an SSID with weaker security than another BSSID of it
+ * @note Several BSSIDs per SSID alone is normal (mesh, enterprise), the beacon
+ *       fingerprints of the live monitor (evil_twin.h) tell those apart; a scan
+ *       only has the auth mode, so only a downgrade is reported here.
+ *       Hidden networks are skipped, they all share the empty SSID.
+ * @return number of findings
+ */
+size_t scanCheckEvilTwins(const ScanSnapshot &snapshot, ScanFindingHandler onFinding);
+
+/**
+ * @brief Reports APs whose SSID imitates one of trusted without being it (ssid_lookalike.h)
+ * @return number of findings
+ */
+size_t scanCheckLookalikes(const ScanSnapshot &snapshot, const SsidTrustList &trusted, ScanFindingHandler onFinding);
+
+#endif
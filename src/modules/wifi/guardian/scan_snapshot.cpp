@@ -0,0 +1,79 @@
+#include "scan_snapshot.h"
+#include "guardian_alloc.h"
+#include <WiFi.h>
+#include <string.h>
+
+static ScanSnapshot *buffers = nullptr; // two snapshots, the published one and the one being filled
+static volatile uint8_t published = 0;
+static uint32_t version = 0;
+static uint32_t interval = SCAN_SNAPSHOT_INTERVAL_MS;
+static uint32_t lastScanEnd = 0;
+static bool scanning = false;
+static bool started = false;
+
+bool scanSnapshotBegin(uint32_t intervalMs) {
+    scanSnapshotEnd();
+    buffers = (ScanSnapshot *)guardianAlloc(2 * sizeof(ScanSnapshot));
+    if (!buffers) return false;
+    buffers[0].version = 0;
+    buffers[0].count = 0;
+    published = 0;
+    version = 0;
+    interval = intervalMs;
+    scanning = false;
+    started = false;
+    return true;
+}
+
+void scanSnapshotEnd() {
+    if (scanning) WiFi.scanDelete(); // the driver keeps scanning, its results are dropped
+    scanning = false;
+    free(buffers);
+    buffers = nullptr;
+}
+
+bool scanSnapshotPoll() {
+    if (!buffers) return false;
+
+    if (!scanning) {
+        if (started && millis() - lastScanEnd < interval) return false;
+        if (WiFi.scanNetworks(true) != WIFI_SCAN_RUNNING) return false; // retried on the next poll
+        scanning = true;
+        started = true;
+        return false;
+    }
+
+    const int16_t found = WiFi.scanComplete();
+    if (found == WIFI_SCAN_RUNNING) return false;
+    scanning = false;
+    lastScanEnd = millis();
+    if (found < 0) return false; // WIFI_SCAN_FAILED
+
+    // Fill the buffer readers are not looking at, then publish it
+    ScanSnapshot *snap = &buffers[published ^ 1];
+    snap->found = found;
+    snap->count = found < SCAN_SNAPSHOT_MAX_APS ? found : SCAN_SNAPSHOT_MAX_APS;
+    for (uint16_t i = 0; i < snap->count; i++) {
+        const wifi_ap_record_t *rec = (const wifi_ap_record_t *)WiFi.getScanInfoByIndex(i);
+        ScanAp &ap = snap->aps[i];
+        memcpy(ap.bssid, rec->bssid, 6);
+        ap.rssi = rec->rssi;
+        ap.channel = rec->primary;
+        ap.authmode = rec->authmode;
+        ap.ssidLen = strnlen((const char *)rec->ssid, 32);
+        memcpy(ap.ssid, rec->ssid, ap.ssidLen);
+        ap.ssid[ap.ssidLen] = '\0';
+    }
+    WiFi.scanDelete();
+
+    snap->version = ++version;
+    snap->takenAt = lastScanEnd;
+    published ^= 1;
+    return true;
+}
+
+const ScanSnapshot *scanSnapshotLatest() {
+    if (!buffers) return nullptr;
+    const ScanSnapshot *snap = &buffers[published];
+    return snap->version ? snap : nullptr;
+}
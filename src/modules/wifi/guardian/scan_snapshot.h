@@ -0,0 +1,56 @@
+#ifndef __GUARDIAN_SCAN_SNAPSHOT_H__
+#define __GUARDIAN_SCAN_SNAPSHOT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Access point scan shared by the passive Defense checks.
+// One asynchronous WiFi.scanNetworks(true) runs in the background and each
+// completed scan is published as an immutable, versioned snapshot, so every
+// check reads the same result and the monitor loop never blocks on the radio.
+
+#define SCAN_SNAPSHOT_MAX_APS 64        // APs kept per scan, strongest first as reported by the driver
+#define SCAN_SNAPSHOT_INTERVAL_MS 5000  // idle time between the end of a scan and the next one
+
+struct ScanAp {
+    uint8_t bssid[6];
+    int8_t rssi;
+    uint8_t channel;
+    uint8_t authmode; // wifi_auth_mode_t, 0 = open
+    uint8_t ssidLen;  // 0 for hidden networks
+    char ssid[33];    // NUL terminated
+};
+
+struct ScanSnapshot {
+    uint32_t version; // increments with every published scan, 0 = none yet
+    uint32_t takenAt; // millis() when the scan completed
+    uint16_t found;   // APs reported by the scan, may exceed count
+    uint16_t count;   // APs kept in aps
+    ScanAp aps[SCAN_SNAPSHOT_MAX_APS];
+};
+
+/**
+ * @brief Allocates the snapshot buffers, the first scan starts on the next poll
+ * @return false if the allocation failed
+ */
+bool scanSnapshotBegin(uint32_t intervalMs = SCAN_SNAPSHOT_INTERVAL_MS);
+
+/**
+ * @brief Drops the pending scan and frees the buffers
+ */
+void scanSnapshotEnd();
+
+/**
+ * @brief Starts a scan when one is due and publishes it once complete, never blocks
+ * @return true when a new snapshot was published by this call
+ */
+bool scanSnapshotPoll();
+
+/**
+ * @brief Latest published scan, nullptr before the first one completes
+ * @note Stays valid and unchanged until the second scanSnapshotPoll() that
+ *       publishes after it, i.e. for at least a full scan interval.
+ */
+const ScanSnapshot *scanSnapshotLatest();
+
+#endif
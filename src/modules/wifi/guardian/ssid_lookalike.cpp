@@ -0,0 +1,178 @@
+#include "ssid_lookalike.h"
+#include <string.h>
+
+// Two byte UTF-8 Cyrillic letters drawn like Latin ones, upper and lower case
+static const struct {
+    uint8_t lead, trail;
+    uint8_t latin;
+} cyrillic[] = {
+    {0xD0, 0x90, 'a'}, {0xD0, 0x92, 'b'}, {0xD0, 0x95, 'e'}, {0xD0, 0x9A, 'k'}, {0xD0, 0x9C, 'm'},
+    {0xD0, 0x9D, 'h'}, {0xD0, 0x9E, 'o'}, {0xD0, 0xA0, 'p'}, {0xD0, 0xA1, 'c'}, {0xD0, 0xA2, 't'},
+    {0xD0, 0xA5, 'x'}, {0xD0, 0xB0, 'a'}, {0xD0, 0xB5, 'e'}, {0xD0, 0xBE, 'o'}, {0xD1, 0x80, 'p'},
+    {0xD1, 0x81, 'c'}, {0xD1, 0x83, 'y'}, {0xD1, 0x85, 'x'},
+};
+
+// Band suffixes of dual band routers, "Home-5G" is still "Home"
+static const char *const bandSuffixes[] = {"5ghz", "24ghz", "5g", "24g", "2g"};
+
+static bool separator(uint8_t c) { return c == ' ' || c == '-' || c == '_' || c == '.' || c == '\''; }
+
+static uint8_t homoglyph(uint8_t c) {
+    switch (c) {
+        case '0': return 'o';
+        case '1':
+        case 'i':
+        case '!':
+        case '|': return 'l';
+        case '3': return 'e';
+        case '4':
+        case '@': return 'a';
+        case '5':
+        case '$': return 's';
+        case '7': return 't';
+        default: return c;
+    }
+}
+
+size_t ssidNormalize(const char *ssid, size_t len, uint8_t *out) {
+    // Lower case without separators, Cyrillic lookalikes as Latin
+    size_t n = 0;
+    for (size_t i = 0; i < len && n < SSID_LOOKALIKE_MAX_LEN; i++) {
+        uint8_t c = ssid[i];
+        if (separator(c)) continue;
+        if ((c == 0xD0 || c == 0xD1) && i + 1 < len) {
+            const uint8_t trail = ssid[i + 1];
+            for (size_t k = 0; k < sizeof(cyrillic) / sizeof(cyrillic[0]); k++) {
+                if (cyrillic[k].lead == c && cyrillic[k].trail == trail) {
+                    c = cyrillic[k].latin;
+                    i++;
+                    break;
+                }
+            }
+        }
+        out[n++] = c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+    }
+
+    // Before the homoglyphs, which would turn "5g" into "sg"
+    for (size_t k = 0; k < sizeof(bandSuffixes) / sizeof(bandSuffixes[0]); k++) {
+        const size_t s = strlen(bandSuffixes[k]);
+        if (n > s && memcmp(out + n - s, bandSuffixes[k], s) == 0) {
+            n -= s;
+            break;
+        }
+    }
+
+    // Homoglyphs, "rn" reads as "m" and "vv" as "w"
+    size_t w = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (i + 1 < n && out[i] == 'r' && out[i + 1] == 'n') {
+            out[w++] = 'm';
+            i++;
+        } else if (i + 1 < n && out[i] == 'v' && out[i + 1] == 'v') {
+            out[w++] = 'w';
+            i++;
+        } else {
+            out[w++] = homoglyph(out[i]);
+        }
+    }
+    return w;
+}
+
+size_t ssidBandStem(const char *ssid, size_t len) {
+    for (size_t k = 0; k < sizeof(bandSuffixes) / sizeof(bandSuffixes[0]); k++) {
+        // Matched from the end, case and separators ignored as in ssidNormalize()
+        const char *suffix = bandSuffixes[k];
+        size_t s = strlen(suffix), i = len;
+        while (s > 0 && i > 0) {
+            uint8_t c = ssid[i - 1];
+            if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+            if (separator(c) && i < len) {
+                i--;
+            } else if (c == (uint8_t)suffix[s - 1]) {
+                i--;
+                s--;
+            } else {
+                break;
+            }
+        }
+        if (s > 0) continue;
+        while (i > 0 && separator(ssid[i - 1])) i--;
+        if (i > 0) return i;
+    }
+    return len;
+}
+
+// Myers/Hyyrö: bit i of the vertical delta vectors is the column of pattern byte i,
+// peq[c] has the bits of the pattern bytes equal to c
+static uint8_t myers(const uint32_t *peq, size_t m, const uint8_t *text, size_t n) {
+    if (m == 0) return n < 0xFF ? n : 0xFF;
+    const uint32_t last = 1u << (m - 1);
+    uint32_t pv = ~0u, mv = 0;
+    size_t score = m;
+    for (size_t j = 0; j < n; j++) {
+        const uint32_t eq = peq[text[j]];
+        const uint32_t xv = eq | mv;
+        const uint32_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint32_t ph = mv | ~(xh | pv);
+        uint32_t mh = pv & xh;
+        if (ph & last) score++;
+        else if (mh & last) score--;
+        ph = (ph << 1) | 1; // the first row counts insertions
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+    }
+    return score < 0xFF ? score : 0xFF;
+}
+
+uint8_t ssidEditDistance(const uint8_t *a, size_t alen, const uint8_t *b, size_t blen) {
+    uint32_t peq[256] = {};
+    for (size_t i = 0; i < alen; i++) peq[a[i]] |= 1u << i;
+    return myers(peq, alen, b, blen);
+}
+
+bool SsidTrustList::add(const char *ssid, size_t len) {
+    if (len == 0 || len > SSID_LOOKALIKE_MAX_LEN || _count == SSID_TRUST_CAPACITY) return false;
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_entries[i].len == len && memcmp(_entries[i].ssid, ssid, len) == 0) return false;
+    }
+    Entry &e = _entries[_count++];
+    memcpy(e.ssid, ssid, len);
+    e.ssid[len] = '\0';
+    e.len = len;
+    e.stemLen = ssidBandStem(ssid, len);
+    e.normalizedLen = ssidNormalize(ssid, len, e.normalized);
+    return true;
+}
+
+uint8_t SsidTrustList::lookalike(const char *ssid, size_t len, uint8_t *distance) const {
+    // The trusted network itself, or its other band: only the suffix may differ, to the byte
+    const size_t stem = ssidBandStem(ssid, len);
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_entries[i].stemLen == stem && memcmp(_entries[i].ssid, ssid, stem) == 0) return SSID_LOOKALIKE_NONE;
+    }
+    uint8_t normalized[SSID_LOOKALIKE_MAX_LEN];
+    const size_t m = ssidNormalize(ssid, len, normalized);
+    if (m == 0) return SSID_LOOKALIKE_NONE;
+
+    // The candidate is the pattern, so its bit masks serve every trusted SSID
+    uint32_t peq[256] = {};
+    for (size_t i = 0; i < m; i++) peq[normalized[i]] |= 1u << i;
+
+    uint8_t best = SSID_LOOKALIKE_NONE, bestDistance = 0xFF;
+    for (uint8_t i = 0; i < _count; i++) {
+        const Entry &e = _entries[i];
+        if (e.normalizedLen == 0) continue;
+        const uint8_t limit = ssidLookalikeMaxDistance(e.normalizedLen);
+        const size_t gap = m > e.normalizedLen ? m - e.normalizedLen : e.normalizedLen - m;
+        if (gap > limit || gap >= bestDistance) continue; // the distance is at least the length gap
+
+        const uint8_t d = myers(peq, m, e.normalized, e.normalizedLen);
+        if (d <= limit && d < bestDistance) {
+            best = i;
+            bestDistance = d;
+        }
+    }
+    if (best != SSID_LOOKALIKE_NONE && distance) *distance = bestDistance;
+    return best;
+}
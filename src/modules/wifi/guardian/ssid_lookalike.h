@@ -0,0 +1,76 @@
+#ifndef __GUARDIAN_SSID_LOOKALIKE_H__
+#define __GUARDIAN_SSID_LOOKALIKE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Typosquat check: SSIDs imitating a trusted one ("H0me-WiFi" for "HomeWiFi").
+// Both names are normalized first (case, separators, band suffixes, homoglyphs
+// such as 0/O, 1/l, Cyrillic letters) and then compared with Myers' bit-parallel
+// edit distance: a normalized SSID fits one 32 bit word, so a comparison is one
+// pass of a few word operations per byte, with no allocation.
+// An SSID identical to a trusted one is that network, never a lookalike, and so
+// is one that only adds or changes a band suffix ("HomeWiFi_5G" for "HomeWiFi").
+
+#define SSID_LOOKALIKE_MAX_LEN 32  // bytes of a normalized SSID, the longest SSID
+#define SSID_TRUST_CAPACITY 32     // trusted SSIDs kept, later ones are dropped
+#define SSID_LOOKALIKE_NONE 0xFF
+
+/**
+ * @brief Normalized form of an SSID: lower case, no separators or band suffix, homoglyphs folded
+ * @param out room for SSID_LOOKALIKE_MAX_LEN bytes, not NUL terminated
+ * @return length of out
+ */
+size_t ssidNormalize(const char *ssid, size_t len, uint8_t *out);
+
+/**
+ * @brief Length of ssid without a trailing band suffix ("-5G", " 2.4GHz") and its separators
+ * @return len if there is none
+ */
+size_t ssidBandStem(const char *ssid, size_t len);
+
+/**
+ * @brief Edits allowed between normalized SSIDs, by the trusted one's length
+ * @note Short names only match through normalization, one edit would hit unrelated ones
+ */
+inline uint8_t ssidLookalikeMaxDistance(size_t len) { return len <= 4 ? 0 : len <= 8 ? 1 : 2; }
+
+/**
+ * @brief Levenshtein distance of two byte strings, a no longer than 32 bytes (Myers)
+ */
+uint8_t ssidEditDistance(const uint8_t *a, size_t alen, const uint8_t *b, size_t blen);
+
+class SsidTrustList {
+public:
+    void clear() { _count = 0; }
+
+    /**
+     * @brief Adds a trusted SSID
+     * @return false if it is empty, already listed or the list is full
+     */
+    bool add(const char *ssid, size_t len);
+
+    /**
+     * @brief Trusted SSID that ssid imitates, the nearest if several
+     * @param distance set to the edit distance of the normalized names when found
+     * @return index of the trusted SSID, SSID_LOOKALIKE_NONE if none
+     */
+    uint8_t lookalike(const char *ssid, size_t len, uint8_t *distance = nullptr) const;
+
+    const char *ssid(uint8_t i) const { return _entries[i].ssid; }
+    uint8_t size() const { return _count; }
+
+private:
+    struct Entry {
+        char ssid[SSID_LOOKALIKE_MAX_LEN + 1];
+        uint8_t len;
+        uint8_t stemLen; // len without a band suffix, see ssidBandStem()
+        uint8_t normalized[SSID_LOOKALIKE_MAX_LEN];
+        uint8_t normalizedLen;
+    };
+
+    Entry _entries[SSID_TRUST_CAPACITY];
+    uint8_t _count = 0;
+};
+
+#endif
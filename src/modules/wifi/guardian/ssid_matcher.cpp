@@ -0,0 +1,217 @@
+#include "ssid_matcher.h"
+#include "guardian_alloc.h"
+#include "ssid_signatures.h"
+#include <atomic>
+#include <string.h>
+
+static const char *const kindNames[SSID_SIGNATURE_KINDS] = {"rogue", "skimmer"}; // as in ssid_signatures.txt
+
+// Carves one table out of the block, keeping every table 8 byte aligned
+template <typename T> static T *table(uint8_t *block, size_t &offset, size_t count) {
+    T *t = block ? (T *)(block + offset) : nullptr;
+    offset += (count * sizeof(T) + 7) & ~(size_t)7;
+    return t;
+}
+
+bool SsidMatcher::build(const SsidSignature *signatures, size_t count) {
+    size_t bound = 1, text = 0, kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        const size_t len = signatures[i].pattern ? strlen(signatures[i].pattern) : 0;
+        if (len == 0 || len > SSID_SIGNATURE_MAX_LEN) continue;
+        bound += len;
+        text += len + 1;
+        kept++;
+    }
+    if (kept >= SSID_SIGNATURE_NONE) return false;
+    if (bound > UINT16_MAX) bound = UINT16_MAX; // checked while inserting
+
+    // One allocation for all tables, sized by a first pass without a block
+    uint8_t *block = nullptr;
+    uint16_t *root = nullptr, *child = nullptr, *sibling = nullptr, *fail = nullptr, *output = nullptr, *sig = nullptr;
+    uint8_t *label = nullptr;
+    SsidSignature *sigs = nullptr;
+    char *strings = nullptr;
+    for (int pass = 0; pass < 2; pass++) {
+        size_t off = 0;
+        root = table<uint16_t>(block, off, 256);
+        child = table<uint16_t>(block, off, bound);
+        sibling = table<uint16_t>(block, off, bound);
+        fail = table<uint16_t>(block, off, bound);
+        output = table<uint16_t>(block, off, bound);
+        sig = table<uint16_t>(block, off, bound);
+        label = table<uint8_t>(block, off, bound);
+        sigs = table<SsidSignature>(block, off, kept);
+        strings = table<char>(block, off, text);
+        if (pass == 0) {
+            block = (uint8_t *)guardianAlloc(off);
+            if (!block) return false;
+            memset(block, 0, off);
+        }
+    }
+    uint16_t *queue = (uint16_t *)malloc(bound * sizeof(uint16_t));
+    if (!queue) {
+        free(block);
+        return false;
+    }
+
+    // Trie of the folded patterns, new children go first in their parent's list
+    size_t nodes = 1, n = 0;
+    for (size_t i = 0; i < count; i++) {
+        const char *pattern = signatures[i].pattern;
+        const size_t len = pattern ? strlen(pattern) : 0;
+        if (len == 0 || len > SSID_SIGNATURE_MAX_LEN) continue;
+        memcpy(strings, pattern, len + 1);
+        sigs[n].pattern = strings;
+        sigs[n].kind = signatures[i].kind;
+        strings += len + 1;
+
+        uint16_t node = 0;
+        for (size_t k = 0; k < len; k++) {
+            const uint8_t c = ssidFold(pattern[k]);
+            uint16_t next = child[node];
+            while (next && label[next] != c) next = sibling[next];
+            if (!next) {
+                if (nodes == bound) {
+                    free(queue);
+                    free(block);
+                    return false;
+                }
+                next = nodes++;
+                label[next] = c;
+                sibling[next] = child[node];
+                child[node] = next;
+            }
+            node = next;
+        }
+        if (!sig[node]) sig[node] = n + 1;
+        n++;
+    }
+
+    // Failure and output links breadth first, so a node's fail target is done before it
+    size_t head = 0, tail = 0;
+    for (uint16_t c = child[0]; c; c = sibling[c]) {
+        root[label[c]] = c;
+        queue[tail++] = c;
+    }
+    while (head < tail) {
+        const uint16_t node = queue[head++];
+        for (uint16_t c = child[node]; c; c = sibling[c]) {
+            uint16_t f = fail[node];
+            uint16_t target = 0;
+            for (;;) {
+                if (!f) {
+                    target = root[label[c]];
+                    break;
+                }
+                uint16_t e = child[f];
+                while (e && label[e] != label[c]) e = sibling[e];
+                if (e) {
+                    target = e;
+                    break;
+                }
+                f = fail[f];
+            }
+            fail[c] = target;
+            output[c] = sig[target] ? target : output[target];
+            queue[tail++] = c;
+        }
+    }
+    free(queue);
+
+    release();
+    _block = block;
+    _automaton.root = root;
+    _automaton.label = label;
+    _automaton.child = child;
+    _automaton.sibling = sibling;
+    _automaton.fail = fail;
+    _automaton.output = output;
+    _automaton.signature = sig;
+    _automaton.signatures = sigs;
+    _automaton.nodes = nodes;
+    _automaton.count = n;
+    return true;
+}
+
+void SsidMatcher::release() {
+    free(_block);
+    _block = nullptr;
+    _automaton = SsidAutomaton();
+}
+
+uint16_t SsidMatcher::find(const char *ssid, size_t len, uint32_t kinds) const {
+    if (!_automaton.nodes) return SSID_SIGNATURE_NONE;
+    const SsidAutomaton &a = _automaton;
+    uint16_t state = 0;
+    for (size_t i = 0; i < len; i++) {
+        state = step(state, ssidFold(ssid[i]));
+        // Every signature ending here: the state's own, then those of its suffixes
+        for (uint16_t o = a.signature[state] ? state : a.output[state]; o; o = a.output[o]) {
+            const uint16_t s = a.signature[o] - 1;
+            if (kinds & (1u << a.signatures[s].kind)) return s;
+        }
+    }
+    return SSID_SIGNATURE_NONE;
+}
+
+// Matchers are only built, swapped and freed by the scanning task. Other tasks hand
+// it a copy of the signatures, one malloc() holding the array and its patterns.
+struct PendingSignatures {
+    size_t count;
+    SsidSignature signatures[1]; // count of them, then the pattern strings
+};
+
+static SsidMatcher builtinMatcher(ssidBuiltinAutomaton);
+static SsidMatcher userMatcher;
+static const SsidMatcher *activeMatcher = &builtinMatcher;
+static std::atomic<PendingSignatures *> pendingSignatures(nullptr);
+
+const SsidMatcher &ssidSignatures() { return *activeMatcher; }
+
+bool ssidSignaturesUse(const SsidSignature *extra, size_t count) {
+    const size_t builtins = count ? ssidBuiltinAutomaton.count : 0;
+    size_t bytes = sizeof(PendingSignatures) + (builtins + count) * sizeof(SsidSignature);
+    for (size_t i = 0; i < count; i++) bytes += extra[i].pattern ? strlen(extra[i].pattern) + 1 : 0;
+    PendingSignatures *pending = (PendingSignatures *)malloc(bytes);
+    if (!pending) return false;
+
+    // The built-in patterns are const tables, only the user ones need copying
+    pending->count = builtins + count;
+    memcpy(pending->signatures, ssidBuiltinSignatures, builtins * sizeof(SsidSignature));
+    char *text = (char *)&pending->signatures[builtins + count];
+    for (size_t i = 0; i < count; i++) {
+        SsidSignature &sig = pending->signatures[builtins + i];
+        sig.kind = extra[i].kind;
+        sig.pattern = nullptr;
+        if (!extra[i].pattern) continue;
+        const size_t len = strlen(extra[i].pattern) + 1;
+        memcpy(text, extra[i].pattern, len);
+        sig.pattern = text;
+        text += len;
+    }
+    free(pendingSignatures.exchange(pending)); // never taken, superseded
+    return true;
+}
+
+bool ssidSignaturesApply() {
+    PendingSignatures *pending = pendingSignatures.exchange(nullptr);
+    if (!pending) return true;
+
+    bool ok = true;
+    if (pending->count == 0) {
+        activeMatcher = &builtinMatcher;
+        userMatcher.release();
+    } else if ((ok = userMatcher.build(pending->signatures, pending->count))) {
+        activeMatcher = &userMatcher;
+    }
+    free(pending);
+    return ok;
+}
+
+const char *ssidSignatureKindName(uint8_t kind) { return kind < SSID_SIGNATURE_KINDS ? kindNames[kind] : ""; }
+
+uint8_t ssidSignatureKindFind(const char *name) {
+    uint8_t kind = 0;
+    while (kind < SSID_SIGNATURE_KINDS && strcmp(kindNames[kind], name) != 0) kind++;
+    return kind;
+}
@@ -0,0 +1,127 @@
+#ifndef __GUARDIAN_SSID_MATCHER_H__
+#define __GUARDIAN_SSID_MATCHER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Multi-pattern SSID matcher (Aho-Corasick) for the signature scans.
+// All signatures share one trie with failure links, so an SSID is matched
+// against every one of them in a single pass over its bytes, ASCII case
+// insensitive and without allocating; the cost does not grow with the number
+// of signatures. Nodes are a structure of arrays: children are sibling lists
+// except at the root, which has a full table since every byte starts there.
+// The built-in signatures (ssid_signatures.txt) are compiled into const tables
+// by pre_build_ssid_signatures.py; build() makes the same tables on the heap
+// when user signatures are loaded.
+
+enum SsidSignatureKind : uint8_t {
+    SSID_SIGNATURE_ROGUE,   // generic hotspot name, rogue AP scan
+    SSID_SIGNATURE_SKIMMER, // payment or ATM name, Shark-Bait skimmer scan
+    SSID_SIGNATURE_KINDS
+};
+
+#define SSID_SIGNATURE_NONE 0xFFFF
+#define SSID_SIGNATURE_MAX_LEN 32
+
+struct SsidSignature {
+    const char *pattern; // matched anywhere in the SSID
+    uint8_t kind;        // SsidSignatureKind
+};
+
+/**
+ * @brief Tables of one automaton, node 0 is the root and 0 also means "none"
+ */
+struct SsidAutomaton {
+    const uint16_t *root;      // [256] child of the root per folded byte
+    const uint8_t *label;      // folded byte on the edge into the node
+    const uint16_t *child;     // first child
+    const uint16_t *sibling;   // next child of the same parent
+    const uint16_t *fail;      // node of the longest proper suffix
+    const uint16_t *output;    // nearest node on the fail chain that ends a signature
+    const uint16_t *signature; // 1 + index of the signature ending at the node
+    const SsidSignature *signatures;
+    uint16_t nodes;
+    uint16_t count;
+};
+
+inline uint8_t ssidFold(uint8_t c) { return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c; }
+
+class SsidMatcher {
+public:
+    SsidMatcher() {}
+    explicit SsidMatcher(const SsidAutomaton &automaton) : _automaton(automaton) {}
+    ~SsidMatcher() { release(); }
+
+    /**
+     * @brief Builds the automaton of signatures on the heap, patterns are copied
+     * @note Empty and too long patterns are skipped, a repeated pattern keeps its
+     *       first kind. The previous tables are kept if the allocation fails.
+     * @return false if the allocation failed or the signatures need over 65535 nodes
+     */
+    bool build(const SsidSignature *signatures, size_t count);
+    void release();
+
+    /**
+     * @brief First signature of one of the kinds (bit mask of 1 << kind) found in
+     *        ssid, in the order their last byte comes
+     * @return index of the signature, SSID_SIGNATURE_NONE if none matched
+     */
+    uint16_t find(const char *ssid, size_t len, uint32_t kinds = ~0u) const;
+
+    const SsidSignature &signature(uint16_t i) const { return _automaton.signatures[i]; }
+    uint16_t count() const { return _automaton.count; }
+    uint16_t nodes() const { return _automaton.nodes; }
+
+private:
+    SsidMatcher(const SsidMatcher &);
+    SsidMatcher &operator=(const SsidMatcher &);
+
+    uint16_t step(uint16_t state, uint8_t c) const {
+        const SsidAutomaton &a = _automaton;
+        while (state) {
+            for (uint16_t n = a.child[state]; n; n = a.sibling[n]) {
+                if (a.label[n] == c) return n;
+            }
+            state = a.fail[state];
+        }
+        return a.root[c];
+    }
+
+    SsidAutomaton _automaton = {};
+    void *_block = nullptr; // tables made by build()
+};
+
+/**
+ * @brief The active signatures: the built-in ones, plus user ones after ssidSignaturesApply()
+ * @note Call from the task that runs the scans (the UI loop), the reference stays valid
+ *       until that task calls ssidSignaturesApply()
+ */
+const SsidMatcher &ssidSignatures();
+
+/**
+ * @brief Queues the built-in signatures followed by extra, the built-in ones alone when
+ *        count is 0, for the next ssidSignaturesApply()
+ * @note Any task may call it (profiles are reloaded from the serial console): patterns are
+ *       copied and the matcher in use is not touched. A later call replaces a queued set.
+ * @return false if the copy could not be allocated
+ */
+bool ssidSignaturesUse(const SsidSignature *extra, size_t count);
+
+/**
+ * @brief Builds and activates the set queued by ssidSignaturesUse(), if any
+ * @note Call from the task that runs the scans, between two of them: the matcher it
+ *       replaces may be freed
+ * @return false if the tables could not be built, the active ones are kept
+ */
+bool ssidSignaturesApply();
+
+inline uint32_t ssidSignatureKindMask(SsidSignatureKind kind) { return 1u << kind; }
+
+const char *ssidSignatureKindName(uint8_t kind);
+
+/**
+ * @return the kind called name, SSID_SIGNATURE_KINDS if there is none
+ */
+uint8_t ssidSignatureKindFind(const char *name);
+
+#endif
@@ -0,0 +1,114 @@
+// Generated by pre_build_ssid_signatures.py from ssid_signatures.txt, do not edit
+#ifndef __GUARDIAN_SSID_SIGNATURES_H__
+#define __GUARDIAN_SSID_SIGNATURES_H__
+
+#include "ssid_matcher.h"
+
+static const SsidSignature ssidBuiltinSignatures[19] = {
+    {"freewifi", SSID_SIGNATURE_ROGUE},
+    {"free wifi", SSID_SIGNATURE_ROGUE},
+    {"wifi", SSID_SIGNATURE_ROGUE},
+    {"internet", SSID_SIGNATURE_ROGUE},
+    {"guest", SSID_SIGNATURE_ROGUE},
+    {"public", SSID_SIGNATURE_ROGUE},
+    {"open", SSID_SIGNATURE_ROGUE},
+    {"hotspot", SSID_SIGNATURE_ROGUE},
+    {"atm", SSID_SIGNATURE_SKIMMER},
+    {"visa", SSID_SIGNATURE_SKIMMER},
+    {"mastercard", SSID_SIGNATURE_SKIMMER},
+    {"paypal", SSID_SIGNATURE_SKIMMER},
+    {"bank", SSID_SIGNATURE_SKIMMER},
+    {"credit", SSID_SIGNATURE_SKIMMER},
+    {"payment", SSID_SIGNATURE_SKIMMER},
+    {"pos", SSID_SIGNATURE_SKIMMER},
+    {"terminal", SSID_SIGNATURE_SKIMMER},
+    {"stripe", SSID_SIGNATURE_SKIMMER},
+    {"square", SSID_SIGNATURE_SKIMMER},
+};
+
+static const uint16_t ssidBuiltinRoot[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 48, 70, 74, 0, 0, 1, 26, 41, 18, 0, 0, 0, 55, 0, 37,
+    31, 0, 0, 94, 86, 0, 51, 14, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static const uint8_t ssidBuiltinLabel[105] = {
+    0, 102, 114, 101, 101, 119, 105, 102, 105, 32, 119, 105, 102, 105, 119, 105,
+    102, 105, 105, 110, 116, 101, 114, 110, 101, 116, 103, 117, 101, 115, 116, 112,
+    117, 98, 108, 105, 99, 111, 112, 101, 110, 104, 111, 116, 115, 112, 111, 116,
+    97, 116, 109, 118, 105, 115, 97, 109, 97, 115, 116, 101, 114, 99, 97, 114,
+    100, 97, 121, 112, 97, 108, 98, 97, 110, 107, 99, 114, 101, 100, 105, 116,
+    109, 101, 110, 116, 111, 115, 116, 101, 114, 109, 105, 110, 97, 108, 115, 116,
+    114, 105, 112, 101, 113, 117, 97, 114, 101,
+};
+
+static const uint16_t ssidBuiltinChild[105] = {
+    94, 2, 3, 4, 9, 6, 7, 8, 0, 10, 11, 12, 13, 0, 15, 16,
+    17, 0, 19, 20, 21, 22, 23, 24, 25, 0, 27, 28, 29, 30, 0, 84,
+    33, 34, 35, 36, 0, 38, 39, 40, 0, 42, 43, 44, 45, 46, 47, 0,
+    49, 50, 0, 52, 53, 54, 0, 56, 57, 58, 59, 60, 61, 62, 63, 64,
+    0, 66, 80, 68, 69, 0, 71, 72, 73, 0, 75, 76, 77, 78, 79, 0,
+    81, 82, 83, 0, 85, 0, 87, 88, 89, 90, 91, 92, 93, 0, 100, 96,
+    97, 98, 99, 0, 101, 102, 103, 104, 0,
+};
+
+static const uint16_t ssidBuiltinSibling[105] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 5, 0, 0, 0, 0, 1, 0,
+    0, 0, 14, 0, 0, 0, 0, 0, 0, 0, 18, 0, 0, 0, 0, 26,
+    0, 0, 0, 0, 0, 31, 0, 0, 0, 37, 0, 0, 0, 0, 0, 0,
+    41, 0, 0, 48, 0, 0, 0, 51, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 32, 0, 0, 0, 0, 55, 0, 0, 0, 70, 0, 0, 0, 0, 0,
+    67, 0, 0, 0, 65, 0, 74, 0, 0, 0, 0, 0, 0, 0, 86, 0,
+    0, 0, 0, 0, 95, 0, 0, 0, 0,
+};
+
+static const uint16_t ssidBuiltinFail[105] = {
+    0, 0, 0, 0, 0, 14, 15, 16, 17, 0, 14, 15, 16, 17, 0, 18,
+    1, 18, 0, 0, 86, 87, 88, 0, 0, 86, 0, 0, 0, 94, 95, 0,
+    0, 70, 0, 18, 74, 0, 31, 0, 0, 0, 37, 86, 94, 31, 84, 86,
+    0, 86, 55, 0, 18, 94, 48, 0, 48, 94, 95, 87, 88, 74, 48, 0,
+    0, 48, 0, 31, 65, 0, 0, 48, 0, 0, 0, 0, 0, 0, 18, 86,
+    55, 0, 0, 86, 37, 94, 0, 0, 0, 55, 18, 19, 48, 0, 0, 86,
+    0, 18, 31, 0, 0, 0, 48, 0, 0,
+};
+
+static const uint16_t ssidBuiltinOutput[105] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 17, 0, 0, 0, 0, 17, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static const uint16_t ssidBuiltinSignature[105] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 2, 0, 0,
+    0, 3, 0, 0, 0, 0, 0, 0, 0, 4, 0, 0, 0, 0, 5, 0,
+    0, 0, 0, 0, 6, 0, 0, 0, 7, 0, 0, 0, 0, 0, 0, 8,
+    0, 0, 9, 0, 0, 0, 10, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    11, 0, 0, 0, 0, 12, 0, 0, 0, 13, 0, 0, 0, 0, 0, 14,
+    0, 0, 0, 15, 0, 16, 0, 0, 0, 0, 0, 0, 0, 17, 0, 0,
+    0, 0, 0, 18, 0, 0, 0, 0, 19,
+};
+
+static const SsidAutomaton ssidBuiltinAutomaton = {
+    ssidBuiltinRoot, ssidBuiltinLabel, ssidBuiltinChild, ssidBuiltinSibling,
+    ssidBuiltinFail, ssidBuiltinOutput, ssidBuiltinSignature, ssidBuiltinSignatures,
+    105, 19,
+};
+
+#endif
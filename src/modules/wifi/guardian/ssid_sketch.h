@@ -0,0 +1,89 @@
+#ifndef __GUARDIAN_SSID_SKETCH_H__
+#define __GUARDIAN_SSID_SKETCH_H__
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#define SSID_SKETCH_SLOTS 8      // distinct SSIDs counted exactly
+#define SSID_SKETCH_REGISTERS 16 // HyperLogLog registers used past that (~26% error)
+
+/**
+ * @brief 32 bit SSID hash (FNV-1a with a murmur3 finalizer for well mixed low bits)
+ */
+inline uint32_t ssidHash(const char *ssid, uint8_t len) {
+    uint32_t h = 2166136261u;
+    for (uint8_t i = 0; i < len; i++) {
+        h ^= (uint8_t)ssid[i];
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ * @brief Fixed-size set of the SSIDs advertised by one device
+ * @note Keeps the first SSID_SKETCH_SLOTS hashes for an exact small count and
+ *       feeds every hash into a HyperLogLog counter, so a beacon flood cycling
+ *       random SSIDs costs O(1) memory and never allocates.
+ * @note POD: a zeroed SsidSketch is an empty one.
+ */
+struct SsidSketch {
+    uint32_t hashes[SSID_SKETCH_SLOTS];
+    uint8_t used;
+    bool saturated; // more distinct SSIDs seen than fit in hashes
+    uint8_t registers[SSID_SKETCH_REGISTERS];
+
+    void clear() { memset(this, 0, sizeof(*this)); }
+
+    /**
+     * @brief Adds an SSID hash
+     * @return true if the hash was not in the exact slots
+     */
+    bool add(uint32_t h) {
+        const uint8_t idx = h & (SSID_SKETCH_REGISTERS - 1);
+        const uint32_t w = h >> 4; // remaining 28 bits
+        const uint8_t rank = w ? __builtin_clz(w) - 3 : 29;
+        if (rank > registers[idx]) registers[idx] = rank;
+
+        for (uint8_t i = 0; i < used; i++) {
+            if (hashes[i] == h) return false;
+        }
+        if (used < SSID_SKETCH_SLOTS) hashes[used++] = h;
+        else saturated = true;
+        return true;
+    }
+
+    bool contains(uint32_t h) const {
+        for (uint8_t i = 0; i < used; i++) {
+            if (hashes[i] == h) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Number of distinct SSIDs, exact up to SSID_SKETCH_SLOTS
+     */
+    uint32_t count() const {
+        if (!saturated) return used;
+
+        float sum = 0;
+        uint8_t zeros = 0;
+        for (uint8_t i = 0; i < SSID_SKETCH_REGISTERS; i++) {
+            sum += ldexpf(1.0f, -registers[i]);
+            if (registers[i] == 0) zeros++;
+        }
+        const float m = SSID_SKETCH_REGISTERS;
+        float estimate = 0.673f * m * m / sum;
+        if (estimate <= 2.5f * m && zeros > 0) estimate = m * logf(m / zeros); // small range correction
+
+        uint32_t n = (uint32_t)(estimate + 0.5f);
+        return n > SSID_SKETCH_SLOTS ? n : SSID_SKETCH_SLOTS + 1;
+    }
+};
+
+#endif
@@ -0,0 +1,519 @@
+#include "threat_engine.h"
+#include "guardian_clock.h"
+
+ThreatEngine threatEngine;
+
+// Feature extractors
+
+static float beaconRate(const ThreatFeatures &f) { return f.beaconRate; }
+
+static float probeRate(const ThreatFeatures &f) { return f.probeRate; }
+
+static float deauthRate(const ThreatFeatures &f) { return f.deauthRate; }
+
+static float ssidCount(const ThreatFeatures &f) { return f.ssidCount; }
+
+static float recentFrames(const ThreatFeatures &f) { return f.recentFrames; }
+
+// Beacon rate above twice the device's long term rate (attack starting), > 0 when it fires
+static float beaconSurge(const ThreatFeatures &f) {
+    return f.beaconRate > 1.5f ? f.beaconRate - f.totalBeaconRate * 2 : 0;
+}
+
+// Largest of the "very high activity" ratios, 1 at 10 beacons/s or 8 probes/s
+static float activity(const ThreatFeatures &f) {
+    float a = f.beaconRate / 10;
+    if (f.probeRate / 8 > a) a = f.probeRate / 8;
+    if (f.recentBeacons / 20 > a) a = f.recentBeacons / 20;
+    return a;
+}
+
+const ThreatRule threatRules[] = {
+    {"beacon spam",    beaconRate,   BEACON_SPAM_THRESHOLD,   4.0f, THREAT_BEACON_SPAM, true },
+    {"beacon surge",   beaconSurge,  10,                      3.0f, THREAT_BEACON_SPAM, false}, // 10/s over twice the usual rate
+    {"deauth flood",   deauthRate,   DEAUTH_ATTACK_THRESHOLD, 5.0f, THREAT_DEAUTH_FLOOD, true },
+    {"probe flood",    probeRate,    PROBE_FLOOD_THRESHOLD,   4.0f, THREAT_PROBE_FLOOD, true },
+    {"multiple SSIDs", ssidCount,    2,                       3.0f, THREAT_EVIL_TWIN,   false}, // evil twin/karma
+    {"high activity",  activity,     2,                       2.0f, THREAT_UNKNOWN,     false},
+    {"burst",          recentFrames, 60,                      2.0f, THREAT_UNKNOWN,     false}, // twice what a beaconing AP sends
+};
+const size_t threatRuleCount = sizeof(threatRules) / sizeof(threatRules[0]);
+static_assert(sizeof(threatRules) / sizeof(threatRules[0]) <= DETECTION_RULE_SLOTS, "rules do not fit in a profile");
+
+#define THREAT_ROW_NONE 0xFFFF
+#define THREAT_EXPIRE_MAX_MS ((THREAT_WHEEL_SLOTS - 2) << THREAT_WHEEL_SHIFT) // keeps deadlines inside the wheel
+
+// Carves one column out of the shared block, keeping every column 8 byte aligned
+template <typename T> static T *column(uint8_t *block, size_t &offset, size_t rows) {
+    T *c = block ? (T *)(block + offset) : nullptr;
+    offset += (rows * sizeof(T) + 7) & ~(size_t)7;
+    return c;
+}
+
+bool ThreatEngine::begin(size_t maxDevices, const ThreatEngineConfig &config) {
+    end();
+    if (maxDevices > THREAT_ROW_NONE - 1) maxDevices = THREAT_ROW_NONE - 1;
+    if (!_index.allocate(maxDevices)) return false;
+    if (!_twins.begin() || !_karma.begin() || !_deauth.begin() || !_clusters.begin()) {
+        _index.release();
+        _twins.end();
+        _karma.end();
+        _deauth.end();
+        _clusters.end();
+        return false;
+    }
+
+    // One allocation for all columns, sized by a first pass without a block
+    uint8_t *block = nullptr;
+    Columns c;
+    for (int pass = 0; pass < 2; pass++) {
+        size_t off = 0;
+        c.mac = column<uint64_t>(block, off, maxDevices);
+        c.firstSeen = column<uint32_t>(block, off, maxDevices);
+        c.lastSeen = column<uint32_t>(block, off, maxDevices);
+        c.beaconCount = column<uint32_t>(block, off, maxDevices);
+        c.probeCount = column<uint32_t>(block, off, maxDevices);
+        c.deauthCount = column<uint32_t>(block, off, maxDevices);
+        c.beaconRate = column<uint32_t>(block, off, maxDevices);
+        c.probeRate = column<uint32_t>(block, off, maxDevices);
+        c.deauthRate = column<uint32_t>(block, off, maxDevices);
+        c.responseRate = column<uint32_t>(block, off, maxDevices);
+        c.authRate = column<uint32_t>(block, off, maxDevices);
+        c.rssiMean = column<int16_t>(block, off, maxDevices);
+        c.rssiVar = column<uint16_t>(block, off, maxDevices);
+        c.lastSeq = column<uint16_t>(block, off, maxDevices);
+        c.seqGap = column<uint16_t>(block, off, maxDevices);
+        c.arrivals = column<AnomalyArrivals>(block, off, maxDevices);
+        c.ssids = column<SsidSketch>(block, off, maxDevices);
+        c.deauthRef = column<DeauthReference>(block, off, maxDevices);
+        c.riskScore = column<float>(block, off, maxDevices);
+        c.peakRisk = column<float>(block, off, maxDevices);
+        c.flaggedRisk = column<float>(block, off, maxDevices);
+        c.threat = column<uint8_t>(block, off, maxDevices);
+        c.malicious = column<uint8_t>(block, off, maxDevices);
+        c.wheelNext = column<uint16_t>(block, off, maxDevices);
+        c.wheelPrev = column<uint16_t>(block, off, maxDevices);
+        c.wheelSlot = column<uint8_t>(block, off, maxDevices);
+        if (pass == 0) {
+            block = (uint8_t *)guardianAlloc(off);
+            if (!block) {
+                _index.release();
+                _twins.end();
+                _karma.end();
+                _deauth.end();
+                _clusters.end();
+                return false;
+            }
+        }
+    }
+
+    _block = block;
+    _col = c;
+    _capacity = maxDevices;
+    _rows = 0;
+    _threats = 0;
+    _expired = 0;
+    _evicted = 0;
+    _config = config;
+    if (_config.expireMs == 0) _config.expireMs = THREAT_EXPIRE_MS;
+    if (_config.expireMs > THREAT_EXPIRE_MAX_MS) _config.expireMs = THREAT_EXPIRE_MAX_MS;
+    for (size_t i = 0; i < THREAT_WHEEL_SLOTS; i++) _wheel[i] = THREAT_ROW_NONE;
+    _wheelStarted = false;
+    _history.clear();
+    return true;
+}
+
+void ThreatEngine::end() {
+    _index.release();
+    _twins.end();
+    _karma.end();
+    _deauth.end();
+    _clusters.end();
+    free(_block);
+    _block = nullptr;
+    _col = Columns();
+    _capacity = 0;
+    _rows = 0;
+}
+
+size_t ThreatEngine::addRow(uint64_t key, uint32_t now) {
+    const size_t r = _rows;
+    _col.mac[r] = key;
+    _col.firstSeen[r] = now;
+    _col.lastSeen[r] = now;
+    _col.beaconCount[r] = 0;
+    _col.probeCount[r] = 0;
+    _col.deauthCount[r] = 0;
+    _col.beaconRate[r] = 0;
+    _col.probeRate[r] = 0;
+    _col.deauthRate[r] = 0;
+    _col.responseRate[r] = 0;
+    _col.authRate[r] = 0;
+    _col.rssiMean[r] = 0;
+    _col.rssiVar[r] = 0;
+    _col.lastSeq[r] = 0;
+    _col.seqGap[r] = 0;
+    anomalyArrivalsClear(_col.arrivals[r]);
+    _col.ssids[r].clear();
+    _col.riskScore[r] = 0;
+    _col.peakRisk[r] = 0;
+    _col.flaggedRisk[r] = 0;
+    deauthReferenceReset(_col.deauthRef[r]);
+    _col.threat[r] = THREAT_UNKNOWN;
+    _col.malicious[r] = false;
+    wheelLink(r, deadlineGranule(r));
+    __atomic_store_n(&_rows, r + 1, __ATOMIC_RELEASE); // readers only see initialized rows
+    return r;
+}
+
+// Timing wheel: a row sits in the bucket of the deadline it had when it was filed.
+// lastSeen moves on without touching the wheel; when the bucket comes due, rows
+// that were seen in the meantime are simply filed again under their new deadline.
+// Each row is handled at most once per expiry period, so aging is amortized O(1).
+
+uint32_t ThreatEngine::deadlineGranule(size_t row) const {
+    return (_col.lastSeen[row] + _config.expireMs) >> THREAT_WHEEL_SHIFT;
+}
+
+void ThreatEngine::wheelLink(size_t row, uint32_t granule) {
+    if (_wheelStarted && (int32_t)(granule - _wheelGranule) <= 0) granule = _wheelGranule + 1;
+    const uint8_t slot = granule & (THREAT_WHEEL_SLOTS - 1);
+    const uint16_t head = _wheel[slot];
+    _col.wheelSlot[row] = slot;
+    _col.wheelPrev[row] = THREAT_ROW_NONE;
+    _col.wheelNext[row] = head;
+    if (head != THREAT_ROW_NONE) _col.wheelPrev[head] = row;
+    _wheel[slot] = row;
+}
+
+void ThreatEngine::wheelUnlink(size_t row) {
+    const uint16_t prev = _col.wheelPrev[row];
+    const uint16_t next = _col.wheelNext[row];
+    if (prev != THREAT_ROW_NONE) _col.wheelNext[prev] = next;
+    else _wheel[_col.wheelSlot[row]] = next;
+    if (next != THREAT_ROW_NONE) _col.wheelPrev[next] = prev;
+}
+
+// Copies every column of row from into row to, fixing the wheel links and the index
+void ThreatEngine::moveRow(size_t from, size_t to) {
+    _col.mac[to] = _col.mac[from];
+    _col.firstSeen[to] = _col.firstSeen[from];
+    _col.lastSeen[to] = _col.lastSeen[from];
+    _col.beaconCount[to] = _col.beaconCount[from];
+    _col.probeCount[to] = _col.probeCount[from];
+    _col.deauthCount[to] = _col.deauthCount[from];
+    _col.beaconRate[to] = _col.beaconRate[from];
+    _col.probeRate[to] = _col.probeRate[from];
+    _col.deauthRate[to] = _col.deauthRate[from];
+    _col.responseRate[to] = _col.responseRate[from];
+    _col.authRate[to] = _col.authRate[from];
+    _col.rssiMean[to] = _col.rssiMean[from];
+    _col.rssiVar[to] = _col.rssiVar[from];
+    _col.lastSeq[to] = _col.lastSeq[from];
+    _col.seqGap[to] = _col.seqGap[from];
+    _col.arrivals[to] = _col.arrivals[from];
+    _col.ssids[to] = _col.ssids[from];
+    _col.deauthRef[to] = _col.deauthRef[from];
+    _col.riskScore[to] = _col.riskScore[from];
+    _col.peakRisk[to] = _col.peakRisk[from];
+    _col.flaggedRisk[to] = _col.flaggedRisk[from];
+    _col.threat[to] = _col.threat[from];
+    _col.malicious[to] = _col.malicious[from];
+
+    const uint16_t prev = _col.wheelPrev[from];
+    const uint16_t next = _col.wheelNext[from];
+    _col.wheelPrev[to] = prev;
+    _col.wheelNext[to] = next;
+    _col.wheelSlot[to] = _col.wheelSlot[from];
+    if (prev != THREAT_ROW_NONE) _col.wheelNext[prev] = to;
+    else _wheel[_col.wheelSlot[to]] = to;
+    if (next != THREAT_ROW_NONE) _col.wheelPrev[next] = to;
+
+    *_index.findKey(_col.mac[to]) = to;
+}
+
+// Summarizes a row and removes it, the last row takes its place so rows stay dense
+void ThreatEngine::removeRow(size_t row) {
+    const ThreatDevice d = device(row);
+    if (_config.onExpired) _config.onExpired(d);
+    if (d.peakRisk > 0 || d.isMarkedMalicious) {
+        ThreatSummary summary;
+        memcpy(summary.mac, d.mac, 6);
+        summary.threat = d.suspectedThreat;
+        summary.malicious = d.isMarkedMalicious;
+        summary.peakRisk = d.peakRisk;
+        summary.firstSeen = d.firstSeen;
+        summary.lastSeen = d.lastSeen;
+        summary.beaconCount = d.beaconCount;
+        summary.probeCount = d.probeCount;
+        summary.deauthCount = d.deauthCount;
+        summary.ssidCount = d.ssidCount;
+        _history.push(summary);
+    }
+
+    wheelUnlink(row);
+    _index.eraseKey(_col.mac[row]);
+    const size_t last = _rows - 1;
+    if (row != last) moveRow(last, row);
+    __atomic_store_n(&_rows, last, __ATOMIC_RELEASE);
+}
+
+void ThreatEngine::advanceWheel(uint32_t now) {
+    const uint32_t granule = now >> THREAT_WHEEL_SHIFT;
+    if (!_wheelStarted) {
+        _wheelGranule = granule;
+        _wheelStarted = true;
+        return;
+    }
+
+    // A long gap (or a replay clock jump) still only needs one turn of the wheel
+    uint32_t steps = granule - _wheelGranule;
+    if ((int32_t)steps <= 0) return;
+    if (steps > THREAT_WHEEL_SLOTS) _wheelGranule = granule - THREAT_WHEEL_SLOTS;
+
+    while (_wheelGranule != granule) {
+        _wheelGranule++;
+        uint16_t *bucket = &_wheel[_wheelGranule & (THREAT_WHEEL_SLOTS - 1)];
+        while (*bucket != THREAT_ROW_NONE) {
+            const uint16_t row = *bucket;
+            if ((int32_t)(now - _col.lastSeen[row]) >= (int32_t)_config.expireMs) {
+                removeRow(row);
+                _expired++;
+            } else {
+                wheelUnlink(row);
+                wheelLink(row, deadlineGranule(row));
+            }
+        }
+    }
+}
+
+// Makes room for a new device by removing the one whose deadline comes first
+bool ThreatEngine::evictOldest() {
+    if (!_wheelStarted || _rows == 0) return false;
+    for (uint32_t g = _wheelGranule + 1; g != _wheelGranule + 1 + THREAT_WHEEL_SLOTS; g++) {
+        uint16_t row = _wheel[g & (THREAT_WHEEL_SLOTS - 1)];
+        while (row != THREAT_ROW_NONE) {
+            const uint16_t next = _col.wheelNext[row];
+            const int32_t ahead = deadlineGranule(row) - g;
+            if (ahead <= 0) {
+                removeRow(row);
+                _evicted++;
+                return true;
+            }
+            if (ahead < THREAT_WHEEL_SLOTS) { // seen since it was filed, move it to its real deadline
+                wheelUnlink(row);
+                wheelLink(row, g + ahead);
+            }
+            row = next;
+        }
+    }
+    return false;
+}
+
+void ThreatEngine::apply(const GuardianFrame *frames, size_t count) {
+    if (!_block) return;
+    const DetectionProfile &profile = detectionProfile();
+
+    for (size_t i = 0; i < count; i++) {
+        const GuardianFrame &frame = frames[i];
+        const uint8_t type = (frame.frameCtrl >> 2) & 0x3;
+        const uint8_t subtype = frame.frameCtrl >> 4;
+        if (type != IEEE80211_TYPE_MGMT) continue;
+
+        // Randomized MACs of one client share its cluster's row
+        const uint64_t key = _clusters.resolve(frame);
+
+        // A full table makes room by dropping its least recently seen device
+        if (_rows == _capacity && !_index.findKey(key)) {
+            advanceWheel(frame.timestamp);
+            if (_rows == _capacity) evictOldest();
+        }
+
+        bool created;
+        uint16_t *slot = _index.insertKey(key, &created);
+        if (!slot) continue; // table full, counted in rejected()
+        if (created) *slot = addRow(key, frame.timestamp);
+        const size_t r = *slot;
+
+        // Bring all rates to the frame time, then count the frame in its class
+        const int32_t dt = frame.timestamp - _col.lastSeen[r];
+        const uint32_t elapsed = dt > 0 ? dt : 0;
+        _col.lastSeen[r] = frame.timestamp;
+        _col.beaconRate[r] = rateDecay(_col.beaconRate[r], elapsed);
+        _col.probeRate[r] = rateDecay(_col.probeRate[r], elapsed);
+        _col.deauthRate[r] = rateDecay(_col.deauthRate[r], elapsed);
+        _col.responseRate[r] = rateDecay(_col.responseRate[r], elapsed);
+        _col.authRate[r] = rateDecay(_col.authRate[r], elapsed);
+
+        // Timing, sequence and signal statistics of every frame for the anomaly model
+        const uint16_t seq = frame.seqCtrl >> 4;
+        if (!created) {
+            anomalyArrivalsAdd(_col.arrivals[r], elapsed);
+            anomalySeqGapAdd(_col.seqGap[r], _col.lastSeq[r], seq);
+        }
+        _col.lastSeq[r] = seq;
+        anomalyRssiAdd(_col.rssiMean[r], _col.rssiVar[r], frame.rssi);
+
+        switch (subtype) {
+            case IEEE80211_SUBTYPE_BEACON:
+                _col.beaconCount[r]++;
+                _col.beaconRate[r] += RATE_EVENT_Q16;
+                // SSID was copied out of the beacon by the capture callback, only its hash is kept
+                if (frame.ssidLen > 0) _col.ssids[r].add(ssidHash(frame.ssid, frame.ssidLen));
+                break;
+            case IEEE80211_SUBTYPE_PROBE_REQ:
+                _col.probeCount[r]++;
+                _col.probeRate[r] += RATE_EVENT_Q16;
+                break;
+            case IEEE80211_SUBTYPE_PROBE_RESP: _col.responseRate[r] += RATE_EVENT_Q16; break;
+            case IEEE80211_SUBTYPE_AUTH:
+            case IEEE80211_SUBTYPE_ASSOC_REQ:
+            case IEEE80211_SUBTYPE_ASSOC_RESP:
+            case IEEE80211_SUBTYPE_REASSOC_REQ:
+            case IEEE80211_SUBTYPE_REASSOC_RESP: _col.authRate[r] += RATE_EVENT_Q16; break;
+            case IEEE80211_SUBTYPE_DEAUTH:
+            case IEEE80211_SUBTYPE_DISASSOC:
+                // A forged source MAC is not held against the AP, the flood goes to its target
+                if (deauthSpoofed(_col.deauthRef[r], frame)) {
+                    DeauthFlood flood;
+                    if (_deauth.observe(frame, profile.spoofedDeauth, flood) && _config.onDeauthFlood) {
+                        _config.onDeauthFlood(flood);
+                    }
+                } else if (subtype == IEEE80211_SUBTYPE_DEAUTH) {
+                    _col.deauthCount[r]++;
+                    _col.deauthRate[r] += RATE_EVENT_Q16;
+                }
+                break;
+        }
+        if (subtype != IEEE80211_SUBTYPE_DEAUTH && subtype != IEEE80211_SUBTYPE_DISASSOC) {
+            deauthReferenceUpdate(_col.deauthRef[r], frame);
+        }
+
+        // Beacons and probe responses also feed the fingerprint clusters
+        uint8_t distance = 0;
+        switch (_twins.observe(frame, &distance)) {
+            case EVIL_TWIN_DIVERGENT: flag(r, THREAT_EVIL_TWIN, profile.attackScore + distance); break;
+            case EVIL_TWIN_CLONED: flag(r, THREAT_EVIL_TWIN, profile.attackScore * 2); break;
+            case EVIL_TWIN_NONE: break;
+        }
+
+        // Beacons are diffed against the learned networks, the deviation is the alert
+        BaselineDeviation deviation;
+        if (_config.baseline && _config.baseline->observe(frame, deviation) && _config.onBaselineDeviation) {
+            _config.onBaselineDeviation(deviation);
+        }
+
+        // Probe requests and responses feed the Karma correlator
+        uint32_t answered = 0;
+        if (_karma.observe(frame, &answered)) flag(r, THREAT_KARMA_ATTACK, profile.attackScore + answered);
+    }
+}
+
+// Confirms a threat found outside the rule table, analyze() keeps its type afterwards
+void ThreatEngine::flag(size_t row, ThreatType threat, float score) {
+    _col.threat[row] = threat;
+    if (score > _col.riskScore[row]) _col.riskScore[row] = score;
+    if (score > _col.peakRisk[row]) _col.peakRisk[row] = score;
+    if (score > _col.flaggedRisk[row]) _col.flaggedRisk[row] = score;
+    if (_col.malicious[row]) return;
+    _col.malicious[row] = true;
+    _threats++;
+    if (_config.onDetected) _config.onDetected(device(row));
+}
+
+void ThreatEngine::analyze(uint32_t now) {
+    advanceWheel(now);
+    const DetectionProfile &profile = detectionProfile();
+    const size_t rows = _rows;
+
+    for (size_t r = 0; r < rows; r++) {
+        const int32_t idle = now - _col.lastSeen[r];
+        if (idle > (int32_t)_config.staleMs) continue;
+        const uint32_t elapsed = idle > 0 ? idle : 0;
+
+        ThreatFeatures f;
+        f.beaconRate = rateToFloat(rateDecay(_col.beaconRate[r], elapsed));
+        f.probeRate = rateToFloat(rateDecay(_col.probeRate[r], elapsed));
+        f.deauthRate = rateToFloat(rateDecay(_col.deauthRate[r], elapsed));
+        const float totalSeconds = (now - _col.firstSeen[r]) / 1000.0f;
+        f.totalBeaconRate = totalSeconds > 1.0f ? _col.beaconCount[r] / totalSeconds : 0;
+        f.recentBeacons = f.beaconRate * (SHORT_WINDOW_MS / 1000.0f);
+        f.recentFrames = (f.beaconRate + f.probeRate + f.deauthRate) * (SHORT_WINDOW_MS / 1000.0f);
+        f.ssidCount = _col.ssids[r].count();
+
+        // Confirmed devices keep the threat they were flagged for unless a rule overrides it
+        float score = 0;
+        uint8_t threat = _col.malicious[r] ? _col.threat[r] : (uint8_t)THREAT_UNKNOWN;
+        if (profile.anomalyModel) {
+            // The model's logit over benign, shifted so the decision boundary sits at attackScore
+            int16_t x[ANOMALY_FEATURES];
+            anomalyFeatures(r, now, x);
+            uint8_t cls;
+            const int32_t margin = anomalyScore(anomalyModel, x, cls);
+            score = profile.attackScore + (float)margin / anomalyModel.unit;
+            if (score < 0) score = 0;
+            if (margin >= 0) threat = anomalyThreat(cls);
+        } else {
+            for (size_t i = 0; i < threatRuleCount; i++) {
+                const ThreatRule &rule = threatRules[i];
+                if (!(rule.feature(f) > profile.rule[i])) continue;
+                score += rule.score;
+                if (rule.threat != THREAT_UNKNOWN && (rule.overrides || threat == THREAT_UNKNOWN)) {
+                    threat = rule.threat;
+                }
+            }
+        }
+        // An evil twin or Karma AP may beacon at a normal rate, its flag() score stands
+        if (score < _col.flaggedRisk[r]) score = _col.flaggedRisk[r];
+        _col.riskScore[r] = score;
+        if (score > _col.peakRisk[r]) _col.peakRisk[r] = score;
+        _col.threat[r] = threat;
+
+        if (_config.onTrace && (score > 0.5f || f.recentBeacons > 5)) _config.onTrace(device(r), f);
+
+        if (score >= profile.attackScore && !_col.malicious[r]) {
+            _col.malicious[r] = true;
+            _threats++;
+            if (_config.onDetected) _config.onDetected(device(r));
+        }
+    }
+}
+
+void ThreatEngine::anomalyFeatures(size_t row, uint32_t now, int16_t *x) const {
+    const int32_t idle = now - _col.lastSeen[row];
+    const uint32_t elapsed = idle > 0 ? idle : 0;
+    x[ANOMALY_BEACON_RATE] = anomalyRateFeature(rateDecay(_col.beaconRate[row], elapsed));
+    x[ANOMALY_PROBE_RATE] = anomalyRateFeature(rateDecay(_col.probeRate[row], elapsed));
+    x[ANOMALY_RESPONSE_RATE] = anomalyRateFeature(rateDecay(_col.responseRate[row], elapsed));
+    x[ANOMALY_DEAUTH_RATE] = anomalyRateFeature(rateDecay(_col.deauthRate[row], elapsed));
+    x[ANOMALY_AUTH_RATE] = anomalyRateFeature(rateDecay(_col.authRate[row], elapsed));
+    x[ANOMALY_SSID_COUNT] = anomalyLog2Q8(_col.ssids[row].count() + 1);
+    x[ANOMALY_RSSI_VARIANCE] = anomalyQ4Feature(_col.rssiVar[row]);
+    x[ANOMALY_SEQ_GAP] = anomalyQ4Feature(_col.seqGap[row]);
+    x[ANOMALY_ARRIVAL_ENTROPY] = anomalyArrivalEntropy(_col.arrivals[row]);
+}
+
+ThreatDevice ThreatEngine::device(size_t row) const {
+    ThreatDevice d;
+    keyToMac(_col.mac[row], d.mac);
+    d.firstSeen = _col.firstSeen[row];
+    d.lastSeen = _col.lastSeen[row];
+    d.beaconCount = _col.beaconCount[row];
+    d.probeCount = _col.probeCount[row];
+    d.deauthCount = _col.deauthCount[row];
+    const int32_t idle = guardianMillis() - _col.lastSeen[row];
+    const uint32_t elapsed = idle > 0 ? idle : 0;
+    d.beaconRate = rateToFloat(rateDecay(_col.beaconRate[row], elapsed));
+    d.probeRate = rateToFloat(rateDecay(_col.probeRate[row], elapsed));
+    d.deauthRate = rateToFloat(rateDecay(_col.deauthRate[row], elapsed));
+    d.ssidCount = _col.ssids[row].count();
+    d.suspectedThreat = (ThreatType)_col.threat[row];
+    d.riskScore = _col.riskScore[row];
+    d.peakRisk = _col.peakRisk[row];
+    d.isMarkedMalicious = _col.malicious[row];
+    return d;
+}
+
+void threatEngineApply(const GuardianFrame *frames, size_t count) { threatEngine.apply(frames, count); }
+
+void threatEngineAnalyze() { threatEngine.analyze(guardianMillis()); }
@@ -0,0 +1,266 @@
+#ifndef __GUARDIAN_THREAT_ENGINE_H__
+#define __GUARDIAN_THREAT_ENGINE_H__
+
+#include "anomaly_model.h"
+#include "deauth_detector.h"
+#include "detection_profile.h"
+#include "evil_twin.h"
+#include "guardian_frame.h"
+#include "karma.h"
+#include "mac_table.h"
+#include "network_baseline.h"
+#include "probe_cluster.h"
+#include "rate_estimator.h"
+#include "ssid_sketch.h"
+#include "threat_history.h"
+
+// Detection engine shared by the Guardian (Defense) and Shark-Bait monitors.
+// Per-transmitter state is kept as a structure of arrays indexed by row, and a
+// const table of rules is evaluated over it in a single pass per analysis tick.
+// Frame rates are decaying estimators (rate_estimator.h), valid at any instant.
+// Beacons are also fingerprinted per SSID to spot evil twins (evil_twin.h) and
+// probe responses are correlated with the probes they answer (karma.h), and deauths
+// breaking the claimed sender's sequence/RSSI continuity are charged to their
+// target as spoofed (deauth_detector.h). With a learned baseline of the trusted
+// networks, beacons are diffed against it as well (network_baseline.h). Probe
+// requests from randomized MACs are keyed by client (probe_cluster.h), so a
+// phone rotating its MAC is one device whose rates add up instead of dozens of
+// quiet ones. Profiles with the "anomaly model" setting score the rate based
+// attacks with the trained model of anomaly_model.h instead of the rule table,
+// from feature columns that are kept up to date either way.
+// Idle devices are expired through a timing wheel and summarized into a history,
+// so the table runs in a fixed memory budget for as long as the monitor does.
+// Free of Arduino types so replays can run it on a Linux host.
+
+enum ThreatType {
+    THREAT_BEACON_SPAM,
+    THREAT_EVIL_TWIN,
+    THREAT_KARMA_ATTACK,
+    THREAT_DEAUTH_FLOOD,
+    THREAT_PROBE_FLOOD,
+    THREAT_CAPTIVE_PORTAL,
+    THREAT_ROGUE_AP,
+    THREAT_UNKNOWN
+};
+
+inline ThreatType anomalyThreat(uint8_t cls) {
+    switch (cls) {
+        case ANOMALY_BEACON_SPAM: return THREAT_BEACON_SPAM;
+        case ANOMALY_DEAUTH_FLOOD: return THREAT_DEAUTH_FLOOD;
+        case ANOMALY_PROBE_FLOOD: return THREAT_PROBE_FLOOD;
+        default: return THREAT_UNKNOWN;
+    }
+}
+
+// Defaults of the "home" detection profile (detection_profile.h), the engine reads
+// the active profile (overridable with -D, tools/guardian_bench sweeps them that way)
+#ifndef BEACON_SPAM_THRESHOLD
+#define BEACON_SPAM_THRESHOLD 15     // beacons/second (normal APs ~10/s at 102.4 ms, spam is much faster)
+#endif
+#ifndef DEAUTH_ATTACK_THRESHOLD
+#define DEAUTH_ATTACK_THRESHOLD 1    // deauths/second
+#endif
+#ifndef PROBE_FLOOD_THRESHOLD
+#define PROBE_FLOOD_THRESHOLD 5      // probes/second
+#endif
+#ifndef ATTACK_DETECTION_THRESHOLD
+#define ATTACK_DETECTION_THRESHOLD 2 // risk score to confirm attack
+#endif
+#ifndef ANOMALY_MODEL_DEFAULT
+#define ANOMALY_MODEL_DEFAULT 0      // 1: anomaly_model.h scores rate attacks instead of threatRules
+#endif
+#ifndef THREAT_STALE_MS
+#define THREAT_STALE_MS 30000        // Guardian: devices silent for longer are not scored
+#endif
+#ifndef SHARK_STALE_MS
+#define SHARK_STALE_MS 8000          // Shark-Bait: devices silent for longer are not scored
+#endif
+#define SHORT_WINDOW_MS 3000         // span the count based rules (recentBeacons, recentFrames) refer to
+#define MIN_ANALYSIS_TIME 500        // analysis interval
+#define THREAT_EXPIRE_MS 60000       // idle time after which a device leaves the table
+
+#define THREAT_WHEEL_SLOTS 64 // timing wheel buckets, power of two
+#define THREAT_WHEEL_SHIFT 11 // bucket span of 2^11 ms, 131 s horizon
+
+/**
+ * @brief Inputs of the detection rules, computed once per device and pass
+ */
+struct ThreatFeatures {
+    float beaconRate; // per second, decaying estimate
+    float probeRate;
+    float deauthRate;
+    float totalBeaconRate; // per second since first seen, 0 during the first second
+    float recentBeacons;   // beacons per SHORT_WINDOW_MS at the current rate
+    float recentFrames;    // beacons + probes + deauths per SHORT_WINDOW_MS
+    uint32_t ssidCount;    // distinct SSIDs advertised
+};
+
+typedef float (*ThreatFeatureFn)(const ThreatFeatures &features);
+
+/**
+ * @brief One detection rule: fires when feature(device) > the active profile's threshold
+ * @note threat is only assigned when the device has none yet, unless overrides is
+ *       set; THREAT_UNKNOWN makes a rule contribute to the score only.
+ */
+struct ThreatRule {
+    const char *name;        // also the key of its threshold in detection profiles
+    ThreatFeatureFn feature;
+    uint16_t threshold;      // in the "home" profile
+    float score;
+    ThreatType threat;
+    bool overrides;
+};
+
+// The rule set, in evaluation order (threat_engine.cpp)
+extern const ThreatRule threatRules[];
+extern const size_t threatRuleCount;
+
+/**
+ * @brief Copy of one device row, for display and handlers
+ */
+struct ThreatDevice {
+    uint8_t mac[6];
+    uint32_t firstSeen;
+    uint32_t lastSeen;
+    uint32_t beaconCount;
+    uint32_t probeCount;
+    uint32_t deauthCount; // genuine ones, spoofed deauths are charged to their target
+    float beaconRate; // per second, as of guardianMillis()
+    float probeRate;
+    float deauthRate;
+    uint32_t ssidCount;
+    ThreatType suspectedThreat;
+    float riskScore;
+    float peakRisk; // highest score since first seen
+    bool isMarkedMalicious;
+};
+
+typedef void (*ThreatDetectedHandler)(const ThreatDevice &device);
+typedef void (*ThreatExpiredHandler)(const ThreatDevice &device);
+typedef void (*ThreatTraceHandler)(const ThreatDevice &device, const ThreatFeatures &features);
+
+struct ThreatEngineConfig {
+    uint32_t staleMs;                 // devices silent for longer are left out of analysis
+    uint32_t expireMs;                // devices silent for longer are removed, at most 120 s
+    ThreatDetectedHandler onDetected; // once per device, when its score first reaches ATTACK_DETECTION_THRESHOLD or it is an evil twin/Karma AP
+    ThreatTraceHandler onTrace;       // debug trace of suspicious devices, may be nullptr
+    ThreatExpiredHandler onExpired;   // device about to be removed, may be nullptr
+    DeauthFloodHandler onDeauthFlood; // once per station targeted by spoofed deauths, may be nullptr
+    NetworkBaseline *baseline;        // learned networks beacons are diffed against (or learned into), may be nullptr
+    BaselineDeviationHandler onBaselineDeviation; // once per AP and kind of deviation, may be nullptr
+};
+
+class ThreatEngine {
+public:
+    ~ThreatEngine() { end(); }
+
+    /**
+     * @brief Allocates room for maxDevices and clears all state
+     * @return false if the allocation failed
+     */
+    bool begin(size_t maxDevices, const ThreatEngineConfig &config);
+    void end();
+
+    /**
+     * @brief Accounts a batch of captured frames to their transmitters
+     */
+    void apply(const GuardianFrame *frames, size_t count);
+
+    /**
+     * @brief Expires idle devices, then scores every recently seen one against threatRules
+     *        or the anomaly model
+     */
+    void analyze(uint32_t now);
+
+    /**
+     * @brief Input of the anomaly model for one row at time now, ANOMALY_FEATURES values
+     */
+    void anomalyFeatures(size_t row, uint32_t now, int16_t *features) const;
+
+    size_t size() const { return __atomic_load_n(&_rows, __ATOMIC_ACQUIRE); }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return _capacity; }
+    uint32_t rejected() const { return _index.rejected(); } // frames from devices that did not fit
+    uint32_t threats() const { return _threats; }
+    uint32_t expired() const { return _expired; } // idle devices removed
+    uint32_t evicted() const { return _evicted; } // least recently seen devices removed to make room
+
+    ThreatDevice device(size_t row) const;
+
+    /**
+     * @brief Summaries of removed devices that scored at some point
+     */
+    const ThreatHistory &history() const { return _history; }
+
+    const EvilTwinDetector &twins() const { return _twins; }
+    const KarmaDetector &karma() const { return _karma; }
+    const DeauthDetector &deauth() const { return _deauth; }
+    const ProbeClusters &clusters() const { return _clusters; }
+
+private:
+    struct Columns {
+        uint64_t *mac;
+        uint32_t *firstSeen;
+        uint32_t *lastSeen; // also the time the rates were last updated
+        uint32_t *beaconCount;
+        uint32_t *probeCount;
+        uint32_t *deauthCount;
+        uint32_t *beaconRate; // Q16 events/s, see rate_estimator.h
+        uint32_t *probeRate;
+        uint32_t *deauthRate;
+        uint32_t *responseRate; // anomaly model inputs, see anomaly_model.h
+        uint32_t *authRate;
+        int16_t *rssiMean;
+        uint16_t *rssiVar;
+        uint16_t *lastSeq;
+        uint16_t *seqGap;
+        AnomalyArrivals *arrivals;
+        SsidSketch *ssids;
+        DeauthReference *deauthRef;
+        float *riskScore;
+        float *peakRisk;
+        float *flaggedRisk; // score of flag(), analyze() never scores the row lower
+        uint8_t *threat;
+        uint8_t *malicious;
+        uint16_t *wheelNext; // timing wheel links, THREAT_ROW_NONE terminated
+        uint16_t *wheelPrev;
+        uint8_t *wheelSlot;
+    };
+
+    size_t addRow(uint64_t key, uint32_t now);
+    void removeRow(size_t row);
+    void moveRow(size_t from, size_t to);
+    void wheelLink(size_t row, uint32_t granule);
+    void wheelUnlink(size_t row);
+    uint32_t deadlineGranule(size_t row) const;
+    void advanceWheel(uint32_t now);
+    bool evictOldest();
+    void flag(size_t row, ThreatType threat, float score);
+
+    MacTable<uint16_t> _index; // device key (MAC, or cluster of random MACs) -> row
+    Columns _col = {};
+    void *_block = nullptr;
+    size_t _capacity = 0;
+    size_t _rows = 0;
+    uint32_t _threats = 0;
+    uint32_t _expired = 0;
+    uint32_t _evicted = 0;
+    ThreatEngineConfig _config = {};
+
+    uint16_t _wheel[THREAT_WHEEL_SLOTS]; // first row of each bucket
+    uint32_t _wheelGranule = 0;          // last granule (now >> THREAT_WHEEL_SHIFT) processed
+    bool _wheelStarted = false;
+    ThreatHistory _history;
+    EvilTwinDetector _twins;
+    KarmaDetector _karma;
+    DeauthDetector _deauth;
+    ProbeClusters _clusters;
+};
+
+extern ThreatEngine threatEngine;
+
+// Capture/replay handlers driving threatEngine (analysis runs on guardianMillis())
+void threatEngineApply(const GuardianFrame *frames, size_t count);
+void threatEngineAnalyze();
+
+#endif
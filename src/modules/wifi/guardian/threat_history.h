@@ -0,0 +1,61 @@
+#ifndef __GUARDIAN_THREAT_HISTORY_H__
+#define __GUARDIAN_THREAT_HISTORY_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define THREAT_HISTORY_SIZE 64 // summaries kept, oldest are overwritten
+
+/**
+ * @brief What is kept of a transmitter once it is expired from the device table
+ */
+struct ThreatSummary {
+    uint8_t mac[6];
+    uint8_t threat; // ThreatType
+    bool malicious;
+    float peakRisk;
+    uint32_t firstSeen;
+    uint32_t lastSeen;
+    uint32_t beaconCount;
+    uint32_t probeCount;
+    uint32_t deauthCount;
+    uint32_t ssidCount;
+};
+
+/**
+ * @brief Fixed-size ring of expired device summaries, newest first
+ */
+class ThreatHistory {
+public:
+    void clear() {
+        _head = 0;
+        _count = 0;
+        _total = 0;
+    }
+
+    void push(const ThreatSummary &s) {
+        _ring[_head] = s;
+        _head = (_head + 1) % THREAT_HISTORY_SIZE;
+        if (_count < THREAT_HISTORY_SIZE) _count++;
+        _total++;
+    }
+
+    size_t size() const { return _count; }
+    bool empty() const { return _count == 0; }
+    uint32_t total() const { return _total; } // including overwritten ones
+
+    /**
+     * @param i 0 is the most recent summary
+     */
+    const ThreatSummary &at(size_t i) const {
+        return _ring[(_head + THREAT_HISTORY_SIZE - 1 - i) % THREAT_HISTORY_SIZE];
+    }
+
+private:
+    ThreatSummary _ring[THREAT_HISTORY_SIZE];
+    size_t _head = 0;
+    size_t _count = 0;
+    uint32_t _total = 0;
+};
+
+#endif
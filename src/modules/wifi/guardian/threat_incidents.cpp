@@ -0,0 +1,57 @@
+#include "threat_incidents.h"
+
+ThreatIncident *ThreatIncidentStore::record(
+    const uint8_t *mac, ThreatType type, ThreatIncidentDetail detail, float confidence, uint32_t now, bool *created
+) {
+    // A linear scan of 64 entries, detections are rare next to frames
+    for (size_t i = 0; i < _count; i++) {
+        ThreatIncident &incident = _incidents[i];
+        if (incident.type != type || memcmp(incident.mac, mac, 6) != 0) continue;
+        incident.lastSeen = now;
+        incident.hits++;
+        incident.active = true;
+        if (confidence > incident.peakConfidence) incident.peakConfidence = confidence;
+        if (created) *created = false;
+        return &incident;
+    }
+
+    size_t slot = _count;
+    if (_count < THREAT_INCIDENT_CAPACITY) {
+        _count++;
+    } else {
+        slot = 0;
+        for (size_t i = 1; i < _count; i++) {
+            const ThreatIncident &a = _incidents[i];
+            const ThreatIncident &b = _incidents[slot];
+            if (a.active != b.active ? !a.active : (int32_t)(a.lastSeen - b.lastSeen) < 0) slot = i;
+        }
+    }
+
+    ThreatIncident &incident = _incidents[slot];
+    memset(&incident, 0, sizeof(incident));
+    memcpy(incident.mac, mac, 6);
+    incident.type = type;
+    incident.detail = detail;
+    incident.active = true;
+    incident.peakConfidence = confidence;
+    incident.firstSeen = now;
+    incident.lastSeen = now;
+    incident.hits = 1;
+    _total++;
+    if (created) *created = true;
+    return &incident;
+}
+
+void ThreatIncidentStore::deactivate(const uint8_t *mac) {
+    for (size_t i = 0; i < _count; i++) {
+        if (memcmp(_incidents[i].mac, mac, 6) == 0) _incidents[i].active = false;
+    }
+}
+
+size_t ThreatIncidentStore::active() const {
+    size_t n = 0;
+    for (size_t i = 0; i < _count; i++) {
+        if (_incidents[i].active) n++;
+    }
+    return n;
+}
@@ -0,0 +1,80 @@
+#ifndef __GUARDIAN_THREAT_INCIDENTS_H__
+#define __GUARDIAN_THREAT_INCIDENTS_H__
+
+#include "threat_engine.h"
+
+// Incidents raised by the Defense checks and monitors, one per (MAC, ThreatType).
+// Repeated detections (every scan pass re-reports the same rogue AP) update the
+// existing incident instead of adding one, and the store is a fixed array: no
+// heap allocation per event and no growth with uptime. Descriptions are not
+// stored, only what renders them (detail plus parameters) when displayed.
+
+#define THREAT_INCIDENT_CAPACITY 64 // the least recently seen incident makes room, inactive ones first
+
+/**
+ * @brief What raised an incident, selects how its parameters are rendered
+ */
+enum ThreatIncidentDetail {
+    INCIDENT_ENGINE,              // threatEngine confirmed the device, value = risk score
+    INCIDENT_SUSPICIOUS_NETWORK,  // scan: network scored suspicious, ssid
+    INCIDENT_ROGUE_SSID,          // scan: generic hotspot name, ssid
+    INCIDENT_WEAKER_TWIN,         // scan: weaker security than its SSID's other APs, ssid, value = APs
+    INCIDENT_SPOOFED_DEAUTH,      // deauths forged as peer against mac, value = frames/s
+    INCIDENT_LOOKALIKE_SSID,      // scan: imitates a trusted SSID, ssid, value = edit distance
+    INCIDENT_BASELINE_DOWNGRADE,  // learned SSID with weaker security, ssid, value = GUARDIAN_SEC_* now
+    INCIDENT_BASELINE_NEW_BSSID,  // unknown BSSID of a learned SSID, ssid, value = channel
+    INCIDENT_BASELINE_CHANNEL,    // learned AP moved, ssid, value = channel
+    INCIDENT_BASELINE_CHANGED     // learned AP advertises other elements, ssid
+};
+
+struct ThreatIncident {
+    uint8_t mac[6];
+    uint8_t type;   // ThreatType
+    uint8_t detail; // ThreatIncidentDetail
+    bool active;
+    uint8_t peer[6]; // other MAC involved (forged sender), zero if none
+    char ssid[33];
+    float value;
+    float peakConfidence; // 0..1
+    uint32_t firstSeen;
+    uint32_t lastSeen;
+    uint32_t hits;
+};
+
+class ThreatIncidentStore {
+public:
+    void clear() {
+        _count = 0;
+        _total = 0;
+    }
+
+    /**
+     * @brief Adds an incident or refreshes the one for (mac, type)
+     * @param created set to true for a new incident, whose parameters the caller fills in
+     * @return never nullptr, the least recently seen incident is replaced when full
+     */
+    ThreatIncident *record(const uint8_t *mac, ThreatType type, ThreatIncidentDetail detail, float confidence,
+                           uint32_t now, bool *created = nullptr);
+
+    /**
+     * @brief Marks every incident of mac inactive
+     */
+    void deactivate(const uint8_t *mac);
+
+    size_t size() const { return _count; }
+    bool empty() const { return _count == 0; }
+    size_t active() const;
+    uint32_t total() const { return _total; } // incidents created, including replaced ones
+
+    /**
+     * @param i 0 .. size()-1, in no particular order
+     */
+    const ThreatIncident &at(size_t i) const { return _incidents[i]; }
+
+private:
+    ThreatIncident _incidents[THREAT_INCIDENT_CAPACITY];
+    size_t _count = 0;
+    uint32_t _total = 0;
+};
+
+#endif
@@ -0,0 +1,378 @@
+#include "threat_journal.h"
+#include "guardian_stats.h"
+#include "mac_table.h"
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+// Segment jNNNNN.bin holds the records, jNNNNN.blm the Bloom filter of a sealed
+// segment and jNNNNN.tmp a compaction in progress. Ids only grow, the live ones
+// are firstSegment..lastSegment and the last is the one appended to.
+
+#define JOURNAL_SLOTS (JOURNAL_MAX_SEGMENTS + 1) // one more while the oldest wait for compaction
+#define JOURNAL_IDLE_MS 250                      // queue wait of the writer task
+
+static FS *journalFs = nullptr;
+static QueueHandle_t journalQueue = nullptr;
+static SemaphoreHandle_t journalLock = nullptr; // segment files and the state below
+static TaskHandle_t journalTaskHandle = nullptr;
+static volatile bool journalRunning = false;
+static volatile bool journalFlushRequested = false;
+static uint32_t journalPending = 0; // queued or batched, not on flash yet (atomic)
+
+static uint32_t firstSegment = 1;
+static uint32_t lastSegment = 1;
+static uint32_t activeRecords = 0;         // record slots in lastSegment, torn ones included
+static JournalBloom blooms[JOURNAL_SLOTS]; // by segment id % JOURNAL_SLOTS
+static ThreatJournalStats stats;
+
+static String segmentPath(uint32_t id, const char *ext) {
+    char path[32];
+    snprintf(path, sizeof(path), JOURNAL_DIR "/j%05u.%s", (unsigned)id, ext);
+    return String(path);
+}
+
+static JournalBloom &bloomOf(uint32_t id) { return blooms[id % JOURNAL_SLOTS]; }
+
+static uint32_t recordCount(File &file) { return file.size() / JOURNAL_RECORD_SIZE; }
+
+static bool readRecord(File &file, uint32_t index, JournalRecord &rec) {
+    if (!file.seek(index * JOURNAL_RECORD_SIZE)) return false;
+    if (file.read((uint8_t *)&rec, JOURNAL_RECORD_SIZE) != JOURNAL_RECORD_SIZE) return false;
+    return journalValid(rec);
+}
+
+static void writeBloom(uint32_t id) {
+    File file = journalFs->open(segmentPath(id, "blm"), FILE_WRITE);
+    if (!file) return;
+    file.write(bloomOf(id).bits, JOURNAL_BLOOM_BYTES);
+    file.close();
+}
+
+/**
+ * @brief Rebuilds the Bloom filter of a segment from its records
+ * @param torn set when a record is partial or fails its CRC
+ * @return record slots in the segment
+ */
+static uint32_t scanSegment(uint32_t id, bool &torn) {
+    JournalBloom &bloom = bloomOf(id);
+    bloom.clear();
+    torn = false;
+    File file = journalFs->open(segmentPath(id, "bin"), FILE_READ);
+    if (!file) return 0;
+
+    const uint32_t count = recordCount(file);
+    torn = file.size() % JOURNAL_RECORD_SIZE != 0;
+    JournalRecord rec;
+    for (uint32_t i = 0; i < count; i++) {
+        if (readRecord(file, i, rec)) bloom.add(rec.mac);
+        else torn = true;
+    }
+    file.close();
+    return count;
+}
+
+// Sealed segments only need their Bloom file, the records are read on a match
+static void loadBloom(uint32_t id) {
+    File file = journalFs->open(segmentPath(id, "blm"), FILE_READ);
+    if (file) {
+        const bool ok = file.read(bloomOf(id).bits, JOURNAL_BLOOM_BYTES) == JOURNAL_BLOOM_BYTES;
+        file.close();
+        if (ok) return;
+    }
+    bool torn;
+    scanSegment(id, torn);
+    writeBloom(id);
+}
+
+static bool newestRecord(uint32_t id, JournalRecord &rec) {
+    File file = journalFs->open(segmentPath(id, "bin"), FILE_READ);
+    if (!file) return false;
+    bool found = false;
+    for (uint32_t i = recordCount(file); !found && i-- > 0;) found = readRecord(file, i, rec);
+    file.close();
+    return found;
+}
+
+static void dropOldest() {
+    journalFs->remove(segmentPath(firstSegment, "bin"));
+    journalFs->remove(segmentPath(firstSegment, "blm"));
+    firstSegment++;
+}
+
+/**
+ * @brief Merges the two oldest segments, keeping the latest record of every (MAC, type)
+ * @note The merged file replaces the newer segment once complete: a .tmp left by a
+ *       power loss is discarded while the older segment still exists, and taken
+ *       over once it was removed (recoverSegments()).
+ */
+static void compactOldest() {
+    const uint32_t older = firstSegment, newer = firstSegment + 1;
+    MacTable<uint32_t> latest; // incident key -> seq of its latest record
+    if (!journalFs->exists(segmentPath(older, "bin")) || !latest.allocate(2 * JOURNAL_SEGMENT_RECORDS)) {
+        dropOldest();
+        return;
+    }
+
+    JournalRecord rec;
+    for (uint32_t id = older; id <= newer; id++) {
+        File file = journalFs->open(segmentPath(id, "bin"), FILE_READ);
+        if (!file) continue;
+        for (uint32_t i = 0, n = recordCount(file); i < n; i++) {
+            if (!readRecord(file, i, rec)) continue;
+            uint32_t *seq = latest.insertKey(journalIncidentKey(rec));
+            if (seq) *seq = rec.seq;
+        }
+        file.close();
+    }
+
+    // Nothing repeats: merging would not fit a segment, the older one goes
+    if (latest.size() > JOURNAL_SEGMENT_RECORDS) {
+        dropOldest();
+        return;
+    }
+
+    File out = journalFs->open(segmentPath(newer, "tmp"), FILE_WRITE);
+    if (!out) {
+        dropOldest();
+        return;
+    }
+    JournalBloom bloom;
+    bloom.clear();
+    bool ok = true;
+    for (uint32_t id = older; ok && id <= newer; id++) {
+        File file = journalFs->open(segmentPath(id, "bin"), FILE_READ);
+        if (!file) continue;
+        for (uint32_t i = 0, n = recordCount(file); ok && i < n; i++) {
+            if (!readRecord(file, i, rec)) continue;
+            const uint32_t *seq = latest.findKey(journalIncidentKey(rec));
+            if (!seq || *seq != rec.seq) continue;
+            ok = out.write((const uint8_t *)&rec, JOURNAL_RECORD_SIZE) == JOURNAL_RECORD_SIZE;
+            bloom.add(rec.mac);
+        }
+        file.close();
+    }
+    out.close();
+
+    if (!ok) journalFs->remove(segmentPath(newer, "tmp"));
+    dropOldest();
+    if (!ok) return;
+    journalFs->remove(segmentPath(newer, "bin"));
+    journalFs->rename(segmentPath(newer, "tmp"), segmentPath(newer, "bin"));
+    bloomOf(newer) = bloom;
+    writeBloom(newer);
+    stats.compactions++;
+}
+
+// Closes the segment being written, the next append creates a new one
+static void sealSegment() {
+    writeBloom(lastSegment);
+    lastSegment++;
+    activeRecords = 0;
+    bloomOf(lastSegment).clear();
+    while (lastSegment - firstSegment + 1 > JOURNAL_MAX_SEGMENTS) compactOldest();
+}
+
+static void recoverSegments() {
+    uint32_t first = UINT32_MAX, last = 0, tmp = 0;
+    File dir = journalFs->open(JOURNAL_DIR);
+    if (dir) {
+        for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile()) {
+            String name = entry.name();
+            entry.close();
+            name = name.substring(name.lastIndexOf('/') + 1);
+            unsigned id;
+            char ext[4];
+            if (sscanf(name.c_str(), "j%u.%3s", &id, ext) != 2 || id == 0) continue;
+            if (strcmp(ext, "tmp") == 0) tmp = id;
+            if (strcmp(ext, "bin") != 0) continue;
+            if (id < first) first = id;
+            if (id > last) last = id;
+        }
+        dir.close();
+    }
+
+    // A compaction was cut short, see compactOldest()
+    if (tmp) {
+        if (journalFs->exists(segmentPath(tmp - 1, "bin"))) {
+            journalFs->remove(segmentPath(tmp, "tmp"));
+        } else {
+            journalFs->remove(segmentPath(tmp, "bin"));
+            journalFs->remove(segmentPath(tmp, "blm"));
+            journalFs->rename(segmentPath(tmp, "tmp"), segmentPath(tmp, "bin"));
+            if (tmp < first) first = tmp;
+            if (tmp > last) last = tmp;
+        }
+    }
+
+    if (last == 0) first = last = 1;
+    firstSegment = first;
+    lastSegment = last;
+    while (lastSegment - firstSegment + 1 > JOURNAL_MAX_SEGMENTS) dropOldest();
+
+    for (uint32_t id = firstSegment; id < lastSegment; id++) loadBloom(id);
+    bool torn;
+    activeRecords = scanSegment(lastSegment, torn);
+
+    stats.nextSeq = 1;
+    JournalRecord rec;
+    for (uint32_t id = lastSegment; id >= firstSegment; id--) {
+        if (!newestRecord(id, rec)) continue;
+        stats.nextSeq = rec.seq + 1;
+        break;
+    }
+
+    // Appending after a torn record would misalign every record behind it
+    if (torn || activeRecords >= JOURNAL_SEGMENT_RECORDS) sealSegment();
+}
+
+static void appendBatch(JournalRecord *batch, size_t n) {
+    xSemaphoreTake(journalLock, portMAX_DELAY);
+    GUARDIAN_STAT_SCOPE(GUARDIAN_PROBE_JOURNAL);
+    for (size_t i = 0; i < n; i++) {
+        batch[i].seq = stats.nextSeq++;
+        journalSeal(batch[i]);
+    }
+
+    for (size_t done = 0; done < n;) {
+        const size_t room = JOURNAL_SEGMENT_RECORDS - activeRecords;
+        const size_t k = n - done < room ? n - done : room;
+        File file = journalFs->open(segmentPath(lastSegment, "bin"), FILE_APPEND);
+        size_t bytes = 0;
+        if (file) {
+            bytes = file.write((const uint8_t *)&batch[done], k * JOURNAL_RECORD_SIZE);
+            file.close();
+        }
+
+        const size_t whole = bytes / JOURNAL_RECORD_SIZE;
+        for (size_t i = 0; i < whole; i++) bloomOf(lastSegment).add(batch[done + i].mac);
+        activeRecords += whole;
+        stats.written += whole;
+        if (bytes % JOURNAL_RECORD_SIZE || activeRecords >= JOURNAL_SEGMENT_RECORDS) sealSegment();
+        if (whole < k) {
+            stats.failed += n - done - whole;
+            break;
+        }
+        done += k;
+    }
+    xSemaphoreGive(journalLock);
+}
+
+static void journalTask(void *pvParameters) {
+    JournalRecord batch[JOURNAL_BATCH];
+    size_t n = 0;
+    uint32_t oldest = 0; // millis() when batch[0] was queued
+
+    for (;;) {
+        JournalRecord rec;
+        if (xQueueReceive(journalQueue, &rec, pdMS_TO_TICKS(JOURNAL_IDLE_MS)) == pdTRUE) {
+            if (n == 0) oldest = millis();
+            batch[n++] = rec;
+        }
+
+        const bool stopping = !journalRunning;
+        const bool drained = uxQueueMessagesWaiting(journalQueue) == 0;
+        if (n && (n == JOURNAL_BATCH || millis() - oldest >= JOURNAL_FLUSH_MS ||
+                  ((journalFlushRequested || stopping) && drained))) {
+            appendBatch(batch, n);
+            __atomic_fetch_sub(&journalPending, n, __ATOMIC_RELAXED);
+            n = 0;
+        }
+        if (stopping && n == 0 && drained) break;
+    }
+
+    journalTaskHandle = nullptr;
+    vTaskDelete(NULL);
+}
+
+bool threatJournalBegin(FS &fs) {
+    if (journalRunning) return true;
+
+    journalFs = &fs;
+    if (!fs.exists(JOURNAL_DIR) && !fs.mkdir(JOURNAL_DIR)) {
+        Serial.println("[GUARDIAN] Failed to create " JOURNAL_DIR);
+        return false;
+    }
+    if (!journalLock) journalLock = xSemaphoreCreateMutex();
+    if (!journalQueue) journalQueue = xQueueCreate(JOURNAL_QUEUE_DEPTH, sizeof(JournalRecord));
+    if (!journalLock || !journalQueue) {
+        Serial.println("[GUARDIAN] Failed to allocate journal queue");
+        return false;
+    }
+
+    xSemaphoreTake(journalLock, portMAX_DELAY);
+    memset(&stats, 0, sizeof(stats));
+    recoverSegments();
+    xSemaphoreGive(journalLock);
+
+    journalRunning = true;
+    if (xTaskCreate(journalTask, "GuardianJournal", 6144, NULL, 1, &journalTaskHandle) != pdPASS) {
+        Serial.println("[GUARDIAN] Failed to start journal task");
+        journalRunning = false;
+        journalTaskHandle = nullptr;
+        return false;
+    }
+    Serial.printf("[GUARDIAN] Journal: segments %u..%u, next record %u\n", firstSegment, lastSegment,
+                  stats.nextSeq);
+    return true;
+}
+
+void threatJournalEnd() {
+    journalRunning = false;
+    while (journalTaskHandle != nullptr) vTaskDelay(pdMS_TO_TICKS(JOURNAL_IDLE_MS));
+}
+
+bool threatJournalReady() { return journalRunning; }
+
+bool threatJournalAppend(const JournalRecord &rec) {
+    if (!journalRunning) return false;
+    __atomic_fetch_add(&journalPending, 1, __ATOMIC_RELAXED);
+    if (xQueueSend(journalQueue, &rec, 0) != pdTRUE) {
+        __atomic_fetch_sub(&journalPending, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&stats.dropped, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    return true;
+}
+
+void threatJournalFlush(uint32_t timeoutMs) {
+    if (!journalRunning) return;
+    journalFlushRequested = true;
+    const uint32_t start = millis();
+    while (__atomic_load_n(&journalPending, __ATOMIC_RELAXED) != 0 && millis() - start < timeoutMs) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    journalFlushRequested = false;
+}
+
+// Newest first over the live segments, only those whose filter matches mac (if any)
+static size_t collectRecords(const uint8_t *mac, JournalRecord *out, size_t n) {
+    if (!journalLock || !journalFs || n == 0) return 0;
+    xSemaphoreTake(journalLock, portMAX_DELAY);
+    size_t found = 0;
+    for (uint32_t id = lastSegment; found < n && id >= firstSegment; id--) {
+        if (mac && !bloomOf(id).mayContain(mac)) continue;
+        File file = journalFs->open(segmentPath(id, "bin"), FILE_READ);
+        if (!file) continue;
+        for (uint32_t i = recordCount(file); found < n && i-- > 0;) {
+            if (!readRecord(file, i, out[found])) continue;
+            if (mac && memcmp(out[found].mac, mac, 6) != 0) continue;
+            found++;
+        }
+        file.close();
+    }
+    xSemaphoreGive(journalLock);
+    return found;
+}
+
+size_t threatJournalLast(JournalRecord *out, size_t n) { return collectRecords(nullptr, out, n); }
+
+size_t threatJournalFind(const uint8_t *mac, JournalRecord *out, size_t n) { return collectRecords(mac, out, n); }
+
+ThreatJournalStats threatJournalStats() {
+    ThreatJournalStats s = stats;
+    s.segments = lastSegment - firstSegment + 1;
+    return s;
+}
@@ -0,0 +1,75 @@
+#ifndef __GUARDIAN_THREAT_JOURNAL_H__
+#define __GUARDIAN_THREAT_JOURNAL_H__
+
+#include "journal_record.h"
+#include <FS.h>
+
+// Persistent threat journal.
+// Incidents are appended as fixed-size CRC-protected records (journal_record.h)
+// to segment files in JOURNAL_DIR. Producers only enqueue, a background task
+// writes in batches (every JOURNAL_FLUSH_MS or JOURNAL_BATCH records) so flash
+// sees few small writes. A full segment is sealed with a Bloom filter of its
+// MACs next to it; past JOURNAL_MAX_SEGMENTS the two oldest are compacted into
+// one that keeps the latest record of every (MAC, threat type).
+// A power loss loses at most the unwritten batch: a torn record fails its CRC,
+// the segment it ends is sealed at boot and writing resumes in a new one.
+
+#define JOURNAL_DIR "/BruceGuardian"
+#define JOURNAL_SEGMENT_RECORDS 256 // ~19KB per segment
+#define JOURNAL_MAX_SEGMENTS 8
+#define JOURNAL_QUEUE_DEPTH 32      // records waiting for the writer, more are dropped
+#define JOURNAL_BATCH 16            // records written per file open
+#define JOURNAL_FLUSH_MS 5000       // longest a record waits in RAM
+
+struct ThreatJournalStats {
+    uint32_t written;     // records appended this session
+    uint32_t dropped;     // queue full
+    uint32_t failed;      // records lost to write errors
+    uint32_t compactions;
+    uint32_t segments;    // live segment files
+    uint32_t nextSeq;
+};
+
+/**
+ * @brief Recovers the journal in JOURNAL_DIR of fs and starts the writer task
+ * @note Reads only the Bloom files of sealed segments and the segment being written.
+ * @return true if the journal is (already) running
+ */
+bool threatJournalBegin(FS &fs);
+
+/**
+ * @brief Writes what is queued and stops the writer task
+ */
+void threatJournalEnd();
+
+bool threatJournalReady();
+
+/**
+ * @brief Queues rec for writing, seq and crc are set by the writer
+ * @note Never blocks, safe from any task
+ * @return false if the journal is not running or the queue is full
+ */
+bool threatJournalAppend(const JournalRecord &rec);
+
+/**
+ * @brief Writes queued records now, waits at most timeoutMs for it
+ */
+void threatJournalFlush(uint32_t timeoutMs = 1000);
+
+/**
+ * @brief The n most recent records, newest first
+ * @note Records still queued are not included, see threatJournalFlush()
+ * @return number of records stored in out
+ */
+size_t threatJournalLast(JournalRecord *out, size_t n);
+
+/**
+ * @brief The n most recent records of mac, newest first
+ * @note Only segments whose Bloom filter matches mac are read
+ * @return number of records stored in out
+ */
+size_t threatJournalFind(const uint8_t *mac, JournalRecord *out, size_t n);
+
+ThreatJournalStats threatJournalStats();
+
+#endif
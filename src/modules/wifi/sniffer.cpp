@@ -33,6 +33,7 @@
 #include <SdFat.h>
 #endif
 #include "modules/wifi/wifi_atks.h" // to use deauth frames and cmds
+#include "modules/wifi/guardian/ieee80211.h"
 
 //===== SETTINGS =====//
 #define CHANNEL 1
@@ -72,32 +73,10 @@ String filename = "/BrucePCAP/" + (String)FILENAME + ".pcap";
 
 // Handshake detection
 bool isItEAPOL(const wifi_promiscuous_pkt_t *packet) {
-    const uint8_t *payload = packet->payload;
-    int len = packet->rx_ctrl.sig_len;
-
-    // length check to ensure packet is large enough for EAPOL (minimum length)
-    if (len < (24 + 8 + 4)) { // 24 bytes for the MAC header, 8 for LLC/SNAP, 4 for EAPOL minimum
-        return false;
-    }
-
-    // check for LLC/SNAP header indicating EAPOL payload
-    // LLC: AA-AA-03, SNAP: 00-00-00-88-8E for EAPOL
-    if (payload[24] == 0xAA && payload[25] == 0xAA && payload[26] == 0x03 && payload[27] == 0x00 &&
-        payload[28] == 0x00 && payload[29] == 0x00 && payload[30] == 0x88 && payload[31] == 0x8E) {
-        return true;
-    }
-
-    // handle QoS tagging which shifts the start of the LLC/SNAP headers by 2 bytes
-    // check if the frame control field's subtype indicates a QoS data subtype (0x08)
-    if ((payload[0] & 0x0F) == 0x08) {
-        // Adjust for the QoS Control field and recheck for LLC/SNAP header
-        if (payload[26] == 0xAA && payload[27] == 0xAA && payload[28] == 0x03 && payload[29] == 0x00 &&
-            payload[30] == 0x00 && payload[31] == 0x00 && payload[32] == 0x88 && payload[33] == 0x8E) {
-            return true;
-        }
-    }
-
-    return false;
+    // the shared parser handles the addr4, QoS control and HT control shifts of the LLC/SNAP header
+    Ieee80211Frame frame;
+    if (!frame.parse(packet->payload, packet->rx_ctrl.sig_len)) return false;
+    return frame.llcEtherType() == 0x888E; // LLC: AA-AA-03, SNAP: 00-00-00-88-8E for EAPOL
 }
 // Définition de l'en-tête d'un paquet PCAP
 typedef struct pcaprec_hdr_s {
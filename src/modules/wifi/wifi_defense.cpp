@@ -4,13 +4,25 @@
 #include "core/wifi/wifi_common.h"
 #include "esp_wifi.h"
 #include "WiFi.h"
+#include "guardian/guardian_capture.h"
+#include "guardian/guardian_clock.h"
+#include "guardian/guardian_stats.h"
+#include "guardian/baseline_store.h"
+#include "guardian/pcap_replay.h"
+#include "guardian/profile_store.h"
+#include "guardian/scan_checks.h"
+#include "core/sd_functions.h"
+#include "core/oui_db.h"
+#include "core/mykeyboard.h"
+#include "core/led_control.h"
+#include "modules/others/audio.h"
+#include <ArduinoJson.h>
 #include <globals.h>
 
 // Pure Defense System with Advanced Threat Detection
 // Enhanced with existing sophisticated detection algorithms
 
-std::vector<ThreatDetection> activeThreatsList;
-std::vector<AdvancedThreatDevice> trackedDevices;
+ThreatIncidentStore threatIncidents;
 DefenseStats defenseStats = {0};
 bool defenseSystemActive = false;
 bool monitoring = false;
@@ -25,86 +37,16 @@ String getThreatTypeName(ThreatType type) {
         case THREAT_DEAUTH_FLOOD: return "DEAUTH FLOOD";
         case THREAT_PROBE_FLOOD: return "PROBE FLOOD";
         case THREAT_CAPTIVE_PORTAL: return "CAPTIVE PORTAL";
+        case THREAT_ROGUE_AP: return "ROGUE AP";
         default: return "UNKNOWN";
     }
 }
 
 // Advanced packet callback (your existing sophisticated system)
+// Runs in the WiFi driver context: only copies header fields into the capture ring.
 void IRAM_ATTR packetCallback(void* buf, wifi_promiscuous_pkt_type_t type) {
     if(!monitoring || type != WIFI_PKT_MGMT) return;
-    
-    wifi_promiscuous_pkt_t *pkt = (wifi_promiscuous_pkt_t*)buf;
-    
-    // 802.11 frame header structure
-    typedef struct {
-        uint8_t frame_ctrl[2];
-        uint8_t duration[2];
-        uint8_t addr1[6]; // receiver
-        uint8_t addr2[6]; // transmitter/source
-        uint8_t addr3[6]; // BSSID
-        uint8_t seq_ctrl[2];
-    } wifi_header_t;
-    
-    if(pkt->rx_ctrl.sig_len < sizeof(wifi_header_t)) return;
-    
-    wifi_header_t *hdr = (wifi_header_t*)pkt->payload;
-    uint8_t* srcMac = hdr->addr2;
-    
-    // Find or create tracked device
-    AdvancedThreatDevice* device = nullptr;
-    for(auto& d : trackedDevices) {
-        if(memcmp(d.mac, srcMac, 6) == 0) {
-            device = &d;
-            break;
-        }
-    }
-    
-    if(!device && trackedDevices.size() < MAX_TRACKED_DEVICES) {
-        AdvancedThreatDevice newDevice;
-        memcpy(newDevice.mac, srcMac, 6);
-        newDevice.firstSeen = millis();
-        newDevice.lastSeen = millis();
-        newDevice.beaconCount = 0;
-        newDevice.probeCount = 0;
-        newDevice.deauthCount = 0;
-        newDevice.recentBeacons = 0;
-        newDevice.recentProbes = 0;
-        newDevice.recentDeauths = 0;
-        newDevice.windowStart = millis();
-        newDevice.suspectedThreat = THREAT_UNKNOWN;
-        newDevice.riskScore = 0.0;
-        newDevice.isMarkedMalicious = false;
-        
-        trackedDevices.push_back(newDevice);
-        device = &trackedDevices.back();
-    }
-    
-    if(!device) return;
-    
-    device->lastSeen = millis();
-    
-    // Analyze frame type (simplified frame type detection)
-    uint8_t frameType = hdr->frame_ctrl[0] & 0x0C;
-    uint8_t frameSubtype = (hdr->frame_ctrl[0] & 0xF0) >> 4;
-    
-    switch(frameType) {
-        case 0x08: // Management frames
-            switch(frameSubtype) {
-                case 0x08: // Beacon
-                    device->beaconCount++;
-                    device->recentBeacons++;
-                    break;
-                case 0x04: // Probe request
-                    device->probeCount++;
-                    device->recentProbes++;
-                    break;
-                case 0x0C: // Deauth
-                    device->deauthCount++;
-                    device->recentDeauths++;
-                    break;
-            }
-            break;
-    }
+    guardianCapturePush((wifi_promiscuous_pkt_t*)buf);
 }
 
 // Detection thresholds (conservative for accuracy)
@@ -117,8 +59,10 @@ void initDefenseSystem() {
     Serial.println("[DEFENSE] Initializing WiFi Defense System");
     
     // Clear any previous state
-    activeThreatsList.clear();
+    threatIncidents.clear();
     memset(&defenseStats, 0, sizeof(defenseStats));
+    openThreatJournal();
+    detectionProfilesBegin();
     
     // Initialize WiFi in monitor mode for passive scanning
     WiFi.mode(WIFI_STA);
@@ -135,21 +79,32 @@ void startThreatMonitoring() {
     if (!defenseSystemActive) {
         initDefenseSystem();
     }
+    if (!scanSnapshotBegin()) {
+        displayError("Out of memory");
+        return;
+    }
     
     displayStatus("Monitoring threats...");
     Serial.println("[DEFENSE] Starting threat monitoring");
     
     unsigned long monitorStart = millis();
+    startThreatAlerts();
     
     while (defenseSystemActive) {
-        analyzeNetworkTraffic();
-        detectRogueAccessPoints(); 
-        checkForEvilTwins();
-        assessKarmaThreats();
-        monitorCaptivePortals();
+        // Scans run in the background, the checks run once per completed scan
+        if (scanSnapshotPoll()) {
+            const ScanSnapshot& snapshot = *scanSnapshotLatest();
+            analyzeNetworkTraffic(snapshot);
+            detectRogueAccessPoints(snapshot);
+            checkForEvilTwins(snapshot);
+            assessKarmaThreats();
+            monitorCaptivePortals();
+        }
         
-        // Update display every 2 seconds
-        if (millis() - defenseStats.lastUpdate > MONITORING_INTERVAL_MS) {
+        // Update display every 2 seconds, right away once the last alert is gone
+        if (serviceThreatAlerts()) {
+            defenseStats.lastUpdate = millis() - MONITORING_INTERVAL_MS - 1;
+        } else if (millis() - defenseStats.lastUpdate > MONITORING_INTERVAL_MS) {
             displayDefenseStatus();
             defenseStats.lastUpdate = millis();
             defenseStats.activeMonitorTime = millis() - monitorStart;
@@ -163,145 +118,136 @@ void startThreatMonitoring() {
         delay(100); // Small delay to prevent overwhelming
     }
     
+    scanSnapshotEnd();
     displayStatus("Monitoring stopped");
 }
 
-void analyzeNetworkTraffic() {
+// Copies the SSID parameter of a scan incident
+static void setIncidentSsid(ThreatIncident* incident, const ScanAp& ap) {
+    memcpy(incident->ssid, ap.ssid, ap.ssidLen);
+    incident->ssid[ap.ssidLen] = '\0';
+}
+
+void analyzeNetworkTraffic(const ScanSnapshot& snapshot) {
     // Passive analysis only - no packet injection or attacks
-    int networksFound = WiFi.scanNetworks();
-    defenseStats.networksScanned += networksFound;
+    defenseStats.networksScanned += snapshot.found;
     
-    for (int i = 0; i < networksFound; i++) {
-        wifi_ap_record_t ap;
-        memset(&ap, 0, sizeof(ap));
+    for (uint16_t i = 0; i < snapshot.count; i++) {
+        const ScanAp& ap = snapshot.aps[i];
+        uint8_t bssid[6];
+        memcpy(bssid, ap.bssid, 6);
         
-        // Get basic AP info (passive scan only)
-        String ssid = WiFi.SSID(i);
-        int rssi = WiFi.RSSI(i);
-        uint8_t* bssid = WiFi.BSSID(i);
-        
-        // Analyze for suspicious patterns
-        if (isNetworkSuspicious(nullptr)) { // Pass actual AP data in real implementation
-            ThreatDetection threat;
-            memcpy(threat.sourceMac, bssid, 6);
-            threat.type = THREAT_ROGUE_AP;
-            threat.confidenceLevel = calculateThreatScore(bssid);
-            threat.detectedAt = millis();
-            threat.description = "Suspicious network: " + ssid;
-            threat.recommendedAction = DEFENSE_ALERT;
-            threat.isActive = true;
-            
-            // Add to threat list if confidence is high enough
-            if (threat.confidenceLevel > EVIL_PORTAL_CONFIDENCE_THRESHOLD) {
-                activeThreatsList.push_back(threat);
+        // Record the incident if confidence is high enough, alert the first time only
+        const float confidence = calculateThreatScore(bssid);
+        if (confidence > EVIL_PORTAL_CONFIDENCE_THRESHOLD) {
+            bool created;
+            ThreatIncident* incident = threatIncidents.record(bssid, THREAT_ROGUE_AP, INCIDENT_SUSPICIOUS_NETWORK,
+                                                              confidence, millis(), &created);
+            if (created) {
+                setIncidentSsid(incident, ap);
                 defenseStats.threatsDetected++;
-                alertUser(threat);
+                alertUser(*incident);
+                logThreatIncident(*incident);
             }
         }
     }
 }
 
-void detectRogueAccessPoints() {
+static void reportRogueAp(const ScanSnapshot& snapshot, const ScanFinding& finding) {
+    const ScanAp& ap = snapshot.aps[finding.ap];
+    
+    bool created;
+    ThreatIncident* incident = threatIncidents.record(ap.bssid, finding.type, INCIDENT_ROGUE_SSID,
+                                                      finding.confidence, millis(), &created);
+    if (!created) return; // seen on an earlier scan
+    setIncidentSsid(incident, ap);
+    defenseStats.threatsDetected++;
+    alertUser(*incident);
+    logThreatIncident(*incident);
+    Serial.printf("[DEFENSE] Potential rogue AP detected: %s (signature \"%s\")\n", ap.ssid,
+                  ssidSignatures().signature(finding.related).pattern);
+}
+
+void detectRogueAccessPoints(const ScanSnapshot& snapshot) {
     Serial.println("[DEFENSE] Scanning for rogue access points...");
     
-    // Look for common rogue AP indicators:
-    // - Generic/default SSIDs
-    // - Unusual signal patterns  
-    // - Multiple APs with similar names
-    // - Captive portal signatures
+    // Signatures reloaded from the serial console take effect here, between two scans
+    if(!ssidSignaturesApply()) Serial.println("[DEFENSE] Not enough memory for the user signatures");
     
+    // Look for common rogue AP indicators (guardian/scan_checks.h):
+    // - Generic/default SSIDs, the rogue signatures of guardian/ssid_matcher.h
     // This is passive detection only - no attacks performed
-    std::set<String> commonRogueSSIDs = {
-        "FreeWiFi", "Free WiFi", "WiFi", "Internet", 
-        "Guest", "Public", "Open", "Hotspot"
-    };
+    scanCheckRogueAps(snapshot, ssidSignatures(), reportRogueAp);
+}
+
+static void reportEvilTwin(const ScanSnapshot& snapshot, const ScanFinding& finding) {
+    const ScanAp& ap = snapshot.aps[finding.ap];
     
-    int networkCount = WiFi.scanNetworks();
+    bool created;
+    ThreatIncident* incident = threatIncidents.record(ap.bssid, finding.type, INCIDENT_WEAKER_TWIN,
+                                                      finding.confidence, millis(), &created);
+    incident->value = finding.related;
+    if (!created) return; // seen on an earlier scan
+    setIncidentSsid(incident, ap);
+    defenseStats.threatsDetected++;
+    alertUser(*incident);
+    logThreatIncident(*incident);
+    Serial.printf("[DEFENSE] Weaker security than the other APs of SSID: %s (%d APs)\n", ap.ssid, finding.related);
+}
+
+static SsidTrustList trustedSsids; // refreshed by trustedNetworks()
+
+static void reportLookalike(const ScanSnapshot& snapshot, const ScanFinding& finding) {
+    const ScanAp& ap = snapshot.aps[finding.ap];
     
-    for (int i = 0; i < networkCount; i++) {
-        String ssid = WiFi.SSID(i);
-        String lowerSSID = ssid;
-        lowerSSID.toLowerCase();
-        
-        // Check against known rogue patterns
-        for (const String& roguePattern : commonRogueSSIDs) {
-            if (lowerSSID.indexOf(roguePattern.c_str()) >= 0) {
-                Serial.printf("[DEFENSE] Potential rogue AP detected: %s\n", ssid.c_str());
-                
-                ThreatDetection threat;
-                uint8_t* bssid = WiFi.BSSID(i);
-                memcpy(threat.sourceMac, bssid, 6);
-                threat.type = THREAT_ROGUE_AP;
-                threat.confidenceLevel = 0.6f; // Medium confidence for pattern match
-                threat.detectedAt = millis();
-                threat.description = "Rogue AP pattern: " + ssid;
-                threat.recommendedAction = DEFENSE_ALERT;
-                threat.isActive = true;
-                
-                activeThreatsList.push_back(threat);
-                defenseStats.threatsDetected++;
-                break;
-            }
-        }
+    bool created;
+    ThreatIncident* incident = threatIncidents.record(ap.bssid, finding.type, INCIDENT_LOOKALIKE_SSID,
+                                                      finding.confidence, millis(), &created);
+    if (!created) return; // seen on an earlier scan
+    uint8_t distance = 0;
+    trustedSsids.lookalike(ap.ssid, ap.ssidLen, &distance);
+    incident->value = distance;
+    setIncidentSsid(incident, ap);
+    defenseStats.threatsDetected++;
+    alertUser(*incident);
+    logThreatIncident(*incident);
+    Serial.printf("[DEFENSE] Lookalike of trusted SSID %s: %s\n", trustedSsids.ssid(finding.related), ap.ssid);
+}
+
+const SsidTrustList& trustedNetworks() {
+    // Rebuilt on every call, the saved networks change from the WiFi menus
+    trustedSsids.clear();
+    for (const auto& network : bruceConfig.wifi) {
+        trustedSsids.add(network.first.c_str(), network.first.length());
     }
+    return trustedSsids;
 }
 
-void checkForEvilTwins() {
+void checkForEvilTwins(const ScanSnapshot& snapshot) {
     Serial.println("[DEFENSE] Checking for evil twin networks...");
     
     // Detect potential evil twins by looking for:
-    // - Multiple APs with same SSID but different BSSIDs
-    // - Similar SSIDs with slight variations
-    // - Unusually strong signals from unknown APs
-    
-    std::map<String, std::vector<uint8_t*>> ssidToMacs;
-    int networkCount = WiFi.scanNetworks();
-    
-    // Group networks by SSID
-    for (int i = 0; i < networkCount; i++) {
-        String ssid = WiFi.SSID(i);
-        uint8_t* bssid = WiFi.BSSID(i);
-        
-        if (ssidToMacs.find(ssid) == ssidToMacs.end()) {
-            ssidToMacs[ssid] = std::vector<uint8_t*>();
-        }
-        ssidToMacs[ssid].push_back(bssid);
-    }
-    
-    // Check for suspicious duplicates
-    for (auto& pair : ssidToMacs) {
-        if (pair.second.size() > 1) {
-            Serial.printf("[DEFENSE] Multiple APs found for SSID: %s (%d APs)\n", 
-                         pair.first.c_str(), pair.second.size());
-            
-            // This could indicate evil twin attack
-            for (uint8_t* mac : pair.second) {
-                ThreatDetection threat;
-                memcpy(threat.sourceMac, mac, 6);
-                threat.type = THREAT_EVIL_PORTAL;
-                threat.confidenceLevel = 0.7f;
-                threat.detectedAt = millis();
-                threat.description = "Possible evil twin: " + pair.first;
-                threat.recommendedAction = DEFENSE_ALERT;
-                threat.isActive = true;
-                
-                activeThreatsList.push_back(threat);
-                defenseStats.threatsDetected++;
-            }
-        }
-    }
+    // - APs with the same SSID but weaker security than the others
+    // - SSIDs imitating a saved network ("H0me-WiFi" for "HomeWiFi")
+    // Beacon fingerprints of the Advanced Threat Monitor catch the subtler ones
+    scanCheckEvilTwins(snapshot, reportEvilTwin);
+    scanCheckLookalikes(snapshot, trustedNetworks(), reportLookalike);
 }
 
 void assessKarmaThreats() {
     Serial.println("[DEFENSE] Assessing Karma attack indicators...");
     
-    // Look for Karma attack patterns:
-    // - APs responding to unusual probe requests
-    // - Generic SSIDs that match common networks
-    // - Rapid SSID changes from same BSSID
-    
-    // This is passive monitoring only
-    // Real implementation would track probe responses over time
+    // Karma needs probe requests and responses, which only the capture sees:
+    // threatEngine correlates them (guardian/karma.h) and reports through its hooks.
+    // This summarizes what the last capture found.
+    const KarmaDetector& karma = threatEngine.karma();
+    int karmaAps = 0;
+    for (size_t i = 0; i < threatEngine.size(); i++) {
+        const ThreatDevice device = threatEngine.device(i);
+        if (device.isMarkedMalicious && device.suspectedThreat == THREAT_KARMA_ATTACK) karmaAps++;
+    }
+    Serial.printf("[DEFENSE] Karma: %d APs answering for foreign SSIDs (%u directed probes, %u answers)\n",
+                  karmaAps, karma.probes(), karma.answers());
 }
 
 void monitorCaptivePortals() {
@@ -316,127 +262,156 @@ void monitorCaptivePortals() {
     // Implementation depends on network access
 }
 
-// Advanced threat analysis (your sophisticated detection algorithms)
-void analyzeTrackedDevices() {
-    unsigned long currentTime = millis();
+static String formatMac(const uint8_t* mac) {
+    String str = "";
+    for(int i = 0; i < 6; i++) {
+        if(i > 0) str += ":";
+        if(mac[i] < 16) str += "0";
+        str += String(mac[i], HEX);
+    }
+    return str;
+}
+
+// Threat engine hooks of the Guardian monitor (run on the capture drain task)
+static void reportGuardianThreat(const ThreatDevice& device) {
+    totalThreats++;
+    defenseStats.threatsDetected++;
     
-    for(auto& device : trackedDevices) {
-        // Reset risk score for fresh analysis
-        float oldRiskScore = device.riskScore;
-        device.riskScore = 0.0;
-        
-        // Skip if device hasn't been seen recently
-        if(currentTime - device.lastSeen > 30000) continue;
-        
-        // Calculate rates within the sliding window
-        float windowSeconds = (currentTime - device.windowStart) / 1000.0;
-        if(windowSeconds < 0.1) windowSeconds = 0.1; // Prevent division by zero
-        
-        float totalTimeSeconds = (currentTime - device.firstSeen) / 1000.0;
-        if(totalTimeSeconds < 0.1) totalTimeSeconds = 0.1;
-        
-        float recentBeaconRate = device.recentBeacons / windowSeconds;
-        float recentProbeRate = device.recentProbes / windowSeconds; 
-        float recentDeauthRate = device.recentDeauths / windowSeconds;
-        
-        float totalBeaconRate = device.beaconCount / totalTimeSeconds;
-        
-        // Detection Algorithm 1: High beacon rate (classic beacon spam)
-        if(recentBeaconRate > BEACON_SPAM_THRESHOLD) {
-            device.riskScore += 4.0;
-            device.suspectedThreat = THREAT_BEACON_SPAM;
-        }
-                    
-        // Detection Algorithm 2: Rapid beacon increase (attack starting)
-        if(recentBeaconRate > totalBeaconRate * 2 && recentBeaconRate > 1.5) {
-            device.riskScore += 3.0;
-            if(device.suspectedThreat == THREAT_UNKNOWN) {
-                device.suspectedThreat = THREAT_BEACON_SPAM;
-            }
-        }
-        
-        // Detection Algorithm 3: Deauth flood attack
-        if(recentDeauthRate > DEAUTH_ATTACK_THRESHOLD) {
-            device.riskScore += 5.0;
-            device.suspectedThreat = THREAT_DEAUTH_FLOOD;
-        }
-        
-        // Detection Algorithm 4: Probe request flood  
-        if(recentProbeRate > PROBE_FLOOD_THRESHOLD) {
-            device.riskScore += 4.0;
-            device.suspectedThreat = THREAT_PROBE_FLOOD;
-        }
-        
-        // Detection Algorithm 5: Multiple SSID advertisement (evil twin/karma)
-        if(device.advertisedSSIDs.size() > 2) {
-            device.riskScore += 3.0;
-            if(device.suspectedThreat == THREAT_UNKNOWN) {
-                device.suspectedThreat = THREAT_EVIL_TWIN;
-            }
-        }
-        
-        // Detection Algorithm 6: Very high activity
-        if(recentBeaconRate > 10 || recentProbeRate > 8 || device.recentBeacons > 20) {
-            device.riskScore += 2.0;
-        }
-        
-        // Detection Algorithm 7: Burst pattern detection
-        if(device.recentBeacons + device.recentProbes + device.recentDeauths > 15) {
-            device.riskScore += 2.0;
-        }
-        
-        // Log analysis for debugging
-        if(device.riskScore > 0.5 || device.recentBeacons > 5) {
-            String mac = "";
-            for(int i = 0; i < 6; i++) {
-                if(i > 0) mac += ":";
-                if(device.mac[i] < 16) mac += "0";
-                mac += String(device.mac[i], HEX);
-            }
-            Serial.printf("THREAT ANALYSIS: %s - B:%.1f P:%.1f D:%.1f Risk:%.1f %s\n",
-                         mac.c_str(), recentBeaconRate, recentProbeRate, recentDeauthRate, 
-                         device.riskScore, getThreatTypeName(device.suspectedThreat).c_str());
-        }
-        
-        // Mark as malicious if risk score exceeds threshold
-        if(device.riskScore >= ATTACK_DETECTION_THRESHOLD && !device.isMarkedMalicious) {
-            device.isMarkedMalicious = true;
-            totalThreats++;
-            defenseStats.threatsDetected++;
-            
-            String mac = "";
-            for(int i = 0; i < 6; i++) {
-                if(i > 0) mac += ":";
-                if(device.mac[i] < 16) mac += "0";
-                mac += String(device.mac[i], HEX);
-            }
-            Serial.println("🛡️ THREAT DETECTED: " + getThreatTypeName(device.suspectedThreat) + 
-                          " from " + mac + " (Risk: " + String(device.riskScore, 1) + ")");
-            
-            // Add to active threats list
-            ThreatDetection threat;
-            memcpy(threat.sourceMac, device.mac, 6);
-            threat.type = device.suspectedThreat;
-            threat.confidenceLevel = min(device.riskScore / 10.0f, 1.0f); // Normalize to 0-1
-            threat.detectedAt = millis();
-            threat.description = getThreatTypeName(device.suspectedThreat) + " detected";
-            threat.recommendedAction = DEFENSE_ALERT;
-            threat.isActive = true;
-            
-            activeThreatsList.push_back(threat);
-        }
+    Serial.println("🛡️ THREAT DETECTED: " + getThreatTypeName(device.suspectedThreat) + 
+                  " from " + formatMac(device.mac) + " (Risk: " + String(device.riskScore, 1) + ")");
+    
+    // Confidence is the risk score normalized to 0-1
+    bool created;
+    ThreatIncident* incident = threatIncidents.record(device.mac, device.suspectedThreat, INCIDENT_ENGINE,
+                                                      min(device.riskScore / 10.0f, 1.0f), guardianMillis(), &created);
+    incident->value = device.riskScore;
+    if (created) logThreatIncident(*incident);
+    alertUser(*incident);
+}
+
+// The transmitter went quiet and left the table, its threats are no longer active
+static void expireGuardianDevice(const ThreatDevice& device) {
+    threatIncidents.deactivate(device.mac);
+}
+
+// Spoofed deauths: the threat is recorded against the targeted station, not the forged AP
+static void reportGuardianDeauthFlood(const DeauthFlood& flood) {
+    totalThreats++;
+    defenseStats.threatsDetected++;
+    
+    Serial.println("🛡️ THREAT DETECTED: DEAUTH FLOOD on " + formatMac(flood.target) +
+                  " spoofing " + formatMac(flood.spoofed) + " (" + String(flood.rate, 1) + "/s)");
+    
+    bool created;
+    ThreatIncident* incident = threatIncidents.record(flood.target, THREAT_DEAUTH_FLOOD, INCIDENT_SPOOFED_DEAUTH,
+                                                      min(flood.rate / 10.0f, 1.0f), guardianMillis(), &created);
+    memcpy(incident->peer, flood.spoofed, 6);
+    incident->value = flood.rate;
+    if (created) logThreatIncident(*incident);
+    alertUser(*incident);
+}
+
+// Learned networks (guardian/network_baseline.h), only allocated while a monitor or training runs
+static NetworkBaseline networkBaseline;
+
+// Compact name of GUARDIAN_SEC_* bits, e.g. "WPA2/WPA3 TKIP"
+static String securityName(uint16_t sec) {
+    if (!(sec & GUARDIAN_SEC_PRIVACY)) return "Open";
+    if (!(sec & (GUARDIAN_SEC_RSN | GUARDIAN_SEC_WPA))) return "WEP";
+    String name;
+    if (!(sec & GUARDIAN_SEC_RSN)) name = "WPA";
+    else if (sec & GUARDIAN_SEC_8021X) name = "WPA2-Ent";
+    else if (!(sec & GUARDIAN_SEC_SAE)) name = (sec & GUARDIAN_SEC_WPA) ? "WPA/WPA2" : "WPA2";
+    else name = (sec & GUARDIAN_SEC_PSK) ? "WPA2/WPA3" : "WPA3";
+    if (sec & GUARDIAN_SEC_TKIP) name += " TKIP";
+    return name;
+}
+
+// A beacon that breaks the baseline: named after what changed, on the AP it came from
+static void reportBaselineDeviation(const BaselineDeviation& deviation) {
+    ThreatIncidentDetail detail;
+    ThreatType type = THREAT_EVIL_TWIN;
+    float confidence;
+    float value = 0;
+    String what;
+    switch (deviation.kind) {
+        case BASELINE_DOWNGRADE:
+            detail = INCIDENT_BASELINE_DOWNGRADE;
+            confidence = 0.9f;
+            value = deviation.security;
+            what = "security downgrade " + securityName(deviation.learnedSecurity) + " > " + securityName(deviation.security);
+            break;
+        case BASELINE_NEW_BSSID:
+            detail = INCIDENT_BASELINE_NEW_BSSID;
+            type = THREAT_ROGUE_AP;
+            confidence = 0.5f;
+            value = deviation.channel;
+            what = "new BSSID on ch " + String(deviation.channel);
+            break;
+        case BASELINE_CHANNEL:
+            detail = INCIDENT_BASELINE_CHANNEL;
+            confidence = 0.4f;
+            value = deviation.channel;
+            what = "moved from ch " + String(deviation.learnedChannel) + " to " + String(deviation.channel);
+            break;
+        default:
+            detail = INCIDENT_BASELINE_CHANGED;
+            confidence = 0.6f;
+            what = "advertises other elements";
+            break;
     }
+    totalThreats++;
+    defenseStats.threatsDetected++;
     
-    // Reset window counters periodically
-    unsigned long currentTime_window = millis();
-    for(auto& device : trackedDevices) {
-        if(currentTime_window - device.windowStart > SHORT_WINDOW_MS) {
-            device.recentBeacons = 0;
-            device.recentProbes = 0;  
-            device.recentDeauths = 0;
-            device.windowStart = currentTime_window;
-        }
+    char ssid[33];
+    memcpy(ssid, deviation.ssid, deviation.ssidLen);
+    ssid[deviation.ssidLen] = '\0';
+    Serial.println("🛡️ BASELINE: " + String(ssid) + " " + formatMac(deviation.bssid) + " " + what);
+    
+    bool created;
+    ThreatIncident* incident = threatIncidents.record(deviation.bssid, type, detail, confidence, guardianMillis(), &created);
+    // One incident per AP and threat type: it shows, and journals, the latest deviation
+    const bool changed = created || incident->detail != detail;
+    incident->detail = detail;
+    incident->value = value;
+    memcpy(incident->ssid, ssid, deviation.ssidLen + 1);
+    if (changed) logThreatIncident(*incident);
+    alertUser(*incident);
+}
+
+// Loads the learned networks for the monitor, beacons are then diffed against them
+static void attachBaseline(ThreatEngineConfig& config) {
+    FS *fs;
+    if (!getFsStorage(fs) || !fs->exists(NETWORK_BASELINE_FILE) || !networkBaseline.begin()) return;
+    if (!networkBaselineLoad(*fs, networkBaseline) || networkBaseline.aps() == 0) {
+        networkBaseline.end();
+        return;
     }
+    config.baseline = &networkBaseline;
+    config.onBaselineDeviation = reportBaselineDeviation;
+    Serial.printf("[BRUCE GUARDIAN] Baseline: %u APs in %u SSIDs\n",
+                  (unsigned)networkBaseline.aps(), (unsigned)networkBaseline.ssids());
+}
+
+static const ThreatEngineConfig guardianEngineConfig = {
+    THREAT_STALE_MS, // replaced by the detection profile's, see guardianConfig()
+    THREAT_EXPIRE_MS,
+    reportGuardianThreat,
+    nullptr, // no trace: a serial line per AP and pass would bound analysis by the UART
+    expireGuardianDevice,
+    reportGuardianDeauthFlood,
+    nullptr, // see attachBaseline()
+    nullptr
+};
+
+// Staleness is fixed for a monitor run, the rule thresholds follow profile changes live.
+// The caller releases the baseline it may attach, networkBaseline.end()
+static ThreatEngineConfig guardianConfig() {
+    detectionProfilesBegin();
+    ThreatEngineConfig config = guardianEngineConfig;
+    config.staleMs = detectionProfile().staleMs;
+    attachBaseline(config);
+    return config;
 }
 
 float calculateThreatScore(uint8_t* mac) {
@@ -453,31 +428,118 @@ float calculateThreatScore(uint8_t* mac) {
     return score;
 }
 
-void alertUser(ThreatDetection threat) {
-    // Alert user to detected threat (non-intrusive)
-    Serial.printf("[DEFENSE ALERT] %s detected from ", 
-                  (threat.type == THREAT_EVIL_PORTAL) ? "Evil Portal" :
-                  (threat.type == THREAT_KARMA_ATTACK) ? "Karma Attack" :
-                  (threat.type == THREAT_ROGUE_AP) ? "Rogue AP" : "Unknown Threat");
+String describeThreatIncident(const ThreatIncident& incident) {
+    switch (incident.detail) {
+        case INCIDENT_SUSPICIOUS_NETWORK: return "Suspicious network: " + String(incident.ssid);
+        case INCIDENT_ROGUE_SSID: return "Rogue AP pattern: " + String(incident.ssid);
+        case INCIDENT_WEAKER_TWIN: return "Possible evil twin: " + String(incident.ssid);
+        case INCIDENT_SPOOFED_DEAUTH: return "Spoofed deauth flood (as " + formatMac(incident.peer) + ")";
+        case INCIDENT_LOOKALIKE_SSID: return "Lookalike SSID: " + String(incident.ssid);
+        case INCIDENT_BASELINE_DOWNGRADE: return "Downgraded: " + String(incident.ssid) + " now " + securityName((uint16_t)incident.value);
+        case INCIDENT_BASELINE_NEW_BSSID: return "New AP of " + String(incident.ssid) + " (ch " + String((int)incident.value) + ")";
+        case INCIDENT_BASELINE_CHANNEL: return String(incident.ssid) + " moved to ch " + String((int)incident.value);
+        case INCIDENT_BASELINE_CHANGED: return "AP of " + String(incident.ssid) + " changed";
+        default: return getThreatTypeName((ThreatType)incident.type) + " detected";
+    }
+}
+
+// Alerts (guardian/alert_queue.h): detections queue them from the scan loop or the
+// capture drain task, the monitor loop shows them and the sink task beeps and blinks.
+static GuardianAlertQueue alertQueue;
+static portMUX_TYPE alertLock = portMUX_INITIALIZER_UNLOCKED;
+static QueueHandle_t alertSinkQueue = nullptr;
+static uint32_t alertShownAt = 0;
+static bool alertShowing = false;
+
+#define ALERT_DISPLAY_MS 2000
+#define ALERT_SINK_DEPTH 4 // alerts waiting for the LED/buzzer, more skip them
+
+// Serial, LED and buzzer run here: blinkLed() and the speaker tone block their caller
+static void alertSinkTask(void*) {
+    GuardianAlert alert;
+    while (true) {
+        if (xQueueReceive(alertSinkQueue, &alert, portMAX_DELAY) != pdTRUE) continue;
+        const ThreatIncident& threat = alert.incident;
+        Serial.printf("[DEFENSE ALERT] %s detected from %s (x%u)\n",
+                      getThreatTypeName((ThreatType)threat.type).c_str(), formatMac(threat.mac).c_str(), alert.merged);
+#if defined(BUZZ_PIN) || defined(HAS_NS4168_SPKR)
+        _tone(alert.priority >= 300 ? 2500 : 1500, 120);
+#endif
+        blinkLed(100);
+    }
+}
+
+void startThreatAlerts() {
+    portENTER_CRITICAL(&alertLock);
+    alertQueue.clear();
+    portEXIT_CRITICAL(&alertLock);
+    alertShowing = false;
     
-    for (int i = 0; i < 6; i++) {
-        Serial.printf("%02X", threat.sourceMac[i]);
-        if (i < 5) Serial.print(":");
+    if (alertSinkQueue) return;
+    alertSinkQueue = xQueueCreate(ALERT_SINK_DEPTH, sizeof(GuardianAlert));
+    if (alertSinkQueue && xTaskCreate(alertSinkTask, "GuardianAlert", 4096, nullptr, 1, nullptr) != pdPASS) {
+        vQueueDelete(alertSinkQueue);
+        alertSinkQueue = nullptr;
     }
-    Serial.println();
+}
+
+// Only queues the alert: never blocks, safe from the capture drain task
+void alertUser(const ThreatIncident& threat) {
+    // Replayed captures are reviewed on the status screen, not alerted
+    if (guardianClockIsVirtual()) return;
+    
+    const uint32_t now = millis();
+    portENTER_CRITICAL(&alertLock);
+    alertQueue.push(threat, now);
+    portEXIT_CRITICAL(&alertLock);
+}
+
+bool serviceThreatAlerts() {
+    const uint32_t now = millis();
+    if (alertShowing && now - alertShownAt < ALERT_DISPLAY_MS) return true;
     
-    // Display on screen
+    GuardianAlert alert;
+    size_t waiting;
+    portENTER_CRITICAL(&alertLock);
+    const bool popped = alertQueue.pop(alert, now);
+    waiting = alertQueue.size();
+    portEXIT_CRITICAL(&alertLock);
+    alertShowing = popped;
+    if (!popped) return false;
+    alertShownAt = now;
+    if (alertSinkQueue) xQueueSend(alertSinkQueue, &alert, 0);
+    
+    const ThreatIncident& threat = alert.incident;
     tft.fillScreen(TFT_RED);
     tft.setTextColor(TFT_WHITE);
     tft.setTextSize(1);
     tft.setCursor(5, 20);
     tft.println("THREAT DETECTED!");
     tft.setCursor(5, 40);
-    tft.println(threat.description);
+    tft.println(describeThreatIncident(threat));
     tft.setCursor(5, 60);
-    tft.printf("Confidence: %.1f%%", threat.confidenceLevel * 100);
-    
-    delay(2000); // Show alert for 2 seconds
+    tft.printf("Confidence: %.1f%%", threat.peakConfidence * 100);
+    tft.setCursor(5, 80);
+    tft.print(formatMac(threat.mac));
+    if (alert.merged > 1) tft.printf(" x%u", alert.merged);
+    // Vendor from the offline OUI table (core/oui_db.h), here on the UI task that owns the card
+    char vendor[32];
+    if (ouiLookup(threat.mac, vendor, sizeof(vendor))) {
+        tft.setCursor(5, 90);
+        tft.print(vendor);
+    }
+    if (waiting) {
+        tft.setCursor(5, 100);
+        tft.printf("+%u more alerts", (unsigned)waiting);
+    }
+    return true;
+}
+
+GuardianAlertStats threatAlertStats() {
+    portENTER_CRITICAL(&alertLock);
+    GuardianAlertStats stats = alertQueue.stats();
+    portEXIT_CRITICAL(&alertLock);
+    return stats;
 }
 
 void displayDefenseStatus() {
@@ -498,13 +560,77 @@ void displayDefenseStatus() {
     tft.printf("Uptime: %ds", defenseStats.activeMonitorTime / 1000);
     
     tft.setCursor(5, 90);
-    tft.printf("Active: %d", activeThreatsList.size());
+    tft.printf("Active: %d", threatIncidents.active());
     
     tft.setTextColor(TFT_YELLOW);
     tft.setCursor(5, 110);
     tft.println("ESC=Exit");
 }
 
+// Thresholds of the active detection profile, one key per line
+static void showDetectionProfile() {
+    const DetectionProfile& profile = detectionProfile();
+    tft.fillScreen(TFT_BLACK);
+    tft.setTextColor(TFT_GREEN);
+    tft.setTextSize(1);
+    tft.setCursor(5, 5);
+    tft.printf("Profile: %s", profile.name);
+    tft.drawLine(5, 18, tft.width()-5, 18, TFT_GREEN);
+    
+    tft.setTextColor(TFT_WHITE);
+    int yPos = 24;
+    for (size_t k = 0; k < detectionProfileKeyCount(); k++) {
+        tft.setCursor(5, yPos);
+        tft.printf("%-15s %u", detectionProfileKey(k), detectionProfileGet(profile, k));
+        yPos += 10;
+    }
+    
+    tft.setTextColor(TFT_YELLOW);
+    tft.setCursor(5, tft.height() - 10);
+    tft.print(DETECTION_PROFILES_FILE);
+    waitForKeyPress();
+}
+
+// Detection profile picker (guardian/profile_store.h), the choice is kept in the profile file
+void configureDefenseSettings() {
+    detectionProfilesBegin();
+    bool done = false;
+    while (!done) {
+        const String active = detectionProfile().name;
+        bool picked = false;
+        options = {};
+        for (const String& name : detectionProfileNames()) {
+            options.emplace_back((name == active ? "* " : "  ") + name, [=, &picked]() {
+                picked = true;
+                if (!detectionProfileSelect(name.c_str())) displayError("Profile not loaded", true);
+            });
+        }
+        options.emplace_back("Show thresholds", [&]() {
+            picked = true;
+            showDetectionProfile();
+        });
+        options.emplace_back("Reload file", [&]() {
+            picked = true;
+            if (detectionProfilesLoad()) displayInfo("Loaded " + String(detectionProfile().name), true);
+            else displayError("Cannot read " DETECTION_PROFILES_FILE, true);
+        });
+        options.emplace_back("Show baseline", [&]() {
+            picked = true;
+            showNetworkBaseline();
+        });
+        options.emplace_back("Forget baseline", [&]() {
+            picked = true;
+            FS *fs;
+            if (getFsStorage(fs) && fs->remove(NETWORK_BASELINE_FILE)) displayInfo("Baseline removed", true);
+            else displayError("No baseline", true);
+        });
+        options.emplace_back("Back", [&]() { done = true; });
+        
+        loopOptions(options);
+        if (!picked) done = true; // Back or ESC
+    }
+}
+
 void stopThreatMonitoring() {
     defenseSystemActive = false;
     displayStatus("Defense system stopped");
@@ -518,65 +644,297 @@ void isolateFromThreat(uint8_t* threatMac) {
     // Or warn user to avoid the threat
 }
 
-void logThreatIncident(ThreatDetection threat) {
-    // Log threat to SD card or internal storage
-    Serial.println("[DEFENSE] Logging threat incident");
-    // Implementation would save to file
+bool openThreatJournal() {
+    if (threatJournalReady()) return true;
+    FS *fs;
+    if (!getFsStorage(fs)) return false;
+    return threatJournalBegin(*fs);
 }
 
-void startAdvancedThreatMonitor() {
-    Serial.println("[BRUCE GUARDIAN] Starting Advanced Threat Monitor");
+// Queues the incident for the journal, the writer task puts it on flash in batches.
+// Safe from the capture drain task: never blocks, a full queue drops the record.
+void logThreatIncident(const ThreatIncident& threat) {
+    // Replayed captures are not journaled, their incidents did not happen here and now
+    if (guardianClockIsVirtual()) return;
+    
+    JournalRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    const time_t now = time(nullptr);
+    rec.epoch = now > 1600000000 ? (uint32_t)now : 0; // 0 until the clock was set
+    rec.uptimeMs = threat.lastSeen;
+    memcpy(rec.mac, threat.mac, 6);
+    rec.type = threat.type;
+    rec.detail = threat.detail;
+    memcpy(rec.peer, threat.peer, 6);
+    rec.ssidLen = strnlen(threat.ssid, sizeof(rec.ssid));
+    memcpy(rec.ssid, threat.ssid, rec.ssidLen);
+    rec.value = threat.value;
+    rec.confidence = threat.peakConfidence;
+    rec.hits = threat.hits;
+    if (!threatJournalAppend(rec)) Serial.println("[DEFENSE] Threat journal unavailable, incident not logged");
+}
+
+size_t trackedDeviceCapacity() {
+    return psramFound() ? MAX_TRACKED_DEVICES_PSRAM : MAX_TRACKED_DEVICES;
+}
+
+// Analysis -> render mailbox of the live monitors (guardian/guardian_view.h),
+// only exists while a capture runs
+static QueueHandle_t guardianViews = nullptr;
+static GuardianViewStats viewStats = {};
+
+// Tick of the drain task: scores the devices, then hands the result to the render loop
+static void analyzeAndPublish() {
+    threatEngineAnalyze();
+    if (!guardianViews) return;
     
-    // Clear previous state
-    trackedDevices.clear();
+    GuardianView view;
+    guardianBuildView(threatEngine, guardianMillis(), view);
+    if (uxQueueMessagesWaiting(guardianViews)) viewStats.superseded++;
+    xQueueOverwrite(guardianViews, &view);
+    viewStats.published++;
+}
+
+bool receiveGuardianView(GuardianView& view) {
+    return guardianViews && xQueueReceive(guardianViews, &view, 0) == pdTRUE;
+}
+
+bool startThreatCapture(const ThreatEngineConfig &config) {
+    // The engine is sized once so the drain task never allocates
+    if(!threatEngine.begin(trackedDeviceCapacity(), config)) {
+        displayError("Not enough memory", true);
+        return false;
+    }
     totalThreats = 0;
-    defenseStats.threatsDetected = 0;
+    viewStats = {};
+    guardianViews = xQueueCreate(1, sizeof(GuardianView));
+    if(!guardianViews) {
+        threatEngine.end();
+        displayError("Not enough memory", true);
+        return false;
+    }
+    
+    // Frames are applied and analyzed on the capture drain task
+    if(!guardianCaptureBegin(threatEngineApply, analyzeAndPublish, MIN_ANALYSIS_TIME)) {
+        vQueueDelete(guardianViews);
+        guardianViews = nullptr;
+        threatEngine.end();
+        displayError("Guardian capture failed", true);
+        return false;
+    }
     
-    // Set up WiFi monitoring
     WiFi.mode(WIFI_MODE_STA);
-    esp_wifi_set_promiscuous(true);
-    esp_wifi_set_promiscuous_rx_cb(&packetCallback);
     monitoring = true;
     lastAnalysis = millis();
+    esp_wifi_set_promiscuous(true);
+    esp_wifi_set_promiscuous_rx_cb(&packetCallback);
+    return true;
+}
+
+void stopThreatCapture() {
+    esp_wifi_set_promiscuous(false);
+    monitoring = false;
+    guardianCaptureEnd();
+    if(guardianViews) {
+        vQueueDelete(guardianViews);
+        guardianViews = nullptr;
+    }
+    
+    GuardianCaptureStats capture = guardianCaptureStats();
+    Serial.printf("[BRUCE GUARDIAN] Scan complete - Devices: %d, Threats: %d, Untracked (table full): %u\n", 
+                  threatEngine.size(), totalThreats, threatEngine.rejected());
+    Serial.printf("[BRUCE GUARDIAN] Frames enqueued: %u, dropped: %u, drained: %u, peak backlog: %u\n",
+                  capture.enqueued, capture.dropped, capture.drained, capture.highWater);
+    Serial.printf("[BRUCE GUARDIAN] Devices expired: %u, evicted (table full): %u\n",
+                  threatEngine.expired(), threatEngine.evicted());
+    Serial.printf("[BRUCE GUARDIAN] APs fingerprinted: %u in %u SSIDs, unchecked (table full): %u\n",
+                  threatEngine.twins().bssids(), threatEngine.twins().ssids(), threatEngine.twins().rejected());
+    Serial.printf("[BRUCE GUARDIAN] Directed probes: %u, answered: %u by %u APs\n",
+                  threatEngine.karma().probes(), threatEngine.karma().answers(), threatEngine.karma().bssids());
+    Serial.printf("[BRUCE GUARDIAN] Spoofed deauths: %u against %u stations\n",
+                  threatEngine.deauth().spoofed(), threatEngine.deauth().targets());
+    Serial.printf("[BRUCE GUARDIAN] Probe clusters: %u, random MACs merged: %u\n",
+                  threatEngine.clusters().clusters(), threatEngine.clusters().merged());
+    if (networkBaseline.aps()) {
+        Serial.printf("[BRUCE GUARDIAN] Baseline: %u APs in %u SSIDs, deviations: %u, not learned (table full): %u\n",
+                      (unsigned)networkBaseline.aps(), (unsigned)networkBaseline.ssids(),
+                      networkBaseline.deviations(), networkBaseline.rejected());
+    }
+}
+
+// Hot path histograms (guardian/guardian_stats.h) and the queue/table counters
+void printGuardianStats() {
+#if GUARDIAN_STATS
+    Serial.printf("%-9s %-6s %9s %9s %9s %9s %10s\n", "Probe", "Unit", "Count", "Mean", "p50", "p99", "Max");
+    for (int p = 0; p < GUARDIAN_PROBE_COUNT; p++) {
+        const GuardianHistogram h = guardianHistograms[p];
+        Serial.printf("%-9s %-6s %9u %9u %9u %9u %10u\n", guardianProbeName((GuardianProbe)p),
+                      guardianProbeUnit((GuardianProbe)p), h.count, h.count ? (uint32_t)(h.total / h.count) : 0,
+                      guardianHistogramQuantile(h, 0.5f), guardianHistogramQuantile(h, 0.99f), h.max);
+    }
+    Serial.printf("CPU: %u MHz\n", getCpuFrequencyMhz());
+#else
+    Serial.println("Latency histograms disabled at build time (GUARDIAN_STATS 0)");
+#endif
+    
+    GuardianCaptureStats capture = guardianCaptureStats();
+    Serial.printf("Capture ring: depth %u/%u, peak %u, dropped %u of %u\n", capture.enqueued - capture.drained,
+                  capture.capacity, capture.highWater, capture.dropped, capture.enqueued + capture.dropped);
+    Serial.printf("Analysis wakeups: %u; views: %u published, %u superseded; frames: %u, over budget: %u\n",
+                  capture.wakeups, viewStats.published, viewStats.superseded, viewStats.frames, viewStats.overruns);
+    Serial.printf("Engine: %u/%u devices, untracked %u, expired %u, evicted %u\n", threatEngine.size(),
+                  threatEngine.capacity(), threatEngine.rejected(), threatEngine.expired(), threatEngine.evicted());
+    Serial.printf("Probe clusters: %u, random MACs merged %u\n", threatEngine.clusters().clusters(),
+                  threatEngine.clusters().merged());
+    Serial.printf("Baseline: %u APs in %u SSIDs, deviations %u\n", (unsigned)networkBaseline.aps(),
+                  (unsigned)networkBaseline.ssids(), networkBaseline.deviations());
+    ThreatJournalStats journal = threatJournalStats();
+    Serial.printf("Journal: %s, written %u, dropped %u, failed %u, segments %u\n",
+                  threatJournalReady() ? "open" : "closed", journal.written, journal.dropped, journal.failed,
+                  journal.segments);
+    GuardianAlertStats alerts = threatAlertStats();
+    Serial.printf("Alerts: raised %u, merged %u, repeats %u, dropped %u, shown %u\n", alerts.raised, alerts.merged,
+                  alerts.repeated, alerts.dropped, alerts.shown);
+}
+
+String guardianStatsJson() {
+    JsonDocument doc;
+    doc["enabled"] = GUARDIAN_STATS != 0;
+    doc["cpuMhz"] = getCpuFrequencyMhz();
+    doc["profile"] = detectionProfile().name;
+#if GUARDIAN_STATS
+    JsonObject probes = doc["probes"].to<JsonObject>();
+    for (int p = 0; p < GUARDIAN_PROBE_COUNT; p++) {
+        const GuardianHistogram h = guardianHistograms[p];
+        JsonObject probe = probes[guardianProbeName((GuardianProbe)p)].to<JsonObject>();
+        probe["unit"] = guardianProbeUnit((GuardianProbe)p);
+        probe["count"] = h.count;
+        probe["mean"] = h.count ? (uint32_t)(h.total / h.count) : 0;
+        probe["p50"] = guardianHistogramQuantile(h, 0.5f);
+        probe["p99"] = guardianHistogramQuantile(h, 0.99f);
+        probe["max"] = h.max;
+        JsonArray buckets = probe["log2Buckets"].to<JsonArray>(); // bucket i counts [2^i, 2^(i+1))
+        int last = GUARDIAN_HISTOGRAM_BUCKETS - 1;
+        while (last >= 0 && h.buckets[last] == 0) last--;
+        for (int i = 0; i <= last; i++) buckets.add(h.buckets[i]);
+    }
+#endif
+    
+    GuardianCaptureStats capture = guardianCaptureStats();
+    JsonObject ring = doc["capture"].to<JsonObject>();
+    ring["enqueued"] = capture.enqueued;
+    ring["dropped"] = capture.dropped;
+    ring["drained"] = capture.drained;
+    ring["depth"] = capture.enqueued - capture.drained;
+    ring["highWater"] = capture.highWater;
+    ring["capacity"] = capture.capacity;
+    ring["wakeups"] = capture.wakeups;
+    
+    JsonObject pipeline = doc["pipeline"].to<JsonObject>();
+    pipeline["published"] = viewStats.published;
+    pipeline["superseded"] = viewStats.superseded;
+    pipeline["frames"] = viewStats.frames;
+    pipeline["overruns"] = viewStats.overruns;
+    pipeline["frameMs"] = GUARDIAN_FRAME_MS;
+    
+    JsonObject engine = doc["engine"].to<JsonObject>();
+    engine["devices"] = threatEngine.size();
+    engine["capacity"] = threatEngine.capacity();
+    engine["untracked"] = threatEngine.rejected();
+    engine["expired"] = threatEngine.expired();
+    engine["evicted"] = threatEngine.evicted();
+    engine["probeClusters"] = threatEngine.clusters().clusters();
+    engine["randomMacsMerged"] = threatEngine.clusters().merged();
+    engine["baselineAps"] = networkBaseline.aps();
+    engine["baselineDeviations"] = networkBaseline.deviations();
+    
+    ThreatJournalStats stats = threatJournalStats();
+    JsonObject journal = doc["journal"].to<JsonObject>();
+    journal["open"] = threatJournalReady();
+    journal["written"] = stats.written;
+    journal["dropped"] = stats.dropped;
+    journal["failed"] = stats.failed;
+    journal["segments"] = stats.segments;
+    
+    GuardianAlertStats alertStats = threatAlertStats();
+    JsonObject alerts = doc["alerts"].to<JsonObject>();
+    alerts["raised"] = alertStats.raised;
+    alerts["merged"] = alertStats.merged;
+    alerts["repeated"] = alertStats.repeated;
+    alerts["dropped"] = alertStats.dropped;
+    alerts["shown"] = alertStats.shown;
+    
+    String json;
+    serializeJson(doc, json);
+    return json;
+}
+
+// Render stage of the Guardian pipeline, on the Arduino loop task: capture runs in
+// the WiFi driver and analysis on the drain task, pinned to the other core.
+// Every GUARDIAN_FRAME_MS the loop polls ESC, shows due alerts and draws the
+// latest view, so none of them waits for another.
+void startAdvancedThreatMonitor() {
+    Serial.println("[BRUCE GUARDIAN] Starting Advanced Threat Monitor");
+    
+    defenseStats.threatsDetected = 0;
+    if(!startThreatCapture(guardianConfig())) {
+        networkBaseline.end();
+        return;
+    }
     
     displayStatus("🛡️ Bruce Guardian Active");
     Serial.println("[BRUCE GUARDIAN] Monitoring started - Press ESC to stop");
     
-    unsigned long lastDisplay = millis();
+    startThreatAlerts();
+    GuardianView view;
+    bool haveView = false;
+    bool redraw = false;
+    TickType_t frameStart = xTaskGetTickCount();
     
     while(monitoring && defenseSystemActive) {
-        // Run analysis periodically
-        if(millis() - lastAnalysis >= MIN_ANALYSIS_TIME) {
-            analyzeTrackedDevices();
-            lastAnalysis = millis();
-        }
-        
-        // Update display every 2 seconds  
-        if(millis() - lastDisplay >= 2000) {
-            displayAdvancedStatus();
-            lastDisplay = millis();
-            defenseStats.activeMonitorTime = millis() - lastAnalysis;
-        }
-        
-        // Check for exit
+        const uint32_t frameBegin = millis();
         if(checkEscKey()) {
             monitoring = false;
             break;
         }
         
-        delay(100);
+        // An alert keeps the screen until it is done, then the status is drawn again
+        if(serviceThreatAlerts()) {
+            redraw = true;
+        } else {
+            if(receiveGuardianView(view)) {
+                haveView = true;
+                redraw = true;
+            }
+            if(redraw && haveView) {
+                drawAdvancedStatus(view);
+                redraw = false;
+                defenseStats.activeMonitorTime = millis() - lastAnalysis;
+            }
+        }
+        
+        viewStats.frames++;
+        if(millis() - frameBegin > GUARDIAN_FRAME_MS) viewStats.overruns++;
+        vTaskDelayUntil(&frameStart, pdMS_TO_TICKS(GUARDIAN_FRAME_MS));
     }
     
-    esp_wifi_set_promiscuous(false);
-    
-    // Show final summary
-    Serial.printf("[BRUCE GUARDIAN] Scan complete - Devices: %d, Threats: %d\n", 
-                  trackedDevices.size(), totalThreats);
+    stopThreatCapture();
+    networkBaseline.end();
+    Serial.printf("[BRUCE GUARDIAN] Views: %u published, %u superseded; frames: %u, over budget: %u\n",
+                  viewStats.published, viewStats.superseded, viewStats.frames, viewStats.overruns);
     displayStatus("Guardian scan complete");
     delay(2000);
 }
 
+// Reads threatEngine directly: only while no capture is running, e.g. after a replay
 void displayAdvancedStatus() {
+    GuardianView view;
+    guardianBuildView(threatEngine, guardianMillis(), view);
+    drawAdvancedStatus(view);
+}
+
+void drawAdvancedStatus(const GuardianView& view) {
+    GUARDIAN_STAT_SCOPE(GUARDIAN_PROBE_DISPLAY);
     tft.fillScreen(TFT_BLACK);
     tft.setTextColor(TFT_GREEN);
     tft.setTextSize(1);
@@ -588,22 +946,16 @@ void displayAdvancedStatus() {
     
     // Stats
     tft.setCursor(5, 25);
-    tft.printf("Tracked: %d | Threats: %d", trackedDevices.size(), totalThreats);
+    tft.printf("Tracked: %u | Threats: %d", view.tracked, totalThreats);
     
-    // Device list (showing active threats first)
+    // Device list, riskiest first
     int yPos = 40;
-    int displayCount = 0;
-    unsigned long currentTime = millis();
-    
-    // Show high-risk devices first
-    for(const auto& device : trackedDevices) {
-        if(displayCount >= 6) break;
-        if(currentTime - device.lastSeen > 10000) continue; // Skip old devices
-        
+    for(uint8_t i = 0; i < view.count; i++) {
+        const GuardianViewDevice& device = view.devices[i];
         tft.setCursor(5, yPos);
         
         // Color based on threat level
-        if(device.isMarkedMalicious || device.riskScore >= ATTACK_DETECTION_THRESHOLD) {
+        if(device.malicious || device.riskScore >= detectionProfile().attackScore) {
             tft.setTextColor(TFT_RED);
         } else if(device.riskScore > 1.0) {
             tft.setTextColor(TFT_ORANGE);
@@ -614,12 +966,7 @@ void displayAdvancedStatus() {
         }
         
         // Format MAC (shortened)
-        String macStr = "";
-        for(int j = 0; j < 6; j++) {
-            if(j > 0) macStr += ":";
-            if(device.mac[j] < 16) macStr += "0";
-            macStr += String(device.mac[j], HEX);
-        }
+        String macStr = formatMac(device.mac);
         String shortMac = macStr.substring(0, 8) + ".." + macStr.substring(15);
         
         // Display: MAC | Risk | Type
@@ -627,17 +974,21 @@ void displayAdvancedStatus() {
         tft.setCursor(85, yPos);
         tft.printf("%.1f", device.riskScore);
         tft.setCursor(110, yPos);
-        String threatName = getThreatTypeName(device.suspectedThreat);
+        String threatName = getThreatTypeName((ThreatType)device.threat);
         tft.printf("%.8s", threatName.c_str());
         
         yPos += 12;
-        displayCount++;
     }
     
     // Status bar
     tft.setTextColor(TFT_CYAN);
     tft.setCursor(5, tft.height() - 25);
-    tft.printf("Thresholds: B>%d P>%d D>%d", BEACON_SPAM_THRESHOLD, PROBE_FLOOD_THRESHOLD, DEAUTH_ATTACK_THRESHOLD);
+    if(detectionProfile().anomalyModel) {
+        tft.printf("%s: trained model", detectionProfile().name);
+    } else {
+        tft.printf("%s: B>%u P>%u D>%u", detectionProfile().name, detectionThreshold("beacon spam"),
+                   detectionThreshold("probe flood"), detectionThreshold("deauth flood"));
+    }
     
     // Legend
     tft.setCursor(5, tft.height() - 12);
@@ -647,4 +998,212 @@ void displayAdvancedStatus() {
     tft.print("YEL=Risk ");
     tft.setTextColor(TFT_GREEN);
     tft.print("ESC=Exit");
-}
\ No newline at end of file
+}
+// Lets the user pick a recorded capture and a replay speed (0 = as fast as possible)
+bool selectThreatReplay(FS *&fs, String &path, uint16_t &speed) {
+    if(!getFsStorage(fs)) {
+        displayError("No storage found", true);
+        return false;
+    }
+    path = loopSD(*fs, true, "PCAP", "/BrucePCAP");
+    if(path == "") return false;
+    
+    int choice = -1;
+    options = {
+        {"Max speed",      [&]() { choice = 0; }},
+        {"Original speed", [&]() { choice = 1; }},
+        {"10x speed",      [&]() { choice = 10; }},
+        {"100x speed",     [&]() { choice = 100; }},
+    };
+    loopOptions(options);
+    if(choice < 0) return false;
+    speed = choice;
+    return true;
+}
+
+// Replays a capture into threatEngine with the detector clock following the capture.
+// The clock is left virtual so the caller can display the final state, then release it.
+bool replayThreatCapture(FS &fs, const String &path, uint16_t speed, const ThreatEngineConfig &config) {
+    if(!threatEngine.begin(trackedDeviceCapacity(), config)) {
+        displayError("Not enough memory", true);
+        return false;
+    }
+    totalThreats = 0;
+    
+    File file = fs.open(path, FILE_READ);
+    if(!file) {
+        displayError("Failed to open file", true);
+        return false;
+    }
+    
+    PcapReader<File> reader(file);
+    if(!reader.open() || !pcapLinkTypeSupported(reader.linkType())) {
+        file.close();
+        displayError("Not an 802.11 pcap", true);
+        return false;
+    }
+    
+    displayStatus("Replaying capture...");
+    Serial.printf("[BRUCE GUARDIAN] Replaying %s (speed %s)\n", path.c_str(),
+                  speed ? (String(speed) + "x").c_str() : "max");
+    
+    GuardianReplayOptions opt = {threatEngineApply, threatEngineAnalyze, MIN_ANALYSIS_TIME, speed, []() { return check(EscPress); }};
+    GuardianReplayStats stats = guardianReplay(reader, opt);
+    file.close();
+    
+    Serial.printf("[BRUCE GUARDIAN] Replay %s - Records: %u, Frames: %u, Skipped: %u, Truncated: %u\n",
+                  stats.aborted ? "aborted" : "complete", stats.records, stats.frames, stats.skipped, stats.truncated);
+    Serial.printf("[BRUCE GUARDIAN] Capture time: %ums, Replay time: %ums, Analysis passes: %u, %.0f frames/s\n",
+                  stats.virtualMs, stats.wallMs, stats.ticks,
+                  stats.wallMs ? stats.frames * 1000.0f / stats.wallMs : 0.0f);
+    return true;
+}
+
+void startThreatReplay() {
+    FS *fs;
+    String path;
+    uint16_t speed;
+    if(!selectThreatReplay(fs, path, speed)) return;
+    
+    defenseStats.threatsDetected = 0;
+    if(replayThreatCapture(*fs, path, speed, guardianConfig())) {
+        Serial.printf("[BRUCE GUARDIAN] Replay results - Devices: %d, Threats: %d, Untracked (table full): %u\n",
+                      threatEngine.size(), totalThreats, threatEngine.rejected());
+        displayAdvancedStatus();
+        while(!check(AnyKeyPress)) delay(50);
+    }
+    networkBaseline.end();
+    guardianClockRelease();
+}
+
+// Training window of the network baseline: the capture hops every channel so all
+// nearby APs are heard, each one needs BASELINE_CONFIRM_BEACONS identical beacons
+#define BASELINE_TRAIN_MS 90000
+#define BASELINE_HOP_MS 400 // ~4 beacons of a 102.4 TU AP per visit
+#define BASELINE_CHANNELS 13
+
+static uint32_t trainingThreats = 0;
+
+// The engine keeps detecting while it learns: an attack on the air would be learned as normal
+static void countTrainingThreat(const ThreatDevice& device) {
+    trainingThreats++;
+    Serial.println("[BRUCE GUARDIAN] Threat while learning: " + getThreatTypeName(device.suspectedThreat) +
+                   " from " + formatMac(device.mac));
+}
+
+void trainNetworkBaseline() {
+    FS *fs;
+    if(!getFsStorage(fs)) {
+        displayError("No storage found", true);
+        return;
+    }
+    if(!networkBaseline.begin()) {
+        displayError("Not enough memory", true);
+        return;
+    }
+    networkBaseline.setLearning(true);
+    trainingThreats = 0;
+    
+    detectionProfilesBegin();
+    ThreatEngineConfig config = guardianEngineConfig;
+    config.staleMs = detectionProfile().staleMs;
+    config.onDetected = countTrainingThreat;
+    config.onExpired = nullptr;
+    config.onDeauthFlood = nullptr;
+    config.baseline = &networkBaseline;
+    if(!startThreatCapture(config)) {
+        networkBaseline.end();
+        return;
+    }
+    
+    Serial.println("[BRUCE GUARDIAN] Learning the networks around, ESC to cancel");
+    const uint32_t start = millis();
+    uint32_t hopAt = start;
+    uint8_t channel = 0;
+    bool cancelled = false;
+    while(millis() - start < BASELINE_TRAIN_MS) {
+        if(checkEscKey()) {
+            cancelled = true;
+            break;
+        }
+        if(channel == 0 || millis() - hopAt >= BASELINE_HOP_MS) {
+            channel = channel % BASELINE_CHANNELS + 1;
+            esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE);
+            hopAt = millis();
+            
+            tft.fillScreen(TFT_BLACK);
+            tft.setTextColor(TFT_GREEN);
+            tft.setTextSize(1);
+            tft.setCursor(5, 10);
+            tft.println("Learning trusted networks");
+            tft.setTextColor(TFT_WHITE);
+            tft.setCursor(5, 30);
+            tft.printf("Channel: %u", channel);
+            tft.setCursor(5, 45);
+            tft.printf("APs: %u in %u SSIDs", (unsigned)networkBaseline.aps(), (unsigned)networkBaseline.ssids());
+            tft.setCursor(5, 60);
+            tft.printf("Left: %us", (unsigned)((BASELINE_TRAIN_MS - (millis() - start)) / 1000));
+            if(trainingThreats) {
+                tft.setTextColor(TFT_RED);
+                tft.setCursor(5, 75);
+                tft.printf("Threats seen: %u", (unsigned)trainingThreats);
+            }
+            tft.setTextColor(TFT_YELLOW);
+            tft.setCursor(5, 95);
+            tft.println("ESC=Cancel");
+        }
+        delay(50);
+    }
+    stopThreatCapture();
+    networkBaseline.setLearning(false);
+    
+    if(cancelled) {
+        displayInfo("Baseline not changed", true);
+    } else if(networkBaseline.aps() == 0) {
+        displayWarning("No networks learned", true);
+    } else if(!networkBaselineSave(*fs, networkBaseline)) {
+        displayError("Cannot write " NETWORK_BASELINE_FILE, true);
+    } else {
+        Serial.printf("[BRUCE GUARDIAN] Baseline saved: %u APs in %u SSIDs\n",
+                      (unsigned)networkBaseline.aps(), (unsigned)networkBaseline.ssids());
+        if(trainingThreats) displayWarning(String(trainingThreats) + " threats seen, retrain if unsure", true);
+        displaySuccess(String(networkBaseline.aps()) + " APs learned", true);
+    }
+    networkBaseline.end();
+}
+
+// Learned SSIDs with their AP count, from the baseline file
+void showNetworkBaseline() {
+    FS *fs;
+    if(!getFsStorage(fs) || !networkBaseline.begin()) {
+        displayError("No storage found", true);
+        return;
+    }
+    if(!networkBaselineLoad(*fs, networkBaseline) || networkBaseline.aps() == 0) {
+        networkBaseline.end();
+        displayInfo("No baseline, learn one first", true);
+        return;
+    }
+    
+    tft.fillScreen(TFT_BLACK);
+    tft.setTextColor(TFT_GREEN);
+    tft.setTextSize(1);
+    tft.setCursor(5, 5);
+    tft.printf("Baseline: %u APs", (unsigned)networkBaseline.aps());
+    tft.drawLine(5, 18, tft.width()-5, 18, TFT_GREEN);
+    
+    tft.setTextColor(TFT_WHITE);
+    int yPos = 24;
+    networkBaseline.forEachSsid([&](const char* name, uint8_t len, uint16_t aps) {
+        if (yPos > tft.height() - 20) return;
+        tft.setCursor(5, yPos);
+        tft.printf("%.*s (%u)", len, name, aps);
+        yPos += 10;
+    });
+    networkBaseline.end();
+    
+    tft.setTextColor(TFT_YELLOW);
+    tft.setCursor(5, tft.height() - 10);
+    tft.print(NETWORK_BASELINE_FILE);
+    waitForKeyPress();
+}
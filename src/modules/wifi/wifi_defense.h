@@ -2,50 +2,28 @@
 #define WIFI_DEFENSE_H
 
 #include <Arduino.h>
+#include <FS.h>
 #include <vector>
 #include <set>
+#include "guardian/scan_snapshot.h"
+#include "guardian/ssid_lookalike.h"
+#include "guardian/threat_engine.h"
+#include "guardian/guardian_view.h"
+#include "guardian/alert_queue.h"
+#include "guardian/threat_incidents.h"
+#include "guardian/threat_journal.h"
 
 // Pure Defense WiFi Security System
 // NO OFFENSIVE CAPABILITIES - DEFENSE ONLY
 
-// Enhanced threat types matching your existing detection system
-enum ThreatType {
-    THREAT_BEACON_SPAM,
-    THREAT_EVIL_TWIN, 
-    THREAT_KARMA_ATTACK,
-    THREAT_DEAUTH_FLOOD,
-    THREAT_PROBE_FLOOD,
-    THREAT_CAPTIVE_PORTAL,
-    THREAT_ROGUE_AP,
-    THREAT_UNKNOWN
-};
-
-// Advanced tracking structure (based on your existing TrackedDevice)
-struct AdvancedThreatDevice {
-    uint8_t mac[6];
-    unsigned long firstSeen;
-    unsigned long lastSeen;
-    uint32_t beaconCount;
-    uint32_t probeCount; 
-    uint32_t deauthCount;
-    uint32_t recentBeacons;     // beacons in last window
-    uint32_t recentProbes;      // probes in last window
-    uint32_t recentDeauths;     // deauths in last window
-    unsigned long windowStart; // start of measurement window
-    std::set<String> advertisedSSIDs;
-    ThreatType suspectedThreat;
-    float riskScore;
-    bool isMarkedMalicious;
-};
+// Threat types and detection thresholds live in the shared engine (guardian/threat_engine.h)
 
-// Detection thresholds (from your tuned system)
-#define MAX_TRACKED_DEVICES 50
-#define BEACON_SPAM_THRESHOLD 2   // beacons/second
-#define DEAUTH_ATTACK_THRESHOLD 1 // deauths/second  
-#define PROBE_FLOOD_THRESHOLD 5   // probes/second
-#define ATTACK_DETECTION_THRESHOLD 2 // risk score to confirm attack
-#define SHORT_WINDOW_MS 3000      // 3 second sliding window
-#define MIN_ANALYSIS_TIME 500     // minimum analysis interval
+#ifndef MAX_TRACKED_DEVICES
+#define MAX_TRACKED_DEVICES 256        // device table capacity without PSRAM
+#endif
+#ifndef MAX_TRACKED_DEVICES_PSRAM
+#define MAX_TRACKED_DEVICES_PSRAM 4096 // device table capacity when PSRAM is found
+#endif
 
 enum DefenseAction {
     DEFENSE_MONITOR,      // Passive monitoring only
@@ -55,16 +33,6 @@ enum DefenseAction {
     DEFENSE_REPORT        // Log and report threat
 };
 
-struct ThreatDetection {
-    uint8_t sourceMac[6];
-    ThreatType type;
-    float confidenceLevel;
-    unsigned long detectedAt;
-    String description;
-    DefenseAction recommendedAction;
-    bool isActive;
-};
-
 struct DefenseStats {
     uint32_t threatsDetected;
     uint32_t threatsBlocked;
@@ -77,21 +45,30 @@ struct DefenseStats {
 void initDefenseSystem();
 void startThreatMonitoring();
 void stopThreatMonitoring(); 
-void analyzeNetworkTraffic();
-void detectRogueAccessPoints();
+void analyzeNetworkTraffic(const ScanSnapshot& snapshot);
+void detectRogueAccessPoints(const ScanSnapshot& snapshot);
 void monitorCaptivePortals();
-void checkForEvilTwins();
+void checkForEvilTwins(const ScanSnapshot& snapshot);
+const SsidTrustList& trustedNetworks(); // the saved WiFi networks, what lookalikes imitate
 void assessKarmaThreats();
 void generateThreatReport();
 
 // Defense responses (NO ATTACKS)
-void alertUser(ThreatDetection threat);
+void alertUser(const ThreatIncident& threat); // queues the alert, see serviceThreatAlerts()
+void startThreatAlerts(); // drops waiting alerts, starts the LED/buzzer sink task once
+bool serviceThreatAlerts(); // shows the next alert, true while one is on screen
+GuardianAlertStats threatAlertStats();
 void isolateFromThreat(uint8_t* threatMac);
-void logThreatIncident(ThreatDetection threat);
-void recommendUserAction(ThreatDetection threat);
+void logThreatIncident(const ThreatIncident& threat);
+void recommendUserAction(const ThreatIncident& threat);
+String describeThreatIncident(const ThreatIncident& incident);
+bool openThreatJournal(); // on the SD card, LittleFS without one (guardian/threat_journal.h)
+
+// Learned baseline of the trusted networks (guardian/network_baseline.h), diffed by the Threat Monitor
+void trainNetworkBaseline(); // hops all channels for a while, then saves the APs heard
+void showNetworkBaseline();
 
 // Monitoring functions
-bool isNetworkSuspicious(wifi_ap_record_t* ap);
 float calculateThreatScore(uint8_t* mac);
 void updateDefenseDatabase();
 
@@ -101,8 +78,7 @@ void showThreatHistory();
 void configureDefenseSettings();
 
 // Global state for defense system
-extern std::vector<ThreatDetection> activeThreatsList;
-extern std::vector<AdvancedThreatDevice> trackedDevices;
+extern ThreatIncidentStore threatIncidents; // one entry per (MAC, ThreatType)
 extern DefenseStats defenseStats;
 extern bool defenseSystemActive;
 extern bool monitoring;
@@ -111,8 +87,25 @@ extern int totalThreats;
 
 // Advanced detection functions (your existing algorithms)
 void IRAM_ATTR packetCallback(void* buf, wifi_promiscuous_pkt_type_t type);
-void analyzeTrackedDevices();
 String getThreatTypeName(ThreatType type);
 void startAdvancedThreatMonitor();
+void displayAdvancedStatus(); // built from threatEngine, while no capture runs
+void drawAdvancedStatus(const GuardianView& view);
+size_t trackedDeviceCapacity();
+
+// Live capture into threatEngine, shared by the Guardian and Shark-Bait monitors.
+// While it runs, screens render the views the analysis task publishes, never threatEngine.
+bool startThreatCapture(const ThreatEngineConfig &config);
+void stopThreatCapture();
+bool receiveGuardianView(GuardianView& view); // latest view not taken yet, false if none
+
+// Hot path latency histograms and queue/table counters, for the CLI and the WebUI
+void printGuardianStats();
+String guardianStatsJson();
+
+// Offline replay of recorded captures (LINKTYPE 105 or radiotap 127) into threatEngine
+bool selectThreatReplay(FS *&fs, String &path, uint16_t &speed);
+bool replayThreatCapture(FS &fs, const String &path, uint16_t speed, const ThreatEngineConfig &config);
+void startThreatReplay();
 
 #endif // WIFI_DEFENSE_H
\ No newline at end of file
@@ -0,0 +1,354 @@
+// Offline trainer of the Guardian anomaly model (src/modules/wifi/guardian/anomaly_model.h).
+//
+// Replays labeled captures through the ThreatEngine exactly as the device does,
+// takes the feature vector of every scored device at each analysis tick, fits a
+// multinomial logistic regression and writes it as the int8 table the firmware
+// builds in (anomaly_weights.h). Labels name devices, not moments: a device
+// labeled with an attack only gives attack samples while it sends the frames of
+// that attack at 1/s or more, the rest of its samples are left out.
+//
+// Build from the repository root:
+//   g++ -O2 -std=gnu++11 -Isrc/modules/wifi/guardian -o guardian_train tools/guardian_train/guardian_train.cpp
+//       src/modules/wifi/guardian/{threat_engine,detection_profile,anomaly_model,evil_twin,karma,deauth_detector,probe_cluster,network_baseline,guardian_clock}.cpp
+// (one command line)
+//
+// Usage:
+//   guardian_train [options] capture.pcap labels [capture.pcap labels]...
+//     -o FILE          header to write (default src/modules/wifi/guardian/anomaly_weights.h)
+//     --epochs N       gradient descent steps (default 3000)
+//     --l2 X           weight decay (default 0.001)
+// Captures are LINKTYPE 105 or 127 (radiotap, with RSSI), guardian_bench --write-pcap
+// writes synthetic ones. Labels: one "aa:bb:cc:dd:ee:ff THREAT" per line as for
+// guardian_bench, threats the model does not score count as benign.
+
+#include "guardian_clock.h"
+#include "pcap_replay.h"
+#include "threat_engine.h"
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#define TRAIN_DEVICES 4096
+#define TRAIN_ACTIVE_Q8 256 // log2(1 + 1/s), the rate that makes a labeled sample an attack sample
+
+struct Sample {
+    int16_t x[ANOMALY_FEATURES];
+    uint8_t cls;
+    uint32_t device; // capture and row of the device, for calibrate()
+};
+
+static std::vector<Sample> samples;
+static std::map<uint64_t, uint8_t> labels; // MAC key -> AnomalyClass of the capture being replayed
+static std::map<uint64_t, uint32_t> devices; // MAC key -> device number, across captures
+static uint32_t deviceBase = 0;
+static uint32_t leftOut = 0;
+
+static bool parseMac(const char *text, uint8_t *mac) {
+    unsigned b[6];
+    if (sscanf(text, "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) return false;
+    for (int i = 0; i < 6; i++) mac[i] = b[i];
+    return true;
+}
+
+static uint8_t classByThreatName(const char *name) {
+    static const char *const threatNames[] = {"BEACON_SPAM", "EVIL_TWIN",      "KARMA_ATTACK", "DEAUTH_FLOOD",
+                                              "PROBE_FLOOD", "CAPTIVE_PORTAL", "ROGUE_AP",     "UNKNOWN"};
+    for (uint8_t c = ANOMALY_BENIGN + 1; c < ANOMALY_CLASSES; c++) {
+        if (strcmp(name, threatNames[anomalyThreat(c)]) == 0) return c;
+    }
+    return ANOMALY_BENIGN;
+}
+
+static bool loadLabels(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) return false;
+    labels.clear();
+    char mac[32], name[32];
+    uint8_t addr[6];
+    while (fscanf(f, "%31s %31s", mac, name) == 2) {
+        if (parseMac(mac, addr)) labels[macToKey(addr)] = classByThreatName(name);
+    }
+    fclose(f);
+    return true;
+}
+
+// Frames the attack of each class is made of
+static const AnomalyFeature activeFeature[ANOMALY_CLASSES] = {ANOMALY_BEACON_RATE, ANOMALY_BEACON_RATE,
+                                                              ANOMALY_DEAUTH_RATE, ANOMALY_PROBE_RATE};
+
+static void sampleTick() {
+    const uint32_t now = guardianMillis();
+    threatEngine.analyze(now);
+    const uint32_t staleMs = detectionProfile().staleMs;
+    for (size_t r = 0; r < threatEngine.size(); r++) {
+        const ThreatDevice d = threatEngine.device(r);
+        if ((int32_t)(now - d.lastSeen) > (int32_t)staleMs) continue;
+        Sample s;
+        threatEngine.anomalyFeatures(r, now, s.x);
+        const uint64_t key = macToKey(d.mac);
+        const std::map<uint64_t, uint8_t>::const_iterator label = labels.find(key);
+        s.cls = label == labels.end() ? (uint8_t)ANOMALY_BENIGN : label->second;
+        if (s.cls != ANOMALY_BENIGN && s.x[activeFeature[s.cls]] < TRAIN_ACTIVE_Q8) {
+            leftOut++;
+            continue;
+        }
+        std::map<uint64_t, uint32_t>::const_iterator device = devices.find(key);
+        if (device == devices.end()) device = devices.insert(std::make_pair(key, deviceBase + (uint32_t)devices.size())).first;
+        s.device = device->second;
+        samples.push_back(s);
+    }
+}
+
+static bool replay(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    PcapStdioStream stream(f);
+    PcapReader<PcapStdioStream> reader(stream);
+    if (!reader.open() || !pcapLinkTypeSupported(reader.linkType())) {
+        fclose(f);
+        return false;
+    }
+    const ThreatEngineConfig config = {detectionProfile().staleMs, THREAT_EXPIRE_MS, nullptr, nullptr,
+                                       nullptr, nullptr, nullptr, nullptr};
+    if (!threatEngine.begin(TRAIN_DEVICES, config)) {
+        fclose(f);
+        return false;
+    }
+    const GuardianReplayOptions opt = {threatEngineApply, sampleTick, MIN_ANALYSIS_TIME, 0, nullptr};
+    const size_t before = samples.size();
+    deviceBase += devices.size();
+    devices.clear();
+    const GuardianReplayStats stats = guardianReplay(reader, opt);
+    printf("%s: %u frames, %u s, %zu samples\n", path, stats.frames, stats.virtualMs / 1000, samples.size() - before);
+    threatEngine.end();
+    guardianClockRelease();
+    fclose(f);
+    return true;
+}
+
+// Multinomial logistic regression on standardized features, class balanced
+
+struct Fit {
+    double w[ANOMALY_CLASSES][ANOMALY_FEATURES]; // per Q8 feature unit
+    double b[ANOMALY_CLASSES];
+};
+
+static void softmax(const double *logit, double *p) {
+    double max = logit[0], sum = 0;
+    for (int c = 1; c < ANOMALY_CLASSES; c++) max = logit[c] > max ? logit[c] : max;
+    for (int c = 0; c < ANOMALY_CLASSES; c++) sum += p[c] = exp(logit[c] - max);
+    for (int c = 0; c < ANOMALY_CLASSES; c++) p[c] /= sum;
+}
+
+static Fit train(uint32_t epochs, double l2) {
+    const size_t n = samples.size();
+    double mean[ANOMALY_FEATURES] = {0}, sd[ANOMALY_FEATURES] = {0}, count[ANOMALY_CLASSES] = {0};
+    for (size_t i = 0; i < n; i++) {
+        count[samples[i].cls]++;
+        for (int f = 0; f < ANOMALY_FEATURES; f++) mean[f] += samples[i].x[f];
+    }
+    for (int f = 0; f < ANOMALY_FEATURES; f++) mean[f] /= n;
+    for (size_t i = 0; i < n; i++) {
+        for (int f = 0; f < ANOMALY_FEATURES; f++) sd[f] += (samples[i].x[f] - mean[f]) * (samples[i].x[f] - mean[f]);
+    }
+    for (int f = 0; f < ANOMALY_FEATURES; f++) sd[f] = sd[f] > 0 ? sqrt(sd[f] / n) : 1;
+
+    // Each present class weighs as much as the others in the loss
+    int present = 0;
+    for (int c = 0; c < ANOMALY_CLASSES; c++) present += count[c] > 0;
+    double classWeight[ANOMALY_CLASSES];
+    for (int c = 0; c < ANOMALY_CLASSES; c++) classWeight[c] = count[c] ? n / (present * count[c]) : 0;
+
+    double w[ANOMALY_CLASSES][ANOMALY_FEATURES] = {{0}}, b[ANOMALY_CLASSES] = {0};
+    const double rate = 0.5;
+    for (uint32_t epoch = 0; epoch < epochs; epoch++) {
+        double gw[ANOMALY_CLASSES][ANOMALY_FEATURES] = {{0}}, gb[ANOMALY_CLASSES] = {0};
+        for (size_t i = 0; i < n; i++) {
+            double z[ANOMALY_FEATURES], logit[ANOMALY_CLASSES], p[ANOMALY_CLASSES];
+            for (int f = 0; f < ANOMALY_FEATURES; f++) z[f] = (samples[i].x[f] - mean[f]) / sd[f];
+            for (int c = 0; c < ANOMALY_CLASSES; c++) {
+                logit[c] = b[c];
+                for (int f = 0; f < ANOMALY_FEATURES; f++) logit[c] += w[c][f] * z[f];
+            }
+            softmax(logit, p);
+            const double weight = classWeight[samples[i].cls];
+            for (int c = 0; c < ANOMALY_CLASSES; c++) {
+                const double g = weight * (p[c] - (c == samples[i].cls));
+                gb[c] += g;
+                for (int f = 0; f < ANOMALY_FEATURES; f++) gw[c][f] += g * z[f];
+            }
+        }
+        for (int c = 0; c < ANOMALY_CLASSES; c++) {
+            b[c] -= rate * gb[c] / n;
+            for (int f = 0; f < ANOMALY_FEATURES; f++) w[c][f] -= rate * (gw[c][f] / n + l2 * w[c][f]);
+        }
+    }
+
+    // Back to raw Q8 features: logit = b' + sum of w' * x
+    Fit fit;
+    for (int c = 0; c < ANOMALY_CLASSES; c++) {
+        fit.b[c] = b[c];
+        for (int f = 0; f < ANOMALY_FEATURES; f++) {
+            fit.w[c][f] = w[c][f] / sd[f];
+            fit.b[c] -= w[c][f] * mean[f] / sd[f];
+        }
+    }
+    return fit;
+}
+
+static AnomalyModel quantize(const Fit &fit) {
+    // One scale for the table: the largest weight becomes +-127
+    double largest = 0;
+    for (int c = 0; c < ANOMALY_CLASSES; c++) {
+        for (int f = 0; f < ANOMALY_FEATURES; f++) largest = fabs(fit.w[c][f]) > largest ? fabs(fit.w[c][f]) : largest;
+    }
+    const double scale = largest > 0 ? largest / 127 : 1; // logits per accumulator unit
+    AnomalyModel model;
+    for (int c = 0; c < ANOMALY_CLASSES; c++) {
+        for (int f = 0; f < ANOMALY_FEATURES; f++) model.weight[c][f] = (int8_t)lround(fit.w[c][f] / scale);
+        model.bias[c] = (int32_t)lround(fit.b[c] / scale);
+    }
+    model.unit = (int32_t)lround(1 / scale);
+    if (model.unit < 1) model.unit = 1;
+    return model;
+}
+
+/**
+ * @brief Moves the decision boundary between benign and attack devices
+ * @note The engine confirms a device on the first tick it crosses the boundary, so
+ *       what counts is each device's highest margin: balanced classes leave benign
+ *       devices that briefly look like an attack (a station's probe burst) over the
+ *       boundary, while an attack still ramping up does not need to be. When the
+ *       devices are separable the boundary goes halfway between the highest benign
+ *       margin and the lowest attack device's peak, otherwise just above the benign
+ *       margins that a false alarm rate of TRAIN_FALSE_ALARMS per sample allows.
+ */
+#define TRAIN_FALSE_ALARMS 0.0005
+
+static void calibrate(AnomalyModel &model) {
+    std::vector<int32_t> benign;
+    std::map<uint32_t, int32_t> attackPeak; // device -> highest margin
+    for (size_t i = 0; i < samples.size(); i++) {
+        uint8_t cls;
+        const int32_t margin = anomalyScore(model, samples[i].x, cls);
+        if (samples[i].cls == ANOMALY_BENIGN) {
+            benign.push_back(margin);
+        } else if (!attackPeak.count(samples[i].device) || margin > attackPeak[samples[i].device]) {
+            attackPeak[samples[i].device] = margin;
+        }
+    }
+    if (benign.empty() || attackPeak.empty()) return;
+    std::sort(benign.begin(), benign.end());
+    int32_t weakest = INT32_MAX;
+    for (std::map<uint32_t, int32_t>::const_iterator it = attackPeak.begin(); it != attackPeak.end(); ++it) {
+        weakest = it->second < weakest ? it->second : weakest;
+    }
+
+    int32_t boundary;
+    if (benign.back() < weakest) boundary = benign.back() + (weakest - benign.back()) / 2;
+    else boundary = benign[(size_t)((benign.size() - 1) * (1 - TRAIN_FALSE_ALARMS))] + 1;
+    model.bias[ANOMALY_BENIGN] += boundary;
+    printf("Boundary moved by %.2f logits (benign margins up to %.2f, %zu attack devices peaking from %.2f)\n",
+           (double)boundary / model.unit, (double)benign.back() / model.unit, attackPeak.size(),
+           (double)weakest / model.unit);
+}
+
+// Sample confusion of the quantized model, as the engine decides: attack when its logit beats benign
+static void report(const AnomalyModel &model) {
+    uint32_t confusion[ANOMALY_CLASSES][ANOMALY_CLASSES] = {{0}};
+    for (size_t i = 0; i < samples.size(); i++) {
+        uint8_t cls;
+        const int32_t margin = anomalyScore(model, samples[i].x, cls);
+        confusion[samples[i].cls][margin >= 0 ? cls : (uint8_t)ANOMALY_BENIGN]++;
+    }
+    printf("\n%-14s", "label \\ model");
+    for (int c = 0; c < ANOMALY_CLASSES; c++) printf(" %12s", anomalyClassNames[c]);
+    printf(" %8s\n", "recall");
+    for (int t = 0; t < ANOMALY_CLASSES; t++) {
+        uint32_t total = 0;
+        printf("%-14s", anomalyClassNames[t]);
+        for (int c = 0; c < ANOMALY_CLASSES; c++) {
+            printf(" %12u", confusion[t][c]);
+            total += confusion[t][c];
+        }
+        if (total) printf(" %8.3f\n", (double)confusion[t][t] / total);
+        else printf(" %8s\n", "-");
+    }
+}
+
+static bool writeHeader(const char *path, const AnomalyModel &model, const std::vector<std::string> &captures) {
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "// Generated by tools/guardian_train, do not edit\n");
+    fprintf(f, "// Trained on %zu samples of:\n", samples.size());
+    for (size_t i = 0; i < captures.size(); i++) fprintf(f, "//   %s\n", captures[i].c_str());
+    fprintf(f, "#ifndef __GUARDIAN_ANOMALY_WEIGHTS_H__\n#define __GUARDIAN_ANOMALY_WEIGHTS_H__\n\n");
+    fprintf(f, "#include \"anomaly_model.h\"\n\n");
+    fprintf(f, "// Features: ");
+    for (int k = 0; k < ANOMALY_FEATURES; k++) fprintf(f, "%s%s", k ? ", " : "", anomalyFeatureNames[k]);
+    fprintf(f, "\nconst AnomalyModel anomalyModel = {\n    {\n");
+    for (int c = 0; c < ANOMALY_CLASSES; c++) {
+        fprintf(f, "        {");
+        for (int k = 0; k < ANOMALY_FEATURES; k++) fprintf(f, "%s%4d", k ? ", " : "", model.weight[c][k]);
+        fprintf(f, "}, // %s\n", anomalyClassNames[c]);
+    }
+    fprintf(f, "    },\n    {");
+    for (int c = 0; c < ANOMALY_CLASSES; c++) fprintf(f, "%s%d", c ? ", " : "", model.bias[c]);
+    fprintf(f, "},\n    %d,\n};\n\n#endif\n", model.unit);
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const char *out = "src/modules/wifi/guardian/anomaly_weights.h";
+    uint32_t epochs = 3000;
+    double l2 = 0.001;
+    std::vector<const char *> inputs;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "-o" && hasValue) out = argv[++i];
+        else if (arg == "--epochs" && hasValue) epochs = atoi(argv[++i]);
+        else if (arg == "--l2" && hasValue) l2 = atof(argv[++i]);
+        else if (arg[0] != '-') inputs.push_back(argv[i]);
+        else {
+            inputs.clear();
+            break;
+        }
+    }
+    if (inputs.empty() || inputs.size() % 2) {
+        fprintf(stderr, "usage: %s [-o header] [--epochs N] [--l2 X] capture.pcap labels [capture.pcap labels]...\n",
+                argv[0]);
+        return 2;
+    }
+
+    std::vector<std::string> captures;
+    for (size_t i = 0; i < inputs.size(); i += 2) {
+        if (!loadLabels(inputs[i + 1])) {
+            fprintf(stderr, "%s: cannot read labels\n", inputs[i + 1]);
+            return 1;
+        }
+        if (!replay(inputs[i])) {
+            fprintf(stderr, "%s: not a readable 802.11 pcap\n", inputs[i]);
+            return 1;
+        }
+        const char *slash = strrchr(inputs[i], '/');
+        captures.push_back(slash ? slash + 1 : inputs[i]);
+    }
+    printf("%zu samples, %u samples of labeled devices left out while idle\n", samples.size(), leftOut);
+    if (samples.empty()) return 1;
+
+    AnomalyModel model = quantize(train(epochs, l2));
+    calibrate(model);
+    report(model);
+    if (!writeHeader(out, model, captures)) {
+        fprintf(stderr, "%s: cannot write\n", out);
+        return 1;
+    }
+    printf("\nWrote %s\n", out);
+    return 0;
+}
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+# Builds the offline MAC vendor table read by src/core/oui_db.cpp.
+#
+# Input is the IEEE MA-L registry, https://standards-oui.ieee.org/oui/oui.csv
+# (columns Registry, Assignment, Organization Name, Organization Address).
+# Output is /oui.bin for the SD card or LittleFS, little endian:
+#   header   "OUI1", u32 entries, u32 vendors, u32 strings size
+#   buckets  OUI_BUCKETS + 1 x u32, first entry of each top 12 bits of the OUI
+#   entries  u16 low 12 bits of the OUI, u16 vendor, sorted by OUI
+#   vendors  u32 offset of each name in strings
+#   strings  vendor names, NUL terminated, each stored once
+# A lookup reads one bucket range, binary searches its entries (at most 13 reads,
+# buckets are skewed towards the early assignments) and reads one name.
+#
+# Every firmware build runs it through pre_build_oui.py, from tools/oui_gen/oui.csv
+# into sd_files/oui.bin. By hand:
+#   python3 tools/oui_gen/oui_gen.py oui.csv oui.bin [--check aa:bb:cc]...
+
+import argparse
+import csv
+import struct
+import sys
+
+OUI_BUCKETS = 4096
+NAME_MAX = 63  # bytes kept of a vendor name
+
+
+def clean(name):
+    name = " ".join(name.split())
+    data = name.encode("utf-8")[:NAME_MAX]
+    return data.decode("utf-8", "ignore")
+
+
+def read_registry(path):
+    ouis = {}
+    with open(path, newline="", encoding="utf-8") as f:
+        for row in csv.DictReader(f):
+            if row.get("Registry") != "MA-L":
+                continue
+            assignment = row["Assignment"].strip()
+            name = clean(row["Organization Name"])
+            if len(assignment) != 6 or not name:
+                continue
+            ouis.setdefault(int(assignment, 16), name)  # first registration wins
+    return ouis
+
+
+def build(ouis):
+    names, vendor_of = [], {}
+    entries = []
+    for oui in sorted(ouis):
+        name = ouis[oui]
+        if name not in vendor_of:
+            vendor_of[name] = len(names)
+            names.append(name)
+        entries.append((oui, vendor_of[name]))
+    if len(names) > 0xFFFF:
+        raise ValueError("more than 65535 vendors")
+
+    buckets = [0] * (OUI_BUCKETS + 1)
+    for oui, _ in entries:
+        buckets[(oui >> 12) + 1] += 1
+    for b in range(OUI_BUCKETS):
+        buckets[b + 1] += buckets[b]
+
+    strings, offsets = bytearray(), []
+    for name in names:
+        offsets.append(len(strings))
+        strings += name.encode("utf-8") + b"\0"
+
+    out = bytearray(b"OUI1")
+    out += struct.pack("<III", len(entries), len(names), len(strings))
+    out += struct.pack(f"<{OUI_BUCKETS + 1}I", *buckets)
+    for oui, vendor in entries:
+        out += struct.pack("<HH", oui & 0xFFF, vendor)
+    out += struct.pack(f"<{len(offsets)}I", *offsets)
+    out += strings
+    return bytes(out)
+
+
+def lookup(blob, oui):
+    # Same steps as ouiLookup() in src/core/oui_db.cpp
+    count, vendors, _ = struct.unpack_from("<III", blob, 4)
+    buckets_at = 16
+    entries_at = buckets_at + (OUI_BUCKETS + 1) * 4
+    offsets_at = entries_at + count * 4
+    strings_at = offsets_at + vendors * 4
+    lo, hi = struct.unpack_from("<II", blob, buckets_at + (oui >> 12) * 4)
+    while lo < hi:
+        mid = (lo + hi) // 2
+        low, vendor = struct.unpack_from("<HH", blob, entries_at + mid * 4)
+        if low == oui & 0xFFF:
+            (offset,) = struct.unpack_from("<I", blob, offsets_at + vendor * 4)
+            end = blob.index(b"\0", strings_at + offset)
+            return blob[strings_at + offset : end].decode("utf-8")
+        if low < oui & 0xFFF:
+            lo = mid + 1
+        else:
+            hi = mid
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description="IEEE oui.csv to the OUI1 vendor table")
+    parser.add_argument("csv")
+    parser.add_argument("output")
+    parser.add_argument("--check", action="append", default=[], help="MAC or OUI to look up in the result")
+    args = parser.parse_args()
+
+    ouis = read_registry(args.csv)
+    if not ouis:
+        sys.exit(f"{args.csv}: no MA-L assignments")
+    blob = build(ouis)
+    with open(args.output, "wb") as f:
+        f.write(blob)
+    _, vendors, strings = struct.unpack_from("<III", blob, 4)
+    print(f"{args.output}: {len(ouis)} OUIs, {vendors} vendors, {strings} bytes of names, {len(blob)} bytes")
+
+    for mac in args.check:
+        digits = "".join(c for c in mac if c in "0123456789abcdefABCDEF")[:6]
+        print(f"{mac}: {lookup(blob, int(digits, 16)) or 'not found'}")
+
+
+if __name__ == "__main__":
+    main()